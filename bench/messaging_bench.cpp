@@ -0,0 +1,376 @@
+#include "orchestrator/communication/grpc_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using dist_prompt::orchestrator::communication::GrpcCommunicationProtocol;
+using AgentMessage = GrpcCommunicationProtocol::AgentMessage;
+using AgentResponse = GrpcCommunicationProtocol::AgentResponse;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BenchConfig {
+    int servers = 2;
+    int clients = 4;
+    int serverThreads = 4;
+    size_t messageBytes = 1024;
+    double ratePerClient = 0.0;     // Messages per second per client; zero runs closed-loop
+    int concurrency = 64;           // Outstanding requests per client in closed-loop mode
+    int fanout = 1;                 // Servers each request goes to; latency is until the last reply
+    std::chrono::milliseconds duration{3000};
+    int basePort = 52100;
+    GrpcCommunicationProtocol::CompressionAlgorithm compression =
+        GrpcCommunicationProtocol::CompressionAlgorithm::NONE;
+    std::vector<std::string> modes = {"unary", "stream", "batched", "inproc"};
+};
+
+struct ModeReport {
+    std::string mode;
+    long requests = 0;
+    long errors = 0;
+    double seconds = 0.0;
+    std::vector<int64_t> latenciesUs;
+};
+
+// Latencies of one client's completed requests
+struct Recorder {
+    std::mutex mutex;
+    std::vector<int64_t> latenciesUs;
+    long errors = 0;
+};
+
+// One logical request, complete once every fan-out target has answered
+struct Request {
+    Clock::time_point start;
+    std::atomic<int> remaining{0};
+    std::atomic<bool> failed{false};
+};
+
+// Closed-loop admission: at most `limit` requests outstanding
+class Window {
+public:
+    explicit Window(int limit) : limit_(limit) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return outstanding_ < limit_; });
+        outstanding_++;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            outstanding_--;
+        }
+        cv_.notify_all();
+    }
+
+    void drain(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [this]() { return outstanding_ == 0; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int limit_;
+    int outstanding_ = 0;
+};
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig* config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        if (key == "servers") {
+            config->servers = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "clients") {
+            config->clients = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "server-threads") {
+            config->serverThreads = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "size") {
+            config->messageBytes = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (key == "rate") {
+            config->ratePerClient = std::atof(value.c_str());
+        } else if (key == "concurrency") {
+            config->concurrency = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "fanout") {
+            config->fanout = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "duration-ms") {
+            config->duration = std::chrono::milliseconds(std::atol(value.c_str()));
+        } else if (key == "port") {
+            config->basePort = std::atoi(value.c_str());
+        } else if (key == "modes") {
+            config->modes = splitList(value);
+        } else if (key == "compression") {
+            if (value == "gzip") {
+                config->compression = GrpcCommunicationProtocol::CompressionAlgorithm::GZIP;
+            } else if (value == "deflate") {
+                config->compression = GrpcCommunicationProtocol::CompressionAlgorithm::DEFLATE;
+            } else if (value != "none") {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    config->fanout = std::min(config->fanout, config->servers);
+    return true;
+}
+
+std::string serverAddress(const BenchConfig& config, int index) {
+    return "localhost:" + std::to_string(config.basePort + index);
+}
+
+void configureClient(const BenchConfig& config, GrpcCommunicationProtocol& client, const std::string& mode) {
+    GrpcCommunicationProtocol::CompressionOptions compression;
+    compression.algorithm = config.compression;
+    client.setCompressionOptions(compression);
+    client.setInProcessDelivery(mode == "inproc");
+    client.setStreamingEnabled(mode == "stream");
+
+    GrpcCommunicationProtocol::BatchingOptions batching;
+    batching.enabled = mode == "batched";
+    client.setBatchingOptions(batching);
+}
+
+// Drives one client until the deadline; open-loop at the configured rate or
+// closed-loop with a fixed number of outstanding requests
+void runClient(const BenchConfig& config, GrpcCommunicationProtocol& client, int clientIndex,
+               const std::string& payload, Clock::time_point deadline, Recorder& recorder, long& issued) {
+    Window window(config.ratePerClient > 0.0 ? 1 << 30 : config.concurrency);
+    const bool openLoop = config.ratePerClient > 0.0;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(openLoop ? 1.0 / config.ratePerClient : 0.0));
+
+    Clock::time_point next = Clock::now();
+    int target = clientIndex % config.servers;
+    while (true) {
+        if (openLoop) {
+            std::this_thread::sleep_until(next);
+        }
+        if (Clock::now() >= deadline) {
+            break;
+        }
+        window.acquire();
+
+        // Open-loop latency counts from the scheduled send time, so a stalled
+        // sender does not hide queueing delay
+        auto request = std::make_shared<Request>();
+        request->start = openLoop ? next : Clock::now();
+        request->remaining = config.fanout;
+        next += interval;
+        issued++;
+
+        for (int k = 0; k < config.fanout; ++k) {
+            AgentMessage message{};
+            message.senderId = "bench-client-" + std::to_string(clientIndex);
+            message.receiverId = "server-" + std::to_string((target + k) % config.servers);
+            message.messageType = "echo";
+            message.payload = payload;
+
+            bool sent = client.sendMessageAsync(std::move(message),
+                [request, &recorder, &window](const AgentResponse& response) {
+                    if (!response.success) {
+                        request->failed = true;
+                    }
+                    if (request->remaining.fetch_sub(1) != 1) {
+                        return;
+                    }
+
+                    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - request->start).count();
+                    {
+                        std::lock_guard<std::mutex> lock(recorder.mutex);
+                        if (request->failed) {
+                            recorder.errors++;
+                        } else {
+                            recorder.latenciesUs.push_back(latency);
+                        }
+                    }
+                    window.release();
+                });
+            if (!sent && request->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(recorder.mutex);
+                recorder.errors++;
+                window.release();
+            }
+        }
+        target = (target + 1) % config.servers;
+    }
+
+    window.drain(std::chrono::milliseconds(10000));
+}
+
+ModeReport runMode(const BenchConfig& config, const std::string& mode, const std::string& payload) {
+    ModeReport report;
+    report.mode = mode;
+
+    std::vector<std::unique_ptr<GrpcCommunicationProtocol>> servers;
+    for (int i = 0; i < config.servers; ++i) {
+        auto server = std::make_unique<GrpcCommunicationProtocol>();
+        server->setServerThreadCount(config.serverThreads);
+        server->initializeServer(serverAddress(config, i), "", "");
+        server->registerMessageHandler("echo", [](const AgentMessage& message) {
+            AgentResponse response{};
+            response.success = true;
+            response.responseData = message.payload;
+            return response;
+        });
+        if (!server->startServer()) {
+            std::fprintf(stderr, "Failed to start server on %s\n", serverAddress(config, i).c_str());
+            return report;
+        }
+        servers.push_back(std::move(server));
+    }
+
+    std::vector<std::unique_ptr<GrpcCommunicationProtocol>> clients;
+    for (int c = 0; c < config.clients; ++c) {
+        auto client = std::make_unique<GrpcCommunicationProtocol>();
+        configureClient(config, *client, mode);
+        client->initializeClient(serverAddress(config, 0), "", "", "");
+        for (int i = 0; i < config.servers; ++i) {
+            client->registerPeer("server-" + std::to_string(i), serverAddress(config, i));
+        }
+
+        // Warm up every connection so channel setup stays out of the numbers
+        for (int i = 0; i < config.servers; ++i) {
+            AgentMessage warmup{};
+            warmup.receiverId = "server-" + std::to_string(i);
+            warmup.messageType = "echo";
+            client->sendMessage(warmup);
+        }
+        clients.push_back(std::move(client));
+    }
+
+    std::vector<Recorder> recorders(config.clients);
+    std::vector<long> issued(config.clients, 0);
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    auto deadline = start + config.duration;
+    for (int c = 0; c < config.clients; ++c) {
+        threads.emplace_back(runClient, std::cref(config), std::ref(*clients[c]), c, std::cref(payload),
+                             deadline, std::ref(recorders[c]), std::ref(issued[c]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (int c = 0; c < config.clients; ++c) {
+        std::lock_guard<std::mutex> lock(recorders[c].mutex);
+        report.requests += issued[c];
+        report.errors += recorders[c].errors;
+        report.latenciesUs.insert(report.latenciesUs.end(),
+                                  recorders[c].latenciesUs.begin(), recorders[c].latenciesUs.end());
+    }
+
+    clients.clear();
+    for (auto& server : servers) {
+        server->stopServer();
+    }
+    return report;
+}
+
+int64_t percentile(const std::vector<int64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+void printReport(const BenchConfig& config, ModeReport& report) {
+    std::sort(report.latenciesUs.begin(), report.latenciesUs.end());
+    double completed = static_cast<double>(report.latenciesUs.size());
+    double throughput = report.seconds > 0.0 ? completed / report.seconds : 0.0;
+    double megabytes = throughput * static_cast<double>(config.messageBytes * config.fanout) / (1024.0 * 1024.0);
+
+    std::printf("%-8s %10ld %8ld %12.0f %9.1f %9ld %9ld %9ld %9ld\n",
+                report.mode.c_str(),
+                report.requests,
+                report.errors,
+                throughput,
+                megabytes,
+                percentile(report.latenciesUs, 0.50),
+                percentile(report.latenciesUs, 0.99),
+                percentile(report.latenciesUs, 0.999),
+                report.latenciesUs.empty() ? 0L : report.latenciesUs.back());
+}
+
+} // namespace
+
+// Usage: messaging_bench [--servers=N] [--clients=N] [--server-threads=N] [--size=BYTES]
+//                        [--rate=MSG_PER_S_PER_CLIENT] [--concurrency=N] [--fanout=K]
+//                        [--duration-ms=MS] [--port=BASE] [--modes=unary,stream,batched,inproc]
+//                        [--compression=none|gzip|deflate]
+// A rate of 0 (the default) runs closed-loop with `concurrency` requests outstanding per client.
+// Payloads are random bytes, so compression is off unless asked for.
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, &config)) {
+        std::fprintf(stderr, "Usage: %s [--key=value ...], see source for keys\n", argv[0]);
+        return 1;
+    }
+
+    // Incompressible payload, so the numbers measure transport rather than data
+    std::string payload(config.messageBytes, '\0');
+    std::mt19937 gen(42);
+    for (auto& byte : payload) {
+        byte = static_cast<char>(gen());
+    }
+
+    std::printf("%d servers, %d clients, %zu-byte messages, fan-out %d, %s\n",
+                config.servers, config.clients, config.messageBytes, config.fanout,
+                config.ratePerClient > 0.0 ?
+                    ("open loop at " + std::to_string(static_cast<long>(config.ratePerClient)) + " req/s per client").c_str() :
+                    ("closed loop, " + std::to_string(config.concurrency) + " outstanding per client").c_str());
+    std::printf("%-8s %10s %8s %12s %9s %9s %9s %9s %9s\n",
+                "mode", "requests", "errors", "req/s", "MB/s", "p50 us", "p99 us", "p999 us", "max us");
+
+    int port = config.basePort;
+    for (const auto& mode : config.modes) {
+        if (mode != "unary" && mode != "stream" && mode != "batched" && mode != "inproc") {
+            std::fprintf(stderr, "Unknown mode: %s\n", mode.c_str());
+            return 1;
+        }
+
+        // Fresh ports per mode, so a lingering listener from the last one cannot interfere
+        config.basePort = port;
+        port += config.servers;
+
+        ModeReport report = runMode(config, mode, payload);
+        printReport(config, report);
+    }
+
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "openmd/binding.h"
 #include "openmd/errors/error_codes.h"
+#include <atomic>
 #include <dlfcn.h>
 #include <iostream>
 #include <sstream>
@@ -178,6 +179,7 @@ public:
         resultC.errors = nullptr;
         
         // Call OpenMD simulation function
+        uint64_t cancelGeneration = cancelGeneration_.load(std::memory_order_acquire);
         try {
             runSimulationFn_(inputData.c_str(), &paramsC, &resultC);
         } catch (const std::exception& e) {
@@ -222,6 +224,13 @@ public:
         // Clean up C parameter structures
         cleanupParams(&paramsC);
         
+        if (!result.success && cancelGeneration_.load(std::memory_order_acquire) != cancelGeneration) {
+            throw errors::OpenMDException(
+                errors::ErrorCode::CANCELLED,
+                "Simulation cancelled"
+            );
+        }
+        
         // Check for simulation failures
         if (!result.success && !result.errors.empty()) {
             throw errors::OpenMDException(
@@ -234,6 +243,17 @@ public:
         return result;
     }
     
+    bool cancelSimulation() {
+        if (!initialized_ || !cancelSimulationFn_) {
+            return false;
+        }
+        
+        // Runs that end unsuccessfully after this point report CANCELLED
+        cancelGeneration_.fetch_add(1, std::memory_order_acq_rel);
+        cancelSimulationFn_();
+        return true;
+    }
+    
     void setProgressCallback(std::function<void(int)> callback) {
         progressCallback_ = callback;
         
@@ -259,6 +279,7 @@ private:
     bool initialized_;
     std::mutex mutex_;
     std::function<void(int)> progressCallback_;
+    std::atomic<uint64_t> cancelGeneration_{0};
     
     // Function pointer types for OpenMD API
     typedef void (*VersionFn)(int*, int*, int*, char*, size_t);
@@ -267,6 +288,7 @@ private:
     typedef void (*RunSimulationFn)(const char*, const SimulationParamsC*, SimulationResultC*);
     typedef void (*SetProgressCallbackFn)(void (*)(int, void*), void*);
     typedef int (*RegisterCustomFunctionFn)(const char*, void*);
+    typedef void (*CancelSimulationFn)();
     
     // Function pointers
     VersionFn versionFn_;
@@ -275,6 +297,7 @@ private:
     RunSimulationFn runSimulationFn_;
     SetProgressCallbackFn setProgressCallbackFn_;
     RegisterCustomFunctionFn registerCustomFunctionFn_;
+    CancelSimulationFn cancelSimulationFn_;
     
     // C-style structures for FFI
     struct SimulationParamsC {
@@ -325,6 +348,10 @@ private:
             dlsym(libraryHandle_, "OpenMD_RegisterCustomFunction"));
         // This is optional, so we don't check for failure
         
+        cancelSimulationFn_ = reinterpret_cast<CancelSimulationFn>(
+            dlsym(libraryHandle_, "OpenMD_CancelSimulation"));
+        // This is optional, so we don't check for failure
+        
         return true;
     }
     
@@ -383,6 +410,10 @@ OpenMDBinding::SimulationResult OpenMDBinding::runSimulation(
     return pImpl_->runSimulation(inputData, params);
 }
 
+bool OpenMDBinding::cancelSimulation() {
+    return pImpl_->cancelSimulation();
+}
+
 void OpenMDBinding::setProgressCallback(std::function<void(int)> callback) {
     pImpl_->setProgressCallback(callback);
 }
@@ -108,6 +108,16 @@ public:
     SimulationResult runSimulation(const std::string& inputData, 
                                  const SimulationParams& params);
     
+    /**
+     * @brief Ask running simulations to stop early
+     * 
+     * Safe to call from any thread. Interrupted runs throw an OpenMDException
+     * with ErrorCode::CANCELLED. Requires OpenMD_CancelSimulation in the library.
+     * 
+     * @return bool True if the library supports cancellation
+     */
+    bool cancelSimulation();
+    
     /**
      * @brief Set a callback for simulation progress
      * 
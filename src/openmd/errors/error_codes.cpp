@@ -15,6 +15,7 @@ std::string errorCodeToString(ErrorCode code) {
         {ErrorCode::NOT_IMPLEMENTED, "NOT_IMPLEMENTED"},
         {ErrorCode::INVALID_ARGUMENT, "INVALID_ARGUMENT"},
         {ErrorCode::TIMEOUT, "TIMEOUT"},
+        {ErrorCode::CANCELLED, "CANCELLED"},
         
         // Initialization errors
         {ErrorCode::INITIALIZATION_FAILED, "INITIALIZATION_FAILED"},
@@ -59,6 +60,7 @@ std::string errorCodeDescription(ErrorCode code) {
         {ErrorCode::NOT_IMPLEMENTED, "The requested functionality is not implemented"},
         {ErrorCode::INVALID_ARGUMENT, "An invalid argument was provided"},
         {ErrorCode::TIMEOUT, "The operation timed out"},
+        {ErrorCode::CANCELLED, "The operation was cancelled"},
         
         // Initialization errors
         {ErrorCode::INITIALIZATION_FAILED, "Failed to initialize OpenMD"},
@@ -98,7 +100,7 @@ std::string errorCodeDescription(ErrorCode code) {
 bool isErrorRecoverable(ErrorCode code) {
     static const std::unordered_map<ErrorCode, bool> recoverable = {
         {ErrorCode::SUCCESS, true}, {ErrorCode::INVALID_ARGUMENT, true}, {ErrorCode::TIMEOUT, true},
-        {ErrorCode::CONFIGURATION_ERROR, true}, {ErrorCode::MARSHALLING_ERROR, true},
+        {ErrorCode::CANCELLED, true}, {ErrorCode::CONFIGURATION_ERROR, true}, {ErrorCode::MARSHALLING_ERROR, true},
         {ErrorCode::SIMULATION_FAILED, true}, {ErrorCode::CONVERGENCE_ERROR, true},
         {ErrorCode::NUMERICAL_INSTABILITY, true}, {ErrorCode::BOUNDARY_CONDITION_ERROR, true},
         {ErrorCode::TRANSFORMATION_ERROR, true}, {ErrorCode::SCHEMA_VALIDATION_ERROR, true},
@@ -18,6 +18,7 @@ enum class ErrorCode {
     NOT_IMPLEMENTED = 2,
     INVALID_ARGUMENT = 3,
     TIMEOUT = 4,
+    CANCELLED = 5,
     
     // Initialization errors (100-199)
     INITIALIZATION_FAILED = 100,
@@ -0,0 +1,158 @@
+#include "orchestrator/cancellation_token.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace dist_prompt {
+namespace orchestrator {
+
+struct CancellationToken::State {
+    std::atomic<bool> cancelled{false};
+    Clock::time_point deadline = Clock::time_point::max();
+
+    // Guarded by mutex; reason is written once, before cancelled is set
+    std::mutex mutex;
+    std::condition_variable callbacksDone;
+    std::string reason;
+    std::map<Registration, std::function<void()>> callbacks;
+    Registration nextRegistration = 1;
+    bool runningCallbacks = false;
+    std::thread::id callbackThread;
+
+    // Callback that cancels this state with its parent; removed when this state goes away
+    std::weak_ptr<State> parent;
+    Registration parentRegistration = 0;
+
+    ~State() {
+        if (auto owner = parent.lock()) {
+            remove(*owner, parentRegistration);
+        }
+    }
+
+    static bool cancel(State& state, const std::string& reason) {
+        std::map<Registration, std::function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            state.reason = reason;
+            state.cancelled.store(true, std::memory_order_release);
+            callbacks.swap(state.callbacks);
+            state.runningCallbacks = true;
+            state.callbackThread = std::this_thread::get_id();
+        }
+
+        for (auto& [registration, callback] : callbacks) {
+            callback();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.runningCallbacks = false;
+        }
+        state.callbacksDone.notify_all();
+        return true;
+    }
+
+    static void remove(State& state, Registration registration) {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (state.callbacks.erase(registration) > 0) {
+            return;
+        }
+        // Already taken by cancel(); wait unless this thread is the one running it
+        if (state.callbackThread != std::this_thread::get_id()) {
+            state.callbacksDone.wait(lock, [&state]() { return !state.runningCallbacks; });
+        }
+    }
+};
+
+CancellationToken CancellationToken::create(Clock::time_point deadline) {
+    auto state = std::make_shared<State>();
+    state->deadline = deadline;
+    return CancellationToken(std::move(state));
+}
+
+CancellationToken CancellationToken::child(Clock::time_point deadline) const {
+    if (!state_) {
+        return create(deadline);
+    }
+
+    auto state = std::make_shared<State>();
+    state->deadline = std::min(deadline, state_->deadline);
+
+    std::weak_ptr<State> weakChild = state;
+    State* parent = state_.get();
+    state->parent = state_;
+    state->parentRegistration = onCancel([weakChild, parent]() {
+        if (auto child = weakChild.lock()) {
+            // The parent's reason is final once its callbacks run
+            State::cancel(*child, parent->reason);
+        }
+    });
+    return CancellationToken(std::move(state));
+}
+
+bool CancellationToken::cancel(const std::string& reason) const {
+    return state_ && State::cancel(*state_, reason);
+}
+
+bool CancellationToken::isCancelled() const {
+    if (!state_) {
+        return false;
+    }
+    if (state_->cancelled.load(std::memory_order_acquire)) {
+        return true;
+    }
+    return state_->deadline != Clock::time_point::max() && Clock::now() >= state_->deadline;
+}
+
+std::string CancellationToken::reason() const {
+    if (!state_) {
+        return "";
+    }
+    if (state_->cancelled.load(std::memory_order_acquire)) {
+        return state_->reason;
+    }
+    return isCancelled() ? "deadline exceeded" : "";
+}
+
+CancellationToken::Clock::time_point CancellationToken::deadline() const {
+    return state_ ? state_->deadline : Clock::time_point::max();
+}
+
+CancellationToken::Clock::duration CancellationToken::remaining() const {
+    auto end = deadline();
+    if (end == Clock::time_point::max()) {
+        return Clock::duration::max();
+    }
+    return std::max(end - Clock::now(), Clock::duration::zero());
+}
+
+CancellationToken::Registration CancellationToken::onCancel(std::function<void()> callback) const {
+    if (!state_) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->cancelled.load(std::memory_order_relaxed)) {
+            auto registration = state_->nextRegistration++;
+            state_->callbacks.emplace(registration, std::move(callback));
+            return registration;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void CancellationToken::removeCallback(Registration registration) const {
+    if (state_ && registration != 0) {
+        State::remove(*state_, registration);
+    }
+}
+
+} // namespace orchestrator
+} // namespace dist_prompt
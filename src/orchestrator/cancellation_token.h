@@ -0,0 +1,157 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace dist_prompt {
+namespace orchestrator {
+
+/**
+ * @brief Cooperative cancellation signal shared between an owner and the work it started
+ *
+ * Copies share one state, so a token handed to a step, a resource wait or an
+ * RPC observes cancel() called on any copy. Work polls isCancelled() at
+ * convenient points or registers a callback to interrupt a blocking call.
+ * A child token is cancelled with its parent but can also be cancelled, or
+ * time out, on its own. A default-constructed token can never be cancelled.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Registration = uint64_t;
+
+    /**
+     * @brief Construct a token that is never cancelled
+     */
+    CancellationToken() = default;
+
+    /**
+     * @brief Create a new cancellable token
+     *
+     * @param deadline Time after which the token counts as cancelled
+     * @return CancellationToken Token with its own state
+     */
+    static CancellationToken create(Clock::time_point deadline = Clock::time_point::max());
+
+    /**
+     * @brief Create a token that is cancelled together with this one
+     *
+     * @param deadline Deadline of the child; the earlier of it and this token's deadline applies
+     * @return CancellationToken Child token
+     */
+    CancellationToken child(Clock::time_point deadline = Clock::time_point::max()) const;
+
+    /**
+     * @brief Request cancellation
+     *
+     * Registered callbacks and child tokens are cancelled on the calling
+     * thread before this returns. Later calls have no effect.
+     *
+     * @param reason Why the work is cancelled
+     * @return bool True if this call cancelled the token
+     */
+    bool cancel(const std::string& reason = "cancelled") const;
+
+    /**
+     * @brief Check whether cancellation was requested or the deadline passed
+     *
+     * Never runs callbacks, so it is safe to call while holding locks.
+     *
+     * @return bool True if the work should stop
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief Check whether the token can ever be cancelled
+     *
+     * @return bool False for default-constructed tokens
+     */
+    bool cancellable() const { return state_ != nullptr; }
+
+    /**
+     * @brief Get the reason passed to cancel()
+     *
+     * @return std::string Reason, "deadline exceeded" if only the deadline passed, or empty
+     */
+    std::string reason() const;
+
+    /**
+     * @brief Get the deadline
+     *
+     * @return Clock::time_point Deadline, or time_point::max() if there is none
+     */
+    Clock::time_point deadline() const;
+
+    /**
+     * @brief Get the time left until the deadline
+     *
+     * @return Clock::duration Time left, zero once passed, or duration::max() without a deadline
+     */
+    Clock::duration remaining() const;
+
+    /**
+     * @brief Register a callback to run on cancellation
+     *
+     * Runs the callback at once if the token is already cancelled. Passing the
+     * deadline alone does not run callbacks; the owner of the deadline calls
+     * cancel() for that.
+     *
+     * @param callback Callback; must not throw
+     * @return Registration ID for removeCallback(), or 0 if the callback already ran or never will
+     */
+    Registration onCancel(std::function<void()> callback) const;
+
+    /**
+     * @brief Remove a registered callback
+     *
+     * If the callback is running on another thread, waits for it to return,
+     * so state it captures may be destroyed afterwards.
+     *
+     * @param registration ID returned by onCancel()
+     */
+    void removeCallback(Registration registration) const;
+
+private:
+    struct State;
+
+    explicit CancellationToken(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Scoped registration of a cancellation callback
+ *
+ * Registers on construction and removes the callback on destruction, so a
+ * blocking call can be interrupted only while it is in progress.
+ */
+class CancellationCallback {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param token Token to observe
+     * @param callback Callback run on cancellation; must not throw
+     */
+    CancellationCallback(const CancellationToken& token, std::function<void()> callback)
+        : token_(token), registration_(token.onCancel(std::move(callback))) {}
+
+    ~CancellationCallback() {
+        if (registration_ != 0) {
+            token_.removeCallback(registration_);
+        }
+    }
+
+    CancellationCallback(const CancellationCallback&) = delete;
+    CancellationCallback& operator=(const CancellationCallback&) = delete;
+
+private:
+    CancellationToken token_;
+    CancellationToken::Registration registration_;
+};
+
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,96 @@
+#include "orchestrator/communication/deduplication_cache.h"
+#include <algorithm>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+DeduplicationCache::DeduplicationCache(std::chrono::milliseconds window, size_t maxEntries)
+    : window_(window), maxEntries_(std::max<size_t>(1, maxEntries)) {}
+
+bool DeduplicationCache::begin(const std::string& key, ResponseCallback& done) {
+    AgentResponse replay{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        evict(now);
+
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            entries_.emplace(key, Entry());
+            return true;
+        }
+
+        duplicates_++;
+        if (!it->second.completed) {
+            it->second.waiters.push_back(std::move(done));
+            return false;
+        }
+        replay = it->second.response;
+    }
+
+    done(std::move(replay));
+    return false;
+}
+
+void DeduplicationCache::complete(const std::string& key, const AgentResponse& response) {
+    std::vector<ResponseCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        it->second.completed = true;
+        it->second.completedAt = now;
+        it->second.response = response;
+        waiters.swap(it->second.waiters);
+        completionOrder_.emplace_back(now, key);
+        evict(now);
+    }
+
+    for (auto& waiter : waiters) {
+        waiter(AgentResponse(response));
+    }
+}
+
+void DeduplicationCache::abandon(const std::string& key, const AgentResponse& response) {
+    std::vector<ResponseCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || it->second.completed) {
+            return;
+        }
+        waiters.swap(it->second.waiters);
+        entries_.erase(it);
+    }
+
+    for (auto& waiter : waiters) {
+        waiter(AgentResponse(response));
+    }
+}
+
+uint64_t DeduplicationCache::duplicates() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return duplicates_;
+}
+
+void DeduplicationCache::evict(TimePoint now) {
+    // Running requests are never evicted; only completed entries are ordered here
+    while (!completionOrder_.empty() &&
+           (completionOrder_.size() > maxEntries_ || now - completionOrder_.front().first >= window_)) {
+        auto it = entries_.find(completionOrder_.front().second);
+        if (it != entries_.end() && it->second.completed &&
+            it->second.completedAt == completionOrder_.front().first) {
+            entries_.erase(it);
+        }
+        completionOrder_.pop_front();
+    }
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Receiver-side cache that runs each request key at most once
+ *
+ * Keys are sender plus correlationId. The first arrival of a key runs the
+ * handler. Duplicates that arrive while it is still running wait for its
+ * response; later duplicates within the window get the stored response.
+ * Completed entries expire after the window or when the cache is full,
+ * oldest first. Requests whose handler could not run are abandoned rather
+ * than completed, so a retry is not answered with the stored rejection.
+ */
+class DeduplicationCache {
+public:
+    using AgentResponse = GrpcCommunicationProtocol::AgentResponse;
+    using ResponseCallback = std::function<void(AgentResponse&&)>;
+
+    /**
+     * @brief Construct a cache
+     *
+     * @param window How long a completed response is replayed
+     * @param maxEntries Maximum number of completed entries kept
+     */
+    DeduplicationCache(std::chrono::milliseconds window, size_t maxEntries);
+
+    /**
+     * @brief Claim a key or attach to the request that already holds it
+     *
+     * @param key Request key
+     * @param done Callback for this arrival; taken over unless the caller should run the handler
+     * @return bool True if the caller should run the handler and then call complete()
+     */
+    bool begin(const std::string& key, ResponseCallback& done);
+
+    /**
+     * @brief Record the response for a claimed key and answer the waiting duplicates
+     *
+     * @param key Key claimed with begin()
+     * @param response Handler response
+     */
+    void complete(const std::string& key, const AgentResponse& response);
+
+    /**
+     * @brief Release a claimed key without recording a response
+     *
+     * For requests whose handler never ran; the next arrival of the key runs
+     * it. Duplicates already waiting get the given response.
+     *
+     * @param key Key claimed with begin()
+     * @param response Response for the waiting duplicates
+     */
+    void abandon(const std::string& key, const AgentResponse& response);
+
+    /**
+     * @brief Get the number of arrivals answered without running the handler
+     *
+     * @return uint64_t Suppressed duplicates
+     */
+    uint64_t duplicates() const;
+
+private:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Entry {
+        bool completed = false;
+        TimePoint completedAt;
+        AgentResponse response{};
+        std::vector<ResponseCallback> waiters;
+    };
+
+    // Caller holds mutex_
+    void evict(TimePoint now);
+
+    std::chrono::milliseconds window_;
+    size_t maxEntries_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::deque<std::pair<TimePoint, std::string>> completionOrder_;
+    uint64_t duplicates_ = 0;
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
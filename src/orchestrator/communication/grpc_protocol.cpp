@@ -0,0 +1,2906 @@
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/communication/message_codec.h"
+#include "orchestrator/communication/local_transport.h"
+#include "orchestrator/communication/message_types.h"
+#include "orchestrator/communication/handler_executor.h"
+#include "orchestrator/communication/deduplication_cache.h"
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/alarm.h>
+#include <grpc/compression.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+namespace {
+
+int64_t currentTimeMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool readFile(const std::string& path, std::string* contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    *contents = ss.str();
+    return true;
+}
+
+GrpcCommunicationProtocol::AgentResponse makeErrorResponse(const std::string& correlationId,
+                                                           const std::string& errorMessage) {
+    GrpcCommunicationProtocol::AgentResponse response{};
+    response.success = false;
+    response.errorMessage = errorMessage;
+    response.timestamp = currentTimeMillis();
+    response.correlationId = correlationId;
+    return response;
+}
+
+// Set on completion-queue polling threads, where blocking on backpressure would deadlock
+thread_local bool tPollingThread = false;
+
+// unix: addresses are same-host by construction
+bool isUnixAddress(const std::string& address) {
+    return address.compare(0, 5, "unix:") == 0 || address.compare(0, 14, "unix-abstract:") == 0;
+}
+
+// Replaces a trailing ":0" with the port the server was given for it
+std::string withSelectedPort(const std::string& address, int selectedPort) {
+    if (isUnixAddress(address) || selectedPort <= 0 || address.size() < 2 ||
+        address.compare(address.size() - 2, 2, ":0") != 0) {
+        return address;
+    }
+    return address.substr(0, address.size() - 1) + std::to_string(selectedPort);
+}
+
+// Metadata in which each side lists the encodings it accepts, sent on every call
+const char kAcceptEncodingKey[] = "dist-prompt-accept-encoding";
+
+grpc_compression_algorithm toGrpcAlgorithm(GrpcCommunicationProtocol::CompressionAlgorithm algorithm) {
+    switch (algorithm) {
+        case GrpcCommunicationProtocol::CompressionAlgorithm::DEFLATE:
+            return GRPC_COMPRESS_DEFLATE;
+        case GrpcCommunicationProtocol::CompressionAlgorithm::GZIP:
+            return GRPC_COMPRESS_GZIP;
+        default:
+            return GRPC_COMPRESS_NONE;
+    }
+}
+
+// One bit per accepted grpc_compression_algorithm, or -1 if the peer did not advertise
+int parseAcceptEncoding(const std::multimap<grpc::string_ref, grpc::string_ref>& metadata) {
+    auto it = metadata.find(kAcceptEncodingKey);
+    if (it == metadata.end()) {
+        return -1;
+    }
+
+    std::string value(it->second.data(), it->second.size());
+    int accepted = 0;
+    std::stringstream ss(value);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        for (int algorithm = GRPC_COMPRESS_NONE; algorithm < GRPC_COMPRESS_ALGORITHMS_COUNT; ++algorithm) {
+            const char* name = nullptr;
+            if (grpc_compression_algorithm_name(static_cast<grpc_compression_algorithm>(algorithm), &name) &&
+                token == name) {
+                accepted |= 1 << algorithm;
+            }
+        }
+    }
+    return accepted;
+}
+
+// Moves a payload into the form the receiver asked for with setZeroCopyPayloads();
+// a non-empty view wins, as it does on the wire
+void adaptPayload(std::string& bytes, PayloadView& view, bool copyPayload) {
+    if (copyPayload) {
+        if (!view.empty()) {
+            bytes = view.toString();
+            view = PayloadView();
+        }
+    } else {
+        if (view.empty()) {
+            view = PayloadView::fromString(std::move(bytes));
+        }
+        bytes.clear();
+    }
+}
+
+} // namespace
+
+// Private implementation class (PIMPL idiom)
+class GrpcCommunicationProtocol::Impl {
+public:
+    // Completion-queue tag: every pending async operation points at one of these
+    class CallState {
+    public:
+        virtual ~CallState() = default;
+        virtual void proceed(bool ok) = 0;
+    };
+
+    // Tag that forwards a completion to a member function, for objects with
+    // several operations in flight at once (streams)
+    template <typename Owner>
+    class OperationTag : public CallState {
+    public:
+        OperationTag(Owner* owner, void (Owner::*handler)(bool))
+            : owner_(owner), handler_(handler) {}
+
+        void proceed(bool ok) override {
+            (owner_->*handler_)(ok);
+        }
+
+    private:
+        Owner* owner_;
+        void (Owner::*handler_)(bool);
+    };
+
+    // Server side of one call. Unary calls go request -> read -> dispatch -> write
+    // and finish; stream calls keep one read and one write in flight until the
+    // client half-closes.
+    class ServerCall : public CallState {
+    public:
+        ServerCall(Impl* impl, grpc::ServerCompletionQueue* cq)
+            : impl_(impl), cq_(cq), stream_(&ctx_), state_(State::REQUESTED),
+              readTag_(this, &ServerCall::onStreamRead),
+              writeTag_(this, &ServerCall::onStreamWrite),
+              finishTag_(this, &ServerCall::onStreamFinish) {
+            {
+                std::lock_guard<std::mutex> lock(impl_->liveCallsMutex_);
+                impl_->liveServerCalls_++;
+            }
+            impl_->service_.RequestCall(&ctx_, &stream_, cq_, cq_, this);
+        }
+
+        ~ServerCall() {
+            std::lock_guard<std::mutex> lock(impl_->liveCallsMutex_);
+            impl_->liveServerCalls_--;
+            impl_->liveCallsCv_.notify_all();
+        }
+
+        void proceed(bool ok) override {
+            switch (state_) {
+                case State::REQUESTED:
+                    if (!ok) {
+                        // Server is shutting down
+                        delete this;
+                        return;
+                    }
+
+                    // Keep a request outstanding on this queue before serving this one
+                    impl_->requestCall(cq_);
+                    ring_ = isUnixAddress(ctx_.peer()) ? impl_->sharedMemoryRing() : nullptr;
+
+                    // Answer the client's encoding list with ours; same-host peers never compress
+                    ctx_.AddInitialMetadata(kAcceptEncodingKey, impl_->acceptEncoding());
+                    if (!isUnixAddress(ctx_.peer())) {
+                        algorithm_ = impl_->negotiatedAlgorithm(parseAcceptEncoding(ctx_.client_metadata()));
+                    }
+
+                    if (ctx_.method() == MessageCodec::kStreamMethod) {
+                        state_ = State::STREAMING;
+                        if (algorithm_ != GRPC_COMPRESS_NONE) {
+                            ctx_.set_compression_algorithm(algorithm_);
+                        }
+                        stream_.Read(&request_, &readTag_);
+                    } else if (ctx_.method() == MessageCodec::kUnaryMethod ||
+                               ctx_.method() == MessageCodec::kBatchMethod) {
+                        state_ = State::READING;
+                        stream_.Read(&request_, this);
+                    } else {
+                        state_ = State::FINISHING;
+                        stream_.Finish(grpc::Status(grpc::StatusCode::UNIMPLEMENTED,
+                                                    "Unknown method: " + ctx_.method()), this);
+                    }
+                    break;
+
+                case State::READING: {
+                    state_ = State::FINISHING;
+                    AgentMessage message{};
+                    if (ok && ctx_.method() == MessageCodec::kBatchMethod) {
+                        finishBatch();
+                    } else if (!ok) {
+                        stream_.Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                                    "Missing request message"), this);
+                    } else if (!MessageCodec::decodeMessage(request_, &message, impl_->copyPayloads())) {
+                        stream_.Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                                    "Malformed agent message"), this);
+                    } else {
+                        // May complete on the type's executor; the call stays alive until it does
+                        impl_->dispatch(std::move(message), [this](AgentResponse&& response) {
+                            finishUnary(MessageCodec::encodeResponse(response, ring_));
+                        });
+                    }
+                    break;
+                }
+
+                case State::STREAMING:
+                    // Stream operations complete on their own tags
+                    break;
+
+                case State::FINISHING:
+                    delete this;
+                    break;
+            }
+        }
+
+    private:
+        enum class State { REQUESTED, READING, STREAMING, FINISHING };
+
+        // Dispatches every message of a batch and answers with one response batch in
+        // message order. Messages are handed out in order; types bound to a
+        // multi-threaded executor may run concurrently.
+        void finishBatch() {
+            std::vector<AgentMessage> messages;
+            if (!MessageCodec::decodeMessageBatch(request_, &messages, impl_->copyPayloads())) {
+                stream_.Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                            "Malformed message batch"), this);
+                return;
+            }
+            if (messages.empty()) {
+                finishUnary(MessageCodec::encodeResponseBatch({}, ring_));
+                return;
+            }
+
+            struct Pending {
+                std::vector<AgentResponse> responses;
+                std::atomic<size_t> remaining;
+            };
+            auto pending = std::make_shared<Pending>();
+            pending->responses.resize(messages.size());
+            pending->remaining = messages.size();
+
+            for (size_t i = 0; i < messages.size(); ++i) {
+                impl_->dispatch(std::move(messages[i]), [this, pending, i](AgentResponse&& response) {
+                    pending->responses[i] = std::move(response);
+                    if (pending->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        finishUnary(MessageCodec::encodeResponseBatch(pending->responses, ring_));
+                    }
+                });
+            }
+        }
+
+        // Writes the only response of a unary call, compressed if it is large enough
+        void finishUnary(grpc::ByteBuffer response) {
+            if (impl_->compressResponse(algorithm_, response.Length())) {
+                ctx_.set_compression_algorithm(algorithm_);
+            }
+            stream_.WriteAndFinish(response, grpc::WriteOptions(), grpc::Status::OK, this);
+        }
+
+        // Caller holds streamMutex_
+        void startStreamWrite() {
+            writing_ = true;
+            grpc::WriteOptions options;
+            if (!impl_->compressResponse(algorithm_, writeQueue_.front().Length())) {
+                options.set_no_compression();
+            }
+            stream_.Write(writeQueue_.front(), options, &writeTag_);
+        }
+
+        void onStreamRead(bool ok) {
+            if (!ok) {
+                // Client half-closed or the stream broke; finish once writes drain
+                std::lock_guard<std::mutex> lock(streamMutex_);
+                readsDone_ = true;
+                maybeFinishStream();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(streamMutex_);
+                pendingDispatches_++;
+            }
+
+            // Responses are matched by correlationId, so they may go out of order
+            AgentMessage message{};
+            if (MessageCodec::decodeMessage(request_, &message, impl_->copyPayloads())) {
+                impl_->dispatch(std::move(message), [this](AgentResponse&& response) {
+                    onStreamDispatched(std::move(response));
+                });
+            } else {
+                onStreamDispatched(makeErrorResponse("", "Malformed agent message"));
+            }
+
+            std::lock_guard<std::mutex> lock(streamMutex_);
+            stream_.Read(&request_, &readTag_);
+        }
+
+        void onStreamDispatched(AgentResponse&& response) {
+            std::lock_guard<std::mutex> lock(streamMutex_);
+            pendingDispatches_--;
+            writeQueue_.push_back(MessageCodec::encodeResponse(response, ring_));
+            if (!writing_) {
+                startStreamWrite();
+            }
+        }
+
+        void onStreamWrite(bool ok) {
+            std::lock_guard<std::mutex> lock(streamMutex_);
+            writeQueue_.pop_front();
+            writing_ = false;
+            if (!ok) {
+                // Peer is gone; the pending read fails as well
+                writeQueue_.clear();
+            }
+
+            if (!writeQueue_.empty()) {
+                startStreamWrite();
+                return;
+            }
+            maybeFinishStream();
+        }
+
+        void onStreamFinish(bool /*ok*/) {
+            delete this;
+        }
+
+        // Caller holds streamMutex_
+        void maybeFinishStream() {
+            if (readsDone_ && !writing_ && !finishing_ && pendingDispatches_ == 0) {
+                finishing_ = true;
+                stream_.Finish(grpc::Status::OK, &finishTag_);
+            }
+        }
+
+        Impl* impl_;
+        grpc::ServerCompletionQueue* cq_;
+        grpc::GenericServerContext ctx_;
+        grpc::GenericServerAsyncReaderWriter stream_;
+        grpc::ByteBuffer request_;
+        State state_;
+        SharedMemoryRing* ring_ = nullptr;   // Set for same-host peers
+        grpc_compression_algorithm algorithm_ = GRPC_COMPRESS_NONE;   // Agreed with the client
+
+        // Streaming state
+        OperationTag<ServerCall> readTag_;
+        OperationTag<ServerCall> writeTag_;
+        OperationTag<ServerCall> finishTag_;
+        std::mutex streamMutex_;
+        std::deque<grpc::ByteBuffer> writeQueue_;
+        bool writing_ = false;
+        bool readsDone_ = false;
+        bool finishing_ = false;
+        int pendingDispatches_ = 0;   // Handlers still running for this stream
+    };
+
+    // Compression agreed with one peer. Calls hold a reference so they can record
+    // the encodings the peer advertises in its response metadata.
+    struct PeerCompression {
+        bool eligible = true;            // False for same-host peers
+        std::atomic<int> accepted{-1};   // Bit per grpc_compression_algorithm; -1 until the peer answers
+        std::atomic<uint64_t> compressedMessages{0};
+        std::atomic<uint64_t> uncompressedMessages{0};
+        std::atomic<uint64_t> compressedBytes{0};
+
+        void learn(const grpc::ClientContext& context) {
+            int advertised = parseAcceptEncoding(context.GetServerInitialMetadata());
+            if (advertised >= 0) {
+                accepted.store(advertised, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // One pooled channel to an endpoint; every call or stream on it holds a reference
+    struct ChannelSlot {
+        std::shared_ptr<grpc::Channel> channel;
+        std::unique_ptr<grpc::GenericStub> stub;
+        std::atomic<int> activeCalls{0};
+        std::atomic<int64_t> lastUsedMs{0};
+
+        void touch() {
+            lastUsedMs.store(steadyMillis(), std::memory_order_relaxed);
+        }
+
+        void release() {
+            touch();
+            activeCalls.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+
+    // Lets a caller abort its unary call while the call is on the wire
+    struct CallHandle {
+        std::mutex mutex;
+        grpc::ClientContext* context = nullptr;  // Set while the call is in flight
+        bool cancelled = false;
+        std::chrono::system_clock::time_point deadline = std::chrono::system_clock::time_point::max();
+
+        // Before the call starts; TryCancel() on an unstarted context cancels it at start
+        void attach(grpc::ClientContext* callContext) {
+            std::lock_guard<std::mutex> lock(mutex);
+            context = callContext;
+            if (cancelled) {
+                context->TryCancel();
+            }
+        }
+
+        void detach() {
+            std::lock_guard<std::mutex> lock(mutex);
+            context = nullptr;
+        }
+
+        void cancel() {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+            if (context) {
+                context->TryCancel();
+            }
+        }
+    };
+
+    // Client side of one unary call; completes on the client completion queue
+    class ClientCall : public CallState {
+    public:
+        ClientCall(std::string correlationId, std::function<void(const AgentResponse&)> callback)
+            : correlationId_(std::move(correlationId)), callback_(std::move(callback)) {}
+
+        void proceed(bool /*ok*/) override {
+            channel->release();
+            if (handle) {
+                handle->detach();
+            }
+
+            AgentResponse response{};
+            if (status_.ok()) {
+                compression->learn(context);
+            }
+            if (!status_.ok()) {
+                response = makeErrorResponse(correlationId_,
+                    "RPC failed (" + std::to_string(status_.error_code()) + "): " +
+                    status_.error_message());
+            } else if (!MessageCodec::decodeResponse(response_, &response, copyPayload)) {
+                response = makeErrorResponse(correlationId_, "Malformed agent response");
+            }
+
+            if (callback_) {
+                callback_(response);
+            }
+            delete this;
+        }
+
+        grpc::ClientContext context;
+        grpc::ByteBuffer response_;
+        grpc::Status status_;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<grpc::ByteBuffer>> reader;
+        bool copyPayload = true;
+        std::shared_ptr<ChannelSlot> channel;
+        std::shared_ptr<PeerCompression> compression;
+        std::shared_ptr<CallHandle> handle;
+
+    private:
+        std::string correlationId_;
+        std::function<void(const AgentResponse&)> callback_;
+    };
+
+    // Settles a cancellable send once, with the response or the cancellation
+    struct PendingSend {
+        std::atomic<bool> settled{false};
+        std::promise<AgentResponse> response;
+
+        void settle(const AgentResponse& value) {
+            if (!settled.exchange(true)) {
+                response.set_value(value);
+            }
+        }
+    };
+
+    // Client side of one batch call; fans the response batch out to per-message callbacks
+    class ClientBatchCall : public CallState {
+    public:
+        using ResponseCallback = std::function<void(const AgentResponse&)>;
+
+        ClientBatchCall(std::vector<std::string> correlationIds,
+                        std::vector<ResponseCallback> callbacks,
+                        std::function<void()> onComplete)
+            : correlationIds_(std::move(correlationIds)),
+              callbacks_(std::move(callbacks)),
+              onComplete_(std::move(onComplete)) {}
+
+        void proceed(bool /*ok*/) override {
+            channel->release();
+
+            std::vector<AgentResponse> responses;
+            std::string error;
+            if (status_.ok()) {
+                compression->learn(context);
+            }
+            if (!status_.ok()) {
+                error = "RPC failed (" + std::to_string(status_.error_code()) + "): " +
+                        status_.error_message();
+            } else if (!MessageCodec::decodeResponseBatch(response_, &responses, copyPayload) ||
+                       responses.size() != callbacks_.size()) {
+                error = "Malformed response batch";
+            }
+
+            for (size_t i = 0; i < callbacks_.size(); ++i) {
+                if (!callbacks_[i]) {
+                    continue;
+                }
+                callbacks_[i](error.empty() ? responses[i] : makeErrorResponse(correlationIds_[i], error));
+            }
+
+            if (onComplete_) {
+                onComplete_();
+            }
+            delete this;
+        }
+
+        grpc::ClientContext context;
+        grpc::ByteBuffer response_;
+        grpc::Status status_;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<grpc::ByteBuffer>> reader;
+        bool copyPayload = true;
+        std::shared_ptr<ChannelSlot> channel;
+        std::shared_ptr<PeerCompression> compression;
+
+    private:
+        std::vector<std::string> correlationIds_;
+        std::vector<ResponseCallback> callbacks_;
+        std::function<void()> onComplete_;
+    };
+
+    // Message waiting in a destination's batch queue
+    struct QueuedSend {
+        AgentMessage message;
+        std::function<void(const AgentResponse&)> callback;
+    };
+
+    // Per-destination batch queue
+    struct BatchQueue {
+        std::mutex mutex;
+        std::vector<QueuedSend> pending;
+        size_t pendingBytes = 0;
+        int inFlightBatches = 0;
+        uint64_t generation = 0;   // Bumped on every flush; invalidates stale flush deadlines
+    };
+
+    // Per-destination admission window for sendMessageAsync(): at most maxInFlight
+    // sends outstanding, then up to maxQueued waiting, then the overflow policy
+    struct SendWindow {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t inFlight = 0;
+        std::deque<QueuedSend> queued;   // Callbacks here are the caller's, not yet wrapped
+        size_t peakQueued = 0;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;
+        uint64_t rejected = 0;
+        uint64_t blocked = 0;
+    };
+
+    // Client side of a persistent bidirectional stream to one server. Messages are
+    // written in order, responses are matched to callbacks by correlationId, and
+    // an alarm sweeps requests that outlive the connection timeout. The stream
+    // keeps itself alive until its last operation completes.
+    class ClientStream {
+    public:
+        using ResponseCallback = std::function<void(const AgentResponse&)>;
+
+        ClientStream(Impl* impl, std::shared_ptr<ChannelSlot> channel,
+                     std::shared_ptr<PeerCompression> compression, grpc::CompletionQueue* cq,
+                     SharedMemoryRing* ring)
+            : impl_(impl), cq_(cq), ring_(ring), channel_(std::move(channel)),
+              compression_(std::move(compression)),
+              startTag_(this, &ClientStream::onStart),
+              readTag_(this, &ClientStream::onRead),
+              writeTag_(this, &ClientStream::onWrite),
+              finishTag_(this, &ClientStream::onFinish),
+              alarmTag_(this, &ClientStream::onAlarm) {
+            // The algorithm is fixed per call; messages that should not be compressed opt out
+            context_.AddMetadata(kAcceptEncodingKey, impl_->acceptEncoding());
+            if (compression_->eligible) {
+                algorithm_ = impl_->configuredAlgorithm();
+            }
+            if (algorithm_ != GRPC_COMPRESS_NONE) {
+                context_.set_compression_algorithm(algorithm_);
+            }
+            call_ = channel_->stub->PrepareCall(&context_, MessageCodec::kStreamMethod, cq_);
+        }
+
+        // Takes over the caller's reference on the channel slot
+        static std::shared_ptr<ClientStream> open(Impl* impl, std::shared_ptr<ChannelSlot> channel,
+                                                  std::shared_ptr<PeerCompression> compression,
+                                                  grpc::CompletionQueue* cq, SharedMemoryRing* ring) {
+            auto stream = std::make_shared<ClientStream>(impl, std::move(channel), std::move(compression),
+                                                         cq, ring);
+            stream->self_ = stream;
+            {
+                std::lock_guard<std::mutex> lock(impl->liveStreamsMutex_);
+                impl->liveStreams_++;
+            }
+            stream->call_->StartCall(&stream->startTag_);
+            return stream;
+        }
+
+        ~ClientStream() {
+            channel_->release();
+            std::lock_guard<std::mutex> lock(impl_->liveStreamsMutex_);
+            impl_->liveStreams_--;
+            impl_->liveStreamsCv_.notify_all();
+        }
+
+        // Returns false if the stream has already failed; the caller opens a new one
+        bool send(const AgentMessage& message, ResponseCallback callback) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (broken_) {
+                return false;
+            }
+
+            channel_->touch();
+            auto deadline = std::chrono::system_clock::now() +
+                            std::chrono::milliseconds(impl_->connectionTimeoutMs_.load());
+            pending_[message.correlationId] = PendingRequest{std::move(callback), deadline};
+
+            grpc::ByteBuffer encoded = MessageCodec::encodeMessage(message, ring_);
+            grpc::WriteOptions options;
+            grpc_compression_algorithm chosen = impl_->compressionFor(*compression_, encoded.Length());
+            if (chosen == GRPC_COMPRESS_NONE || chosen != algorithm_) {
+                options.set_no_compression();
+            }
+            writeQueue_.emplace_back(std::move(encoded), options);
+
+            if (started_ && !writing_) {
+                startWrite();
+            }
+            if (!alarmArmed_) {
+                alarmArmed_ = true;
+                alarm_.Set(cq_, deadline, &alarmTag_);
+            }
+            return true;
+        }
+
+        bool isBroken() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return broken_;
+        }
+
+        // No request awaiting a response and nothing left to write
+        bool isIdle() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return pending_.empty() && writeQueue_.empty();
+        }
+
+        int64_t lastUsedMs() const {
+            return channel_->lastUsedMs.load(std::memory_order_relaxed);
+        }
+
+        void cancel() {
+            context_.TryCancel();
+            alarm_.Cancel();
+        }
+
+    private:
+        struct PendingRequest {
+            ResponseCallback callback;
+            std::chrono::system_clock::time_point deadline;
+        };
+
+        void onStart(bool ok) {
+            std::vector<std::pair<std::string, ResponseCallback>> failed;
+            std::shared_ptr<ClientStream> release;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!ok) {
+                    breakStream();
+                    failed = takeAllPending();
+                } else {
+                    started_ = true;
+                    call_->Read(&readBuffer_, &readTag_);
+                    if (!writeQueue_.empty()) {
+                        startWrite();
+                    }
+                }
+                release = releaseIfDone();
+            }
+
+            for (auto& [correlationId, pendingCallback] : failed) {
+                pendingCallback(makeErrorResponse(correlationId, "Stream failed to start"));
+            }
+        }
+
+        void onRead(bool ok) {
+            std::vector<std::pair<std::string, ResponseCallback>> failed;
+            ResponseCallback callback;
+            AgentResponse response{};
+            std::shared_ptr<ClientStream> release;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!ok) {
+                    breakStream();
+                    failed = takeAllPending();
+                    release = releaseIfDone();
+                } else {
+                    if (!learned_) {
+                        learned_ = true;
+                        compression_->learn(context_);
+                    }
+                    if (MessageCodec::decodeResponse(readBuffer_, &response, impl_->copyPayloads())) {
+                        auto it = pending_.find(response.correlationId);
+                        if (it != pending_.end()) {
+                            callback = std::move(it->second.callback);
+                            pending_.erase(it);
+                        }
+                    } else {
+                        // The request it answers cannot be told; it fails at its deadline
+                        impl_->malformedStreamFrames_++;
+                    }
+                    call_->Read(&readBuffer_, &readTag_);
+                }
+            }
+
+            if (callback) {
+                callback(response);
+            }
+            for (auto& [correlationId, pendingCallback] : failed) {
+                pendingCallback(makeErrorResponse(correlationId, "Stream closed before response arrived"));
+            }
+        }
+
+        void onWrite(bool ok) {
+            std::shared_ptr<ClientStream> release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            writing_ = false;
+            writeQueue_.pop_front();
+            if (ok && !broken_ && !writeQueue_.empty()) {
+                startWrite();
+            }
+            release = releaseIfDone();
+        }
+
+        void onFinish(bool /*ok*/) {
+            std::shared_ptr<ClientStream> release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+            release = releaseIfDone();
+        }
+
+        void onAlarm(bool ok) {
+            std::vector<std::pair<std::string, ResponseCallback>> expired;
+            std::shared_ptr<ClientStream> release;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                alarmArmed_ = false;
+
+                auto now = std::chrono::system_clock::now();
+                auto nextDeadline = std::chrono::system_clock::time_point::max();
+                for (auto it = pending_.begin(); it != pending_.end();) {
+                    if (it->second.deadline <= now) {
+                        expired.emplace_back(it->first, std::move(it->second.callback));
+                        it = pending_.erase(it);
+                    } else {
+                        nextDeadline = std::min(nextDeadline, it->second.deadline);
+                        ++it;
+                    }
+                }
+
+                if (ok && !broken_ && !pending_.empty()) {
+                    alarmArmed_ = true;
+                    alarm_.Set(cq_, nextDeadline, &alarmTag_);
+                }
+                release = releaseIfDone();
+            }
+
+            for (auto& [correlationId, callback] : expired) {
+                callback(makeErrorResponse(correlationId, "Deadline Exceeded"));
+            }
+        }
+
+        // Caller holds mutex_
+        void startWrite() {
+            writing_ = true;
+            call_->Write(writeQueue_.front().first, writeQueue_.front().second, &writeTag_);
+        }
+
+        // Caller holds mutex_; pending requests are failed by the caller, so the
+        // deadline sweep has nothing left to do
+        void breakStream() {
+            if (!broken_) {
+                broken_ = true;
+                call_->Finish(&status_, &finishTag_);
+                if (alarmArmed_) {
+                    alarm_.Cancel();
+                }
+            }
+        }
+
+        // Caller holds mutex_
+        std::vector<std::pair<std::string, ResponseCallback>> takeAllPending() {
+            std::vector<std::pair<std::string, ResponseCallback>> callbacks;
+            for (auto& [correlationId, request] : pending_) {
+                callbacks.emplace_back(correlationId, std::move(request.callback));
+            }
+            pending_.clear();
+            return callbacks;
+        }
+
+        // Caller holds mutex_; the returned reference is dropped after unlocking
+        std::shared_ptr<ClientStream> releaseIfDone() {
+            if (finished_ && !writing_ && !alarmArmed_) {
+                return std::move(self_);
+            }
+            return nullptr;
+        }
+
+        Impl* impl_;
+        grpc::CompletionQueue* cq_;
+        SharedMemoryRing* ring_;
+        std::shared_ptr<ChannelSlot> channel_;
+        std::shared_ptr<PeerCompression> compression_;
+        grpc_compression_algorithm algorithm_ = GRPC_COMPRESS_NONE;
+        grpc::ClientContext context_;
+        std::unique_ptr<grpc::GenericClientAsyncReaderWriter> call_;
+        grpc::ByteBuffer readBuffer_;
+        grpc::Status status_;
+        grpc::Alarm alarm_;
+
+        OperationTag<ClientStream> startTag_;
+        OperationTag<ClientStream> readTag_;
+        OperationTag<ClientStream> writeTag_;
+        OperationTag<ClientStream> finishTag_;
+        OperationTag<ClientStream> alarmTag_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, PendingRequest> pending_;
+        std::deque<std::pair<grpc::ByteBuffer, grpc::WriteOptions>> writeQueue_;
+        std::shared_ptr<ClientStream> self_;
+        bool learned_ = false;   // Peer's accepted encodings recorded
+        bool started_ = false;
+        bool writing_ = false;
+        bool broken_ = false;
+        bool finished_ = false;
+        bool alarmArmed_ = false;
+    };
+
+    // Outbound endpoint. Channels are opened on demand, up to maxChannelsPerEndpoint
+    // when calls exceed maxStreamsPerChannel, and closed again once idle.
+    struct Connection {
+        std::string address;
+        bool sameHost = false;   // unix: socket; eligible for the shared-memory ring
+        std::shared_ptr<grpc::ChannelCredentials> credentials;
+        std::vector<std::shared_ptr<ChannelSlot>> channels;
+        std::mutex channelsMutex;
+        
+        // Persistent stream, opened on first use when streaming is enabled
+        std::shared_ptr<ClientStream> stream;
+        std::mutex streamMutex;
+        
+        // Coalescing queue for sendMessageAsync()
+        BatchQueue batchQueue;
+        
+        // Backpressure for sendMessageAsync()
+        SendWindow window;
+        
+        // In-process endpoint for this address, revalidated against the registry generation
+        std::mutex localMutex;
+        uint64_t localGeneration = 0;
+        std::shared_ptr<LocalEndpoint> localEndpoint;
+        
+        // Encodings the peer accepts, learned from its responses
+        std::shared_ptr<PeerCompression> compression = std::make_shared<PeerCompression>();
+    };
+
+    // Periodic idle-channel eviction, driven by an alarm on the client queue
+    class PoolSweeper : public CallState {
+    public:
+        PoolSweeper(Impl* impl, grpc::CompletionQueue* cq) : impl_(impl), cq_(cq) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            arm();
+        }
+
+        void proceed(bool ok) override {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                armed_ = false;
+                if (!ok || cancelled_) {
+                    // Fall through to delete outside the lock
+                } else {
+                    impl_->evictIdleChannels();
+                    arm();
+                    return;
+                }
+            }
+            delete this;
+        }
+
+        // The sweeper deletes itself once its alarm is no longer pending
+        void cancel() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_ = true;
+            if (armed_) {
+                alarm_.Cancel();
+            }
+        }
+
+    private:
+        // Caller holds mutex_
+        void arm() {
+            auto options = std::atomic_load(&impl_->channelPoolOptions_);
+            auto interval = std::clamp(options->idleTimeout / 4, std::chrono::milliseconds(100),
+                                       std::chrono::milliseconds(10000));
+            armed_ = true;
+            alarm_.Set(cq_, std::chrono::system_clock::now() + interval, this);
+        }
+
+        Impl* impl_;
+        grpc::CompletionQueue* cq_;
+        grpc::Alarm alarm_;
+        std::mutex mutex_;
+        bool armed_ = false;
+        bool cancelled_ = false;
+    };
+
+    // Recent latencies of one agent type; the hedge delay is a percentile of these
+    struct LatencyTracker {
+        static constexpr size_t kSamples = 512;
+        static constexpr size_t kMinSamples = 20;
+        static constexpr size_t kRefreshEvery = 64;
+
+        std::vector<int64_t> samplesUs;
+        size_t next = 0;
+        size_t sinceRefresh = 0;
+        int64_t cachedUs = -1;
+
+        void record(int64_t us) {
+            if (samplesUs.size() < kSamples) {
+                samplesUs.push_back(us);
+            } else {
+                samplesUs[next] = us;
+            }
+            next = (next + 1) % kSamples;
+            sinceRefresh++;
+        }
+
+        // -1 until there are enough samples; recomputed every kRefreshEvery samples
+        int64_t percentileUs(double percentile) {
+            if (samplesUs.size() < kMinSamples) {
+                return -1;
+            }
+            if (cachedUs < 0 || sinceRefresh >= kRefreshEvery) {
+                std::vector<int64_t> sorted(samplesUs);
+                size_t index = static_cast<size_t>(std::clamp(percentile, 0.0, 1.0) * (sorted.size() - 1));
+                std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+                cachedUs = sorted[index];
+                sinceRefresh = 0;
+            }
+            return cachedUs;
+        }
+    };
+
+    class HedgeTimer;
+
+    // One hedged request: the primary, then alternates after the hedge delay or
+    // as soon as an attempt fails. The first success, or the last failure, wins.
+    struct HedgeState {
+        std::mutex mutex;
+        AgentMessage message;
+        std::string agentType;
+        std::vector<std::string> alternates;
+        size_t nextAlternate = 0;
+        int outstanding = 0;
+        bool finished = false;
+        AgentResponse lastFailure{};
+        std::chrono::steady_clock::duration delay{};
+        HedgeTimer* timer = nullptr;   // Armed timer, cancelled once finished
+        std::vector<std::shared_ptr<CallHandle>> calls;   // One per attempt, cancelled on abandon
+        std::promise<AgentResponse> result;
+    };
+
+    // Fires the next hedge; deletes itself when the alarm completes or is cancelled
+    class HedgeTimer : public CallState {
+    public:
+        HedgeTimer(Impl* impl, std::shared_ptr<HedgeState> state) : impl_(impl), state_(std::move(state)) {}
+
+        // Caller holds the state mutex, so cancel() cannot run before the alarm is set
+        void arm(grpc::CompletionQueue* cq, std::chrono::steady_clock::duration delay) {
+            alarm_.Set(cq, std::chrono::system_clock::now() + delay, this);
+        }
+
+        void cancel() {
+            alarm_.Cancel();
+        }
+
+        void proceed(bool ok) override {
+            impl_->onHedgeTimer(state_, this, ok);
+            delete this;
+        }
+
+    private:
+        Impl* impl_;
+        std::shared_ptr<HedgeState> state_;
+        grpc::Alarm alarm_;
+    };
+
+    // Point in time at which a destination's partial batch must be flushed
+    struct FlushDeadline {
+        std::chrono::steady_clock::time_point when;
+        std::weak_ptr<Connection> connection;
+        uint64_t generation;
+
+        bool operator>(const FlushDeadline& other) const {
+            return when > other.when;
+        }
+    };
+
+    Impl()
+        : serverThreadCount_(std::max(1, static_cast<int>(std::thread::hardware_concurrency()))),
+          serverRunning_(false),
+          serverShuttingDown_(false),
+          connectionTimeoutMs_(5000) {
+        std::random_device seed;
+        std::stringstream ss;
+        ss << std::hex << ((static_cast<uint64_t>(seed()) << 32) | seed());
+        correlationPrefix_ = ss.str();
+    }
+
+    ~Impl() {
+        stopServer();
+        stopClient();
+    }
+
+    bool initializeServer(const std::string& serverAddress,
+                         const std::string& tlsCertPath,
+                         const std::string& tlsKeyPath,
+                         const std::string& caCertPath) {
+        if (serverRunning_.load()) {
+            return false;
+        }
+
+        if (isUnixAddress(serverAddress)) {
+            // Access is governed by the socket file's permissions; TLS would only add cost
+            serverCredentials_ = grpc::experimental::LocalServerCredentials(UDS);
+        } else if (tlsCertPath.empty() && tlsKeyPath.empty()) {
+            serverCredentials_ = grpc::InsecureServerCredentials();
+        } else {
+            grpc::SslServerCredentialsOptions::PemKeyCertPair keyCert;
+            if (!readFile(tlsKeyPath, &keyCert.private_key) ||
+                !readFile(tlsCertPath, &keyCert.cert_chain)) {
+                return false;
+            }
+
+            grpc::SslServerCredentialsOptions options;
+            options.pem_key_cert_pairs.push_back(keyCert);
+            if (!caCertPath.empty()) {
+                if (!readFile(caCertPath, &options.pem_root_certs)) {
+                    return false;
+                }
+                options.client_certificate_request =
+                    GRPC_SSL_REQUEST_AND_REQUIRE_CLIENT_CERTIFICATE_AND_VERIFY;
+            }
+            serverCredentials_ = grpc::SslServerCredentials(options);
+        }
+
+        serverAddress_ = serverAddress;
+        return true;
+    }
+
+    bool initializeClient(const std::string& serverAddress,
+                         const std::string& tlsCertPath,
+                         const std::string& tlsKeyPath,
+                         const std::string& caCertPath) {
+        std::shared_ptr<grpc::ChannelCredentials> credentials;
+        if (tlsCertPath.empty() && tlsKeyPath.empty() && caCertPath.empty()) {
+            credentials = grpc::InsecureChannelCredentials();
+        } else {
+            grpc::SslCredentialsOptions options;
+            if ((!caCertPath.empty() && !readFile(caCertPath, &options.pem_root_certs)) ||
+                (!tlsKeyPath.empty() && !readFile(tlsKeyPath, &options.pem_private_key)) ||
+                (!tlsCertPath.empty() && !readFile(tlsCertPath, &options.pem_cert_chain))) {
+                return false;
+            }
+            credentials = grpc::SslCredentials(options);
+        }
+
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        if (!clientCq_) {
+            clientCq_ = std::make_unique<grpc::CompletionQueue>();
+            clientThread_ = std::thread(&Impl::pollQueue, clientCq_.get());
+            poolSweeper_ = new PoolSweeper(this, clientCq_.get());
+        }
+
+        clientCredentials_ = credentials;
+        defaultConnection_ = createConnection(serverAddress);
+        return true;
+    }
+
+    bool registerPeer(const std::string& agentId, const std::string& serverAddress,
+                      const std::string& agentType) {
+        if (agentId.empty() || serverAddress.empty()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        if (!clientCredentials_) {
+            return false;
+        }
+
+        if (connectionsByAddress_.find(serverAddress) == connectionsByAddress_.end()) {
+            createConnection(serverAddress);
+        }
+        peerAddresses_[agentId] = serverAddress;
+
+        // Keep the type groups used for hedging in step with the latest registration
+        auto typeIt = peerTypes_.find(agentId);
+        if (typeIt != peerTypes_.end() && typeIt->second != agentType) {
+            auto& group = peersByType_[typeIt->second];
+            group.erase(std::remove(group.begin(), group.end(), agentId), group.end());
+            peerTypes_.erase(typeIt);
+        }
+        if (!agentType.empty() && peerTypes_.emplace(agentId, agentType).second) {
+            peersByType_[agentType].push_back(agentId);
+        }
+        return true;
+    }
+
+    void setStreamingEnabled(bool enabled) {
+        streamingEnabled_ = enabled;
+    }
+
+    void setServerThreadCount(int threadCount) {
+        if (!serverRunning_.load() && threadCount > 0) {
+            serverThreadCount_ = threadCount;
+        }
+    }
+
+    bool startServer() {
+        if (serverRunning_.load()) {
+            return true;
+        }
+        if (serverAddress_.empty() || !serverCredentials_) {
+            return false;
+        }
+
+        grpc::ServerBuilder builder;
+        int selectedPort = 0;
+        builder.AddListeningPort(serverAddress_, serverCredentials_, &selectedPort);
+        builder.RegisterAsyncGenericService(&service_);
+        builder.SetMaxReceiveMessageSize(-1);
+
+        for (int i = 0; i < serverThreadCount_; ++i) {
+            serverCqs_.push_back(builder.AddCompletionQueue());
+        }
+
+        server_ = builder.BuildAndStart();
+        if (!server_) {
+            serverCqs_.clear();
+            return false;
+        }
+        serverAddress_ = withSelectedPort(serverAddress_, selectedPort);
+
+        serverShuttingDown_ = false;
+        for (auto& cq : serverCqs_) {
+            for (int i = 0; i < kPendingCallsPerQueue; ++i) {
+                requestCall(cq.get());
+            }
+            serverThreads_.emplace_back(&Impl::pollQueue, cq.get());
+        }
+
+        // Co-located clients bypass gRPC and hand messages straight to the handlers
+        localEndpoint_ = std::make_shared<LocalEndpoint>(
+            serverThreadCount_, kLocalQueueCapacity,
+            [this](AgentMessage&& message, LocalEndpoint::ResponseCallback&& callback) {
+                adaptPayload(message.payload, message.payloadView, copyPayloads());
+                dispatch(std::move(message), std::move(callback));
+            });
+        LocalTransportRegistry::registerEndpoint(serverAddress_, localEndpoint_);
+
+        serverRunning_ = true;
+        return true;
+    }
+
+    void stopServer() {
+        if (!serverRunning_.load()) {
+            return;
+        }
+
+        LocalTransportRegistry::unregisterEndpoint(serverAddress_, localEndpoint_.get());
+        localEndpoint_->stop();
+        localEndpoint_.reset();
+
+        {
+            // No new RequestCall() once shutdown has begun
+            std::unique_lock<std::shared_mutex> lock(shutdownMutex_);
+            serverShuttingDown_ = true;
+        }
+
+        server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+
+        // Cancelled calls still complete their last operations on the queues, which
+        // must stay open until every call object is gone
+        {
+            std::unique_lock<std::mutex> lock(liveCallsMutex_);
+            liveCallsCv_.wait(lock, [this]() { return liveServerCalls_ == 0; });
+        }
+
+        for (auto& cq : serverCqs_) {
+            cq->Shutdown();
+        }
+        for (auto& thread : serverThreads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        serverThreads_.clear();
+        serverCqs_.clear();
+        server_.reset();
+        serverRunning_ = false;
+    }
+
+    AgentResponse sendMessage(const AgentMessage& message) {
+        if (auto hedge = prepareHedge(message)) {
+            auto future = hedge->result.get_future();
+            launchAttempt(hedge, message.receiverId, false);
+            armHedge(hedge);
+            return future.get();
+        }
+
+        auto connection = connectionFor(message.receiverId);
+        if (!connection) {
+            return makeErrorResponse(message.correlationId, "No client connection initialized");
+        }
+
+        auto promise = std::make_shared<std::promise<AgentResponse>>();
+        auto future = promise->get_future();
+        sendOn(*connection, message, [promise](const AgentResponse& response) {
+            promise->set_value(response);
+        });
+        return future.get();
+    }
+
+    AgentResponse sendMessage(const AgentMessage& message, const CancellationToken& cancellation) {
+        if (!cancellation.cancellable()) {
+            return sendMessage(message);
+        }
+        auto cancelled = [&message, &cancellation]() {
+            return makeErrorResponse(message.correlationId, "Cancelled: " + cancellation.reason());
+        };
+        if (cancellation.isCancelled()) {
+            return cancelled();
+        }
+
+        if (auto hedge = prepareHedge(message)) {
+            auto future = hedge->result.get_future();
+            CancellationCallback abort(cancellation, [this, hedge, &cancelled]() {
+                abandonHedge(hedge, cancelled());
+            });
+            launchAttempt(hedge, message.receiverId, false);
+            armHedge(hedge);
+            return future.get();
+        }
+
+        auto connection = connectionFor(message.receiverId);
+        if (!connection) {
+            return makeErrorResponse(message.correlationId, "No client connection initialized");
+        }
+
+        auto pending = std::make_shared<PendingSend>();
+        auto future = pending->response.get_future();
+        auto handle = std::make_shared<CallHandle>();
+        auto remaining = cancellation.remaining();
+        if (remaining != CancellationToken::Clock::duration::max()) {
+            handle->deadline = std::chrono::system_clock::now() +
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(remaining);
+        }
+
+        // The callback is removed before this returns, so it may capture locals.
+        // Settling first keeps the call's own CANCELLED status from winning.
+        CancellationCallback abort(cancellation, [pending, handle, &cancelled]() {
+            pending->settle(cancelled());
+            handle->cancel();
+        });
+        sendOn(*connection, message, [pending](const AgentResponse& response) {
+            pending->settle(response);
+        }, handle);
+        return future.get();
+    }
+
+    // Takes const or rvalue messages; rvalues destined for this process are moved, not copied
+    template <typename Message>
+    bool sendMessageAsync(Message&& message, std::function<void(const AgentResponse&)> callback) {
+        auto connection = connectionFor(message.receiverId);
+        if (!connection) {
+            return false;
+        }
+
+        if (!std::atomic_load(&sendQueueOptions_)->enabled) {
+            dispatchAsync(connection, std::forward<Message>(message), std::move(callback));
+            return true;
+        }
+        return admit(connection, std::forward<Message>(message), std::move(callback));
+    }
+
+    // Options are re-read on every pass, so a blocked sender sees limits changed while it waited
+    template <typename Message>
+    bool admit(const std::shared_ptr<Connection>& connection,
+               Message&& message,
+               std::function<void(const AgentResponse&)> callback) {
+        SendWindow& window = connection->window;
+        std::unique_lock<std::mutex> lock(window.mutex);
+        while (true) {
+            auto options = std::atomic_load(&sendQueueOptions_);
+            if (!options->enabled) {
+                lock.unlock();
+                dispatchAsync(connection, std::forward<Message>(message), std::move(callback));
+                return true;
+            }
+
+            if (window.inFlight < options->maxInFlight && window.queued.empty()) {
+                window.inFlight++;
+                window.sent++;
+                lock.unlock();
+                liveAdmitted_++;
+                dispatchAsync(connection, std::forward<Message>(message),
+                              completeAdmitted(connection, std::move(callback)));
+                return true;
+            }
+
+            if (window.queued.size() < options->maxQueued) {
+                window.queued.push_back(QueuedSend{AgentMessage(std::forward<Message>(message)),
+                                                   std::move(callback)});
+                window.peakQueued = std::max(window.peakQueued, window.queued.size());
+                return true;
+            }
+
+            switch (options->overflow) {
+                case OverflowPolicy::REJECT:
+                    window.rejected++;
+                    return false;
+
+                case OverflowPolicy::DROP_OLDEST: {
+                    // With maxQueued at zero there is nothing older to make room
+                    if (window.queued.empty()) {
+                        window.rejected++;
+                        return false;
+                    }
+                    QueuedSend oldest = std::move(window.queued.front());
+                    window.queued.pop_front();
+                    window.queued.push_back(QueuedSend{AgentMessage(std::forward<Message>(message)),
+                                                       std::move(callback)});
+                    window.dropped++;
+                    lock.unlock();
+                    if (oldest.callback) {
+                        oldest.callback(makeErrorResponse(oldest.message.correlationId,
+                                                          "Dropped: send queue overflow"));
+                    }
+                    return true;
+                }
+
+                case OverflowPolicy::BLOCK: {
+                    // Completions arrive on transport threads, so they must never wait here
+                    if (tPollingThread || LocalEndpoint::onWorkerThread()) {
+                        window.rejected++;
+                        return false;
+                    }
+
+                    window.blocked++;
+                    auto hasRoom = [&]() {
+                        auto current = std::atomic_load(&sendQueueOptions_);
+                        return !current->enabled ||
+                               (window.inFlight < current->maxInFlight && window.queued.empty()) ||
+                               window.queued.size() < current->maxQueued || clientStopping_.load();
+                    };
+                    if (options->blockTimeout.count() > 0) {
+                        if (!window.cv.wait_for(lock, options->blockTimeout, hasRoom)) {
+                            window.rejected++;
+                            return false;
+                        }
+                    } else {
+                        window.cv.wait(lock, hasRoom);
+                    }
+                    if (clientStopping_.load()) {
+                        window.rejected++;
+                        return false;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // Wraps a callback so that its completion frees the window slot or hands it to the next queued send
+    std::function<void(const AgentResponse&)> completeAdmitted(
+        const std::shared_ptr<Connection>& connection,
+        std::function<void(const AgentResponse&)> callback) {
+        std::weak_ptr<Connection> weakConnection = connection;
+        return [this, weakConnection, callback = std::move(callback)](const AgentResponse& response) {
+            if (callback) {
+                callback(response);
+            }
+            if (auto owner = weakConnection.lock()) {
+                onAdmittedComplete(owner);
+            } else {
+                releaseAdmitted();
+            }
+        };
+    }
+
+    void onAdmittedComplete(const std::shared_ptr<Connection>& connection) {
+        SendWindow& window = connection->window;
+        QueuedSend next;
+        bool haveNext = false;
+        {
+            std::lock_guard<std::mutex> lock(window.mutex);
+            if (!window.queued.empty() && !clientStopping_.load()) {
+                next = std::move(window.queued.front());
+                window.queued.pop_front();
+                window.sent++;
+                haveNext = true;
+            } else {
+                window.inFlight--;
+            }
+            window.cv.notify_all();
+        }
+
+        if (haveNext) {
+            dispatchAsync(connection, std::move(next.message),
+                          completeAdmitted(connection, std::move(next.callback)));
+        } else {
+            releaseAdmitted();
+        }
+    }
+
+    void releaseAdmitted() {
+        std::lock_guard<std::mutex> lock(liveAdmittedMutex_);
+        liveAdmitted_--;
+        liveAdmittedCv_.notify_all();
+    }
+
+    template <typename Message>
+    void dispatchAsync(const std::shared_ptr<Connection>& connection,
+                       Message&& message,
+                       std::function<void(const AgentResponse&)> callback) {
+        if (auto endpoint = localEndpointFor(*connection)) {
+            AgentMessage local(std::forward<Message>(message));
+            if (!postLocal(*endpoint, local, callback)) {
+                sendRemote(*connection, local, std::move(callback), nullptr);
+            }
+            return;
+        }
+
+        if (batchingEnabled_.load()) {
+            enqueueBatched(connection, message, std::move(callback));
+        } else {
+            sendOn(*connection, std::forward<Message>(message), std::move(callback));
+        }
+    }
+
+    void setSendQueueOptions(const SendQueueOptions& options) {
+        auto normalized = std::make_shared<SendQueueOptions>(options);
+        normalized->maxInFlight = std::max<size_t>(1, options.maxInFlight);
+        std::atomic_store(&sendQueueOptions_, std::shared_ptr<const SendQueueOptions>(normalized));
+
+        std::vector<std::shared_ptr<Connection>> connections;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            connections = connections_;
+        }
+        for (const auto& connection : connections) {
+            drainWindow(connection);
+        }
+    }
+
+    // Starts queued sends that a raised maxInFlight has room for, and wakes blocked
+    // senders so they re-check against the current limits
+    void drainWindow(const std::shared_ptr<Connection>& connection) {
+        SendWindow& window = connection->window;
+        std::vector<QueuedSend> ready;
+        {
+            std::lock_guard<std::mutex> lock(window.mutex);
+            auto options = std::atomic_load(&sendQueueOptions_);
+            while (!window.queued.empty() && window.inFlight < options->maxInFlight &&
+                   !clientStopping_.load()) {
+                ready.push_back(std::move(window.queued.front()));
+                window.queued.pop_front();
+                window.inFlight++;
+                window.sent++;
+            }
+            window.cv.notify_all();
+        }
+
+        for (auto& send : ready) {
+            liveAdmitted_++;
+            dispatchAsync(connection, std::move(send.message),
+                          completeAdmitted(connection, std::move(send.callback)));
+        }
+    }
+
+    std::vector<SendQueueStats> getSendQueueStats() const {
+        std::vector<std::shared_ptr<Connection>> connections;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            connections = connections_;
+        }
+
+        std::vector<SendQueueStats> stats;
+        stats.reserve(connections.size());
+        for (const auto& connection : connections) {
+            SendWindow& window = connection->window;
+            std::lock_guard<std::mutex> lock(window.mutex);
+            SendQueueStats entry;
+            entry.address = connection->address;
+            entry.inFlight = window.inFlight;
+            entry.queued = window.queued.size();
+            entry.peakQueued = window.peakQueued;
+            entry.sent = window.sent;
+            entry.dropped = window.dropped;
+            entry.rejected = window.rejected;
+            entry.blocked = window.blocked;
+            stats.push_back(std::move(entry));
+        }
+        return stats;
+    }
+
+    void setInProcessDelivery(bool enabled) {
+        inProcessDelivery_ = enabled;
+    }
+
+    void setSharedMemoryTransfer(bool enabled) {
+        sharedMemoryTransfer_ = enabled;
+    }
+
+    SharedMemoryRing* sharedMemoryRing() const {
+        return sharedMemoryTransfer_.load(std::memory_order_relaxed) ? SharedMemoryRing::local() : nullptr;
+    }
+
+    SharedMemoryRing* ringFor(const Connection& connection) const {
+        return connection.sameHost ? sharedMemoryRing() : nullptr;
+    }
+
+    void setZeroCopyPayloads(bool enabled) {
+        zeroCopyPayloads_ = enabled;
+    }
+
+    bool copyPayloads() const {
+        return !zeroCopyPayloads_.load(std::memory_order_relaxed);
+    }
+
+    void setBatchingOptions(const BatchingOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            batchingOptions_ = options;
+            batchingOptions_.maxBatchMessages = std::max<size_t>(1, options.maxBatchMessages);
+            batchingOptions_.maxInFlightBatches = std::max(1, options.maxInFlightBatches);
+            if (options.enabled && !flusherThread_.joinable()) {
+                flusherStop_ = false;
+                flusherThread_ = std::thread(&Impl::flushLoop, this);
+            }
+        }
+        batchingEnabled_ = options.enabled;
+    }
+
+    bool registerMessageHandler(const std::string& messageType, MessageHandler handler,
+                                std::shared_ptr<HandlerExecutor> executor) {
+        if (messageType.empty() || !handler) {
+            return false;
+        }
+
+        MessageTypeId id = MessageTypeRegistry::intern(messageType);
+
+        // Copy-on-write, so dispatch reads the table without locking
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        auto table = std::make_shared<std::vector<HandlerSlot>>(*std::atomic_load(&handlerTable_));
+        if (table->size() <= id) {
+            table->resize(id + 1);
+        }
+        (*table)[id] = HandlerSlot{std::move(handler), std::move(executor)};
+        std::atomic_store(&handlerTable_, std::shared_ptr<const std::vector<HandlerSlot>>(std::move(table)));
+        return true;
+    }
+
+    std::vector<AgentResponse> broadcastMessage(const AgentMessage& message) {
+        std::vector<std::shared_ptr<Connection>> connections;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            connections = connections_;
+        }
+
+        std::vector<std::future<AgentResponse>> futures;
+        futures.reserve(connections.size());
+        for (const auto& connection : connections) {
+            auto promise = std::make_shared<std::promise<AgentResponse>>();
+            futures.push_back(promise->get_future());
+            sendOn(*connection, message, [promise](const AgentResponse& response) {
+                promise->set_value(response);
+            });
+        }
+
+        std::vector<AgentResponse> responses;
+        responses.reserve(futures.size());
+        for (auto& future : futures) {
+            responses.push_back(future.get());
+        }
+        return responses;
+    }
+
+    BroadcastResult broadcastMessage(const AgentMessage& message, const BroadcastOptions& options) {
+        // Shared with the response callbacks, which may outlive this call
+        struct FanOut {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::vector<PeerResult> peers;
+            size_t answered = 0;
+            size_t succeeded = 0;
+            bool stopped = false;
+            bool returned = false;      // No onResponse calls once set
+            std::mutex callbackMutex;   // Serializes onResponse
+        };
+
+        std::vector<std::shared_ptr<Connection>> connections;
+        std::unordered_map<std::string, std::vector<std::string>> agentsByAddress;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            connections = connections_;
+            for (const auto& [agentId, address] : peerAddresses_) {
+                agentsByAddress[address].push_back(agentId);
+            }
+        }
+
+        auto fanOut = std::make_shared<FanOut>();
+        fanOut->peers.resize(connections.size());
+        for (size_t i = 0; i < connections.size(); ++i) {
+            PeerResult& peer = fanOut->peers[i];
+            peer.address = connections[i]->address;
+            peer.agentIds = agentsByAddress[peer.address];
+            peer.status = PeerStatus::TIMED_OUT;
+            peer.latency = std::chrono::milliseconds(0);
+        }
+
+        auto timeout = options.deadline.count() > 0 ?
+            options.deadline : std::chrono::milliseconds(connectionTimeoutMs_.load());
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + timeout;
+        auto onResponse = options.onResponse;
+        size_t quorum = options.quorum;
+
+        for (size_t i = 0; i < connections.size(); ++i) {
+            sendOn(*connections[i], message, [fanOut, i, start, onResponse, quorum](const AgentResponse& response) {
+                PeerResult result;
+                {
+                    std::lock_guard<std::mutex> lock(fanOut->mutex);
+                    if (fanOut->stopped) {
+                        return;
+                    }
+                    PeerResult& peer = fanOut->peers[i];
+                    peer.status = response.success ? PeerStatus::OK : PeerStatus::FAILED;
+                    peer.response = response;
+                    peer.latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start);
+                    fanOut->answered++;
+                    if (response.success) {
+                        fanOut->succeeded++;
+                    }
+                    if (quorum > 0 && fanOut->succeeded >= quorum) {
+                        fanOut->stopped = true;
+                    }
+                    if (onResponse) {
+                        result = peer;
+                    }
+                }
+
+                bool keepWaiting = true;
+                if (onResponse) {
+                    std::lock_guard<std::mutex> callbackLock(fanOut->callbackMutex);
+                    bool returned;
+                    {
+                        std::lock_guard<std::mutex> lock(fanOut->mutex);
+                        returned = fanOut->returned;
+                    }
+                    if (!returned) {
+                        keepWaiting = onResponse(result);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(fanOut->mutex);
+                if (!keepWaiting) {
+                    fanOut->stopped = true;
+                }
+                fanOut->cv.notify_all();
+            });
+        }
+
+        BroadcastResult result;
+        {
+            std::unique_lock<std::mutex> lock(fanOut->mutex);
+            fanOut->cv.wait_until(lock, deadline, [&]() {
+                return fanOut->stopped || fanOut->answered == fanOut->peers.size();
+            });
+            bool stoppedEarly = fanOut->stopped;
+            fanOut->stopped = true;
+            fanOut->returned = true;
+
+            result.peers = fanOut->peers;
+            result.complete = fanOut->answered == fanOut->peers.size();
+            bool deadlinePassed = std::chrono::steady_clock::now() >= deadline;
+            for (auto& peer : result.peers) {
+                switch (peer.status) {
+                    case PeerStatus::OK:
+                        result.succeeded++;
+                        break;
+                    case PeerStatus::FAILED:
+                        result.failed++;
+                        break;
+                    default:
+                        if (stoppedEarly && !deadlinePassed) {
+                            peer.status = PeerStatus::SKIPPED;
+                            peer.response = makeErrorResponse(message.correlationId, "Broadcast stopped early");
+                        } else {
+                            result.timedOut++;
+                            peer.latency = timeout;
+                            peer.response = makeErrorResponse(message.correlationId, "Broadcast deadline exceeded");
+                        }
+                        break;
+                }
+            }
+        }
+
+        // Wait out an onResponse call already in progress
+        std::lock_guard<std::mutex> callbackLock(fanOut->callbackMutex);
+        return result;
+    }
+
+    bool isConnected() const {
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        for (const auto& connection : connections_) {
+            std::lock_guard<std::mutex> channelsLock(connection->channelsMutex);
+            for (const auto& slot : connection->channels) {
+                if (slot->channel->GetState(true) == GRPC_CHANNEL_READY) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool isServerRunning() const {
+        return serverRunning_.load();
+    }
+
+    std::string getServerAddress() const {
+        return serverAddress_;
+    }
+
+    void setConnectionTimeout(int timeoutMs) {
+        if (timeoutMs > 0) {
+            connectionTimeoutMs_ = timeoutMs;
+        }
+    }
+
+    int getActiveConnectionCount() const {
+        return static_cast<int>(getChannelPoolStats().readyChannels);
+    }
+
+    void setChannelPoolOptions(const ChannelPoolOptions& options) {
+        auto normalized = std::make_shared<ChannelPoolOptions>(options);
+        normalized->maxStreamsPerChannel = std::max<size_t>(1, options.maxStreamsPerChannel);
+        normalized->maxChannelsPerEndpoint = std::max<size_t>(1, options.maxChannelsPerEndpoint);
+        std::atomic_store(&channelPoolOptions_, std::shared_ptr<const ChannelPoolOptions>(normalized));
+
+        // Restart the sweeper so a shorter idle timeout takes effect right away
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        if (poolSweeper_) {
+            poolSweeper_->cancel();
+            poolSweeper_ = new PoolSweeper(this, clientCq_.get());
+        }
+    }
+
+    ChannelPoolStats getChannelPoolStats() const {
+        ChannelPoolStats stats;
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        stats.endpoints = connections_.size();
+        for (const auto& connection : connections_) {
+            std::lock_guard<std::mutex> channelsLock(connection->channelsMutex);
+            stats.channels += connection->channels.size();
+            for (const auto& slot : connection->channels) {
+                if (slot->channel->GetState(false) == GRPC_CHANNEL_READY) {
+                    stats.readyChannels++;
+                }
+                stats.activeCalls += static_cast<size_t>(std::max(0, slot->activeCalls.load()));
+            }
+        }
+        stats.channelsOpened = channelsOpened_.load();
+        stats.channelsEvicted = channelsEvicted_.load();
+        stats.malformedStreamFrames = malformedStreamFrames_.load();
+        return stats;
+    }
+
+    // Returns a channel to the endpoint with one call slot reserved for the caller.
+    // Prefers the least-loaded channel and opens another only when all are at the stream cap.
+    std::shared_ptr<ChannelSlot> acquireChannel(Connection& connection) {
+        auto options = std::atomic_load(&channelPoolOptions_);
+        std::lock_guard<std::mutex> lock(connection.channelsMutex);
+
+        std::shared_ptr<ChannelSlot> best;
+        for (const auto& slot : connection.channels) {
+            if (!best || slot->activeCalls.load() < best->activeCalls.load()) {
+                best = slot;
+            }
+        }
+
+        bool saturated = !best || static_cast<size_t>(best->activeCalls.load()) >= options->maxStreamsPerChannel;
+        if (saturated && connection.channels.size() < options->maxChannelsPerEndpoint) {
+            grpc::ChannelArguments args;
+            args.SetMaxReceiveMessageSize(-1);
+            // Sibling channels must not share a subchannel, or they would share one connection
+            args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+
+            best = std::make_shared<ChannelSlot>();
+            best->channel = grpc::CreateCustomChannel(connection.address, connection.credentials, args);
+            best->stub = std::make_unique<grpc::GenericStub>(best->channel);
+            connection.channels.push_back(best);
+            channelsOpened_++;
+        }
+
+        best->activeCalls.fetch_add(1, std::memory_order_acq_rel);
+        best->touch();
+        return best;
+    }
+
+    void evictIdleChannels() {
+        auto options = std::atomic_load(&channelPoolOptions_);
+        int64_t cutoff = steadyMillis() - options->idleTimeout.count();
+
+        std::vector<std::shared_ptr<Connection>> connections;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            connections = connections_;
+        }
+
+        for (const auto& connection : connections) {
+            // An idle persistent stream pins its channel; close it so the channel can go
+            {
+                std::lock_guard<std::mutex> streamLock(connection->streamMutex);
+                if (connection->stream &&
+                    (connection->stream->isBroken() ||
+                     (connection->stream->isIdle() && connection->stream->lastUsedMs() < cutoff))) {
+                    connection->stream->cancel();
+                    connection->stream.reset();
+                }
+            }
+
+            std::lock_guard<std::mutex> channelsLock(connection->channelsMutex);
+            auto& channels = connection->channels;
+            size_t before = channels.size();
+            channels.erase(std::remove_if(channels.begin(), channels.end(),
+                                          [cutoff](const std::shared_ptr<ChannelSlot>& slot) {
+                                              return slot->activeCalls.load() == 0 &&
+                                                     slot->lastUsedMs.load() < cutoff;
+                                          }),
+                           channels.end());
+            channelsEvicted_ += before - channels.size();
+        }
+    }
+
+    void setCompressionOptions(const CompressionOptions& options) {
+        std::atomic_store(&compressionOptions_,
+                          std::shared_ptr<const CompressionOptions>(std::make_shared<CompressionOptions>(options)));
+    }
+
+    std::vector<CompressionStats> getCompressionStats() const {
+        std::vector<CompressionStats> stats;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            for (const auto& connection : connections_) {
+                const PeerCompression& peer = *connection->compression;
+                CompressionStats entry;
+                entry.address = connection->address;
+                if (peer.eligible && negotiatedAlgorithm(peer.accepted.load()) != GRPC_COMPRESS_NONE) {
+                    entry.negotiated = std::atomic_load(&compressionOptions_)->algorithm;
+                }
+                entry.compressedMessages = peer.compressedMessages.load();
+                entry.uncompressedMessages = peer.uncompressedMessages.load();
+                entry.compressedBytes = peer.compressedBytes.load();
+                stats.push_back(std::move(entry));
+            }
+        }
+
+        if (!serverAddress_.empty()) {
+            CompressionStats entry;
+            entry.address = serverAddress_;
+            entry.compressedMessages = responsesCompressed_.load();
+            entry.uncompressedMessages = responsesUncompressed_.load();
+            entry.compressedBytes = responseBytesCompressed_.load();
+            stats.push_back(std::move(entry));
+        }
+        return stats;
+    }
+
+    // Encodings this side accepts, as advertised to peers; NONE opts out of both directions
+    std::string acceptEncoding() const {
+        return configuredAlgorithm() == GRPC_COMPRESS_NONE ? "identity" : "deflate,gzip";
+    }
+
+    grpc_compression_algorithm configuredAlgorithm() const {
+        return toGrpcAlgorithm(std::atomic_load(&compressionOptions_)->algorithm);
+    }
+
+    // The configured algorithm if the peer accepts it, otherwise GRPC_COMPRESS_NONE
+    grpc_compression_algorithm negotiatedAlgorithm(int accepted) const {
+        grpc_compression_algorithm algorithm = configuredAlgorithm();
+        if (accepted < 0 || (accepted & (1 << algorithm)) == 0) {
+            return GRPC_COMPRESS_NONE;
+        }
+        return algorithm;
+    }
+
+    // Algorithm for an outgoing buffer of `size` bytes to the peer, or GRPC_COMPRESS_NONE
+    grpc_compression_algorithm compressionFor(PeerCompression& peer, size_t size) {
+        grpc_compression_algorithm algorithm = GRPC_COMPRESS_NONE;
+        if (peer.eligible && size >= std::atomic_load(&compressionOptions_)->minMessageBytes) {
+            algorithm = negotiatedAlgorithm(peer.accepted.load(std::memory_order_relaxed));
+        }
+
+        if (algorithm != GRPC_COMPRESS_NONE) {
+            peer.compressedMessages++;
+            peer.compressedBytes += size;
+        } else {
+            peer.uncompressedMessages++;
+        }
+        return algorithm;
+    }
+
+    // Advertises our encodings and compresses the request if the peer agreed and it is large enough
+    void prepareContext(grpc::ClientContext& context, PeerCompression& peer, size_t size) {
+        context.AddMetadata(kAcceptEncodingKey, acceptEncoding());
+        grpc_compression_algorithm algorithm = compressionFor(peer, size);
+        if (algorithm != GRPC_COMPRESS_NONE) {
+            context.set_compression_algorithm(algorithm);
+        }
+    }
+
+    // Whether a response of `size` bytes goes out with the algorithm agreed for its call
+    bool compressResponse(grpc_compression_algorithm algorithm, size_t size) {
+        if (algorithm == GRPC_COMPRESS_NONE || size < std::atomic_load(&compressionOptions_)->minMessageBytes) {
+            responsesUncompressed_++;
+            return false;
+        }
+        responsesCompressed_++;
+        responseBytesCompressed_ += size;
+        return true;
+    }
+
+    void setHedgingOptions(const HedgingOptions& options) {
+        auto normalized = std::make_shared<HedgingOptions>(options);
+        normalized->maxHedges = std::max(1, options.maxHedges);
+        normalized->maxDelay = std::max(options.minDelay, options.maxDelay);
+        std::atomic_store(&hedgingOptions_, std::shared_ptr<const HedgingOptions>(normalized));
+    }
+
+    void setDeduplicationOptions(const DeduplicationOptions& options) {
+        std::shared_ptr<DeduplicationCache> cache;
+        if (options.enabled) {
+            cache = std::make_shared<DeduplicationCache>(options.window, options.maxEntries);
+        }
+        std::atomic_store(&deduplicationCache_, cache);
+    }
+
+    HedgingStats getHedgingStats() const {
+        HedgingStats stats;
+        stats.hedgeableRequests = hedgeableRequests_.load();
+        stats.hedgesSent = hedgesSent_.load();
+        stats.hedgeWins = hedgeWins_.load();
+        if (auto cache = std::atomic_load(&deduplicationCache_)) {
+            stats.duplicatesSuppressed = cache->duplicates();
+        }
+        return stats;
+    }
+
+    std::string newCorrelationId(const char* kind) {
+        return std::string(kind) + "-" + correlationPrefix_ + "-" + std::to_string(nextCorrelationId_++);
+    }
+
+    // Hedge state for a send whose receiver has alternates of its type, or nullptr
+    std::shared_ptr<HedgeState> prepareHedge(const AgentMessage& message) {
+        auto options = std::atomic_load(&hedgingOptions_);
+        if (!options->enabled || !message.idempotent) {
+            return nullptr;
+        }
+
+        auto state = std::make_shared<HedgeState>();
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            auto typeIt = peerTypes_.find(message.receiverId);
+            if (typeIt == peerTypes_.end()) {
+                return nullptr;
+            }
+
+            // Rotate through the group so hedges spread over the alternates
+            const auto& group = peersByType_[typeIt->second];
+            size_t offset = group.empty() ? 0 : hedgeRotation_++ % group.size();
+            size_t limit = static_cast<size_t>(options->maxHedges);
+            for (size_t i = 0; i < group.size() && state->alternates.size() < limit; ++i) {
+                const std::string& candidate = group[(offset + i) % group.size()];
+                if (candidate != message.receiverId) {
+                    state->alternates.push_back(candidate);
+                }
+            }
+            if (state->alternates.empty()) {
+                return nullptr;
+            }
+            state->agentType = typeIt->second;
+        }
+
+        state->message = message;
+        if (state->message.correlationId.empty()) {
+            state->message.correlationId = newCorrelationId("h");
+        }
+
+        int64_t percentileUs = -1;
+        {
+            std::lock_guard<std::mutex> lock(latencyMutex_);
+            percentileUs = typeLatencies_[state->agentType].percentileUs(options->percentile);
+        }
+        auto delay = percentileUs < 0 ? std::chrono::microseconds(options->maxDelay) :
+                                        std::chrono::microseconds(percentileUs);
+        state->delay = std::clamp<std::chrono::steady_clock::duration>(delay, options->minDelay, options->maxDelay);
+        state->outstanding = 1;
+        hedgeableRequests_++;
+        return state;
+    }
+
+    // Sends one copy of the hedged message; the caller has counted it as outstanding
+    void launchAttempt(const std::shared_ptr<HedgeState>& state, const std::string& receiverId, bool hedge) {
+        AgentMessage attempt = state->message;
+        attempt.receiverId = receiverId;
+        if (hedge) {
+            hedgesSent_++;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto connection = connectionFor(receiverId);
+        if (!connection) {
+            onAttemptDone(state, hedge, start,
+                          makeErrorResponse(attempt.correlationId, "No client connection initialized"));
+            return;
+        }
+
+        auto handle = std::make_shared<CallHandle>();
+        bool abandoned;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            abandoned = state->finished;
+            if (!abandoned) {
+                state->calls.push_back(handle);
+            }
+        }
+        if (abandoned) {
+            // Abandoned between being counted and launched; the call cancels as it starts
+            handle->cancel();
+        }
+        sendOn(*connection, std::move(attempt), [this, state, hedge, start](const AgentResponse& response) {
+            onAttemptDone(state, hedge, start, response);
+        }, handle);
+    }
+
+    // Ends a hedged request early and cancels the attempts still out
+    void abandonHedge(const std::shared_ptr<HedgeState>& state, const AgentResponse& response) {
+        std::vector<std::shared_ptr<CallHandle>> calls;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->finished) {
+                return;
+            }
+            state->finished = true;
+            if (state->timer) {
+                state->timer->cancel();
+            }
+            calls.swap(state->calls);
+        }
+        for (auto& call : calls) {
+            call->cancel();
+        }
+        state->result.set_value(response);
+    }
+
+    void armHedge(const std::shared_ptr<HedgeState>& state) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->finished || state->timer || state->nextAlternate >= state->alternates.size()) {
+            return;
+        }
+        state->timer = new HedgeTimer(this, state);
+        state->timer->arm(clientCq_.get(), state->delay);
+    }
+
+    void onHedgeTimer(const std::shared_ptr<HedgeState>& state, HedgeTimer* timer, bool ok) {
+        std::string receiverId;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->timer == timer) {
+                state->timer = nullptr;
+            }
+            if (!ok || state->finished || state->nextAlternate >= state->alternates.size()) {
+                return;
+            }
+            receiverId = state->alternates[state->nextAlternate++];
+            state->outstanding++;
+        }
+
+        launchAttempt(state, receiverId, true);
+        armHedge(state);
+    }
+
+    void onAttemptDone(const std::shared_ptr<HedgeState>& state, bool hedge,
+                       std::chrono::steady_clock::time_point start, const AgentResponse& response) {
+        std::string failover;
+        const AgentResponse* outcome = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->outstanding--;
+            if (state->finished) {
+                return;
+            }
+
+            if (response.success) {
+                outcome = &response;
+                if (hedge) {
+                    hedgeWins_++;
+                }
+            } else {
+                state->lastFailure = response;
+                if (state->nextAlternate < state->alternates.size()) {
+                    // Fail over at once rather than waiting out the hedge delay
+                    failover = state->alternates[state->nextAlternate++];
+                    state->outstanding++;
+                } else if (state->outstanding == 0) {
+                    outcome = &state->lastFailure;
+                }
+            }
+
+            if (outcome) {
+                state->finished = true;
+                if (state->timer) {
+                    state->timer->cancel();
+                }
+            }
+        }
+
+        if (outcome) {
+            // Only winning attempts feed the delay; losers stuck behind a slow
+            // peer would otherwise push the percentile up and disable hedging
+            if (outcome->success) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                std::lock_guard<std::mutex> lock(latencyMutex_);
+                typeLatencies_[state->agentType].record(elapsed);
+            }
+            state->result.set_value(*outcome);
+        } else if (!failover.empty()) {
+            launchAttempt(state, failover, true);
+        }
+    }
+
+    // Issues a new RequestCall on a server queue unless shutdown has begun
+    void requestCall(grpc::ServerCompletionQueue* cq) {
+        std::shared_lock<std::shared_mutex> lock(shutdownMutex_);
+        if (!serverShuttingDown_) {
+            new ServerCall(this, cq);
+        }
+    }
+
+    // Runs the message's handler unless deduplication recognizes it as a repeat,
+    // in which case `done` gets the response of the first arrival
+    void dispatch(AgentMessage&& message, std::function<void(AgentResponse&&)> done) {
+        auto cache = std::atomic_load(&deduplicationCache_);
+        if (!cache || message.correlationId.empty()) {
+            dispatchHandler(std::move(message), std::move(done));
+            return;
+        }
+
+        std::string key = message.senderId + '\n' + message.correlationId;
+        if (!cache->begin(key, done)) {
+            return;
+        }
+        // Only a response from the handler is replayed; a retry of a request that
+        // could not be dispatched gets another chance to run
+        dispatchHandler(std::move(message),
+                        [cache, key, done](AgentResponse&& response) {
+                            cache->complete(key, response);
+                            done(std::move(response));
+                        },
+                        [cache, key, done](AgentResponse&& response) {
+                            cache->abandon(key, response);
+                            done(std::move(response));
+                        });
+    }
+
+    // Runs the message's handler inline or on the executor bound to its type and
+    // passes the response to `done`, on whichever thread ran the handler. If the
+    // handler cannot run, the error goes to `rejected`, or to `done` without one.
+    void dispatchHandler(AgentMessage&& message, std::function<void(AgentResponse&&)> done,
+                         std::function<void(AgentResponse&&)> rejected = nullptr) {
+        if (!rejected) {
+            rejected = done;
+        }
+        MessageTypeId id = message.messageTypeId != kUnknownMessageType ?
+            message.messageTypeId : MessageTypeRegistry::find(message.messageType);
+
+        auto table = std::atomic_load(&handlerTable_);
+        const HandlerSlot* slot = id < table->size() ? &(*table)[id] : nullptr;
+        if (!slot || !slot->handler) {
+            std::string type = message.messageType.empty() ? MessageTypeRegistry::name(id) : message.messageType;
+            rejected(makeErrorResponse(message.correlationId, "No handler registered for message type: " + type));
+            return;
+        }
+
+        if (!slot->executor) {
+            done(invokeHandler(slot->handler, message));
+            return;
+        }
+
+        // The task owns everything it touches, so it may outlive this server
+        std::string correlationId = message.correlationId;
+        auto task = std::make_shared<std::pair<AgentMessage, std::function<void(AgentResponse&&)>>>(
+            std::move(message), std::move(done));
+        bool posted = slot->executor->post([handler = slot->handler, task]() {
+            task->second(invokeHandler(handler, task->first));
+        });
+        if (!posted) {
+            rejected(makeErrorResponse(correlationId,
+                                       "Handler executor " + slot->executor->name() + " is saturated"));
+        }
+    }
+
+    static AgentResponse invokeHandler(const MessageHandler& handler, const AgentMessage& message) {
+        AgentResponse response{};
+        try {
+            response = handler(message);
+        } catch (const std::exception& e) {
+            return makeErrorResponse(message.correlationId,
+                                     std::string("Handler threw exception: ") + e.what());
+        }
+
+        if (response.correlationId.empty()) {
+            response.correlationId = message.correlationId;
+        }
+        if (response.timestamp == 0) {
+            response.timestamp = currentTimeMillis();
+        }
+        return response;
+    }
+
+private:
+    static constexpr int kPendingCallsPerQueue = 16;
+
+    // Server state
+    grpc::AsyncGenericService service_;
+    std::unique_ptr<grpc::Server> server_;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> serverCqs_;
+    std::vector<std::thread> serverThreads_;
+    std::shared_ptr<grpc::ServerCredentials> serverCredentials_;
+    std::string serverAddress_;
+    int serverThreadCount_;
+    std::atomic<bool> serverRunning_;
+    bool serverShuttingDown_;
+    std::shared_mutex shutdownMutex_;
+    int liveServerCalls_ = 0;
+    std::mutex liveCallsMutex_;
+    std::condition_variable liveCallsCv_;
+
+    // Message handlers indexed by interned type; replaced wholesale on registration
+    struct HandlerSlot {
+        MessageHandler handler;
+        std::shared_ptr<HandlerExecutor> executor;
+    };
+    std::shared_ptr<const std::vector<HandlerSlot>> handlerTable_ =
+        std::make_shared<const std::vector<HandlerSlot>>();
+    std::mutex handlersMutex_;
+
+    // Client state
+    std::vector<std::shared_ptr<Connection>> connections_;
+    std::unordered_map<std::string, std::shared_ptr<Connection>> connectionsByAddress_;
+    std::unordered_map<std::string, std::string> peerAddresses_;  // Agent ID -> server address
+    std::shared_ptr<Connection> defaultConnection_;
+    std::shared_ptr<grpc::ChannelCredentials> clientCredentials_;
+    std::unique_ptr<grpc::CompletionQueue> clientCq_;
+    std::thread clientThread_;
+    mutable std::mutex clientMutex_;
+    std::atomic<int> connectionTimeoutMs_;
+    std::atomic<bool> streamingEnabled_{false};
+    std::atomic<bool> zeroCopyPayloads_{false};
+    std::atomic<bool> inProcessDelivery_{true};
+    std::atomic<bool> sharedMemoryTransfer_{true};
+
+    // Backpressure settings and the number of admitted sends still outstanding
+    std::shared_ptr<const SendQueueOptions> sendQueueOptions_ = std::make_shared<SendQueueOptions>();
+    std::atomic<bool> clientStopping_{false};
+    std::atomic<int64_t> liveAdmitted_{0};
+    std::mutex liveAdmittedMutex_;
+    std::condition_variable liveAdmittedCv_;
+
+    // Channel pool settings and counters; the sweeper lives on the client queue
+    std::shared_ptr<const ChannelPoolOptions> channelPoolOptions_ = std::make_shared<ChannelPoolOptions>();
+    std::atomic<uint64_t> channelsOpened_{0};
+    std::atomic<uint64_t> channelsEvicted_{0};
+    std::atomic<uint64_t> malformedStreamFrames_{0};
+    PoolSweeper* poolSweeper_ = nullptr;
+
+    // Compression settings and totals for responses sent by the server
+    std::shared_ptr<const CompressionOptions> compressionOptions_ = std::make_shared<CompressionOptions>();
+    std::atomic<uint64_t> responsesCompressed_{0};
+    std::atomic<uint64_t> responsesUncompressed_{0};
+    std::atomic<uint64_t> responseBytesCompressed_{0};
+
+    // In-process endpoint published while the server runs
+    static constexpr size_t kLocalQueueCapacity = 4096;
+    std::shared_ptr<LocalEndpoint> localEndpoint_;
+    std::atomic<uint64_t> nextCorrelationId_{1};
+    std::string correlationPrefix_;   // Random per instance, so generated IDs do not collide across clients
+
+    // Hedging: peers grouped by agent type (under clientMutex_) and recent latencies per type
+    std::unordered_map<std::string, std::string> peerTypes_;
+    std::unordered_map<std::string, std::vector<std::string>> peersByType_;
+    std::shared_ptr<const HedgingOptions> hedgingOptions_ = std::make_shared<HedgingOptions>();
+    std::mutex latencyMutex_;
+    std::unordered_map<std::string, LatencyTracker> typeLatencies_;
+    std::atomic<uint64_t> hedgeRotation_{0};
+    std::atomic<uint64_t> hedgeableRequests_{0};
+    std::atomic<uint64_t> hedgesSent_{0};
+    std::atomic<uint64_t> hedgeWins_{0};
+
+    // Receiver-side duplicate suppression; null while disabled
+    std::shared_ptr<DeduplicationCache> deduplicationCache_;
+
+    // Batching state; deadlines of partial batches are kept in a min-heap for the flusher
+    std::atomic<bool> batchingEnabled_{false};
+    BatchingOptions batchingOptions_;
+    std::priority_queue<FlushDeadline, std::vector<FlushDeadline>, std::greater<FlushDeadline>> flushDeadlines_;
+    std::thread flusherThread_;
+    std::mutex flushMutex_;
+    std::condition_variable flushCv_;
+    bool flusherStop_ = false;
+
+    // Open client streams, so shutdown can wait for them to drain
+    int liveStreams_ = 0;
+    std::mutex liveStreamsMutex_;
+    std::condition_variable liveStreamsCv_;
+
+    static void pollQueue(grpc::CompletionQueue* cq) {
+        void* tag = nullptr;
+        bool ok = false;
+        tPollingThread = true;
+        while (cq->Next(&tag, &ok)) {
+            static_cast<CallState*>(tag)->proceed(ok);
+        }
+    }
+
+    // Caller holds clientMutex_
+    std::shared_ptr<Connection> createConnection(const std::string& address) {
+        auto connection = std::make_shared<Connection>();
+        connection->address = address;
+        connection->sameHost = isUnixAddress(address);
+        connection->compression->eligible = !connection->sameHost;
+
+        // TLS buys nothing on a unix socket; the kernel vouches for the peer
+        connection->credentials = connection->sameHost ?
+            grpc::experimental::LocalCredentials(UDS) : clientCredentials_;
+
+        auto existing = connectionsByAddress_.find(address);
+        if (existing != connectionsByAddress_.end()) {
+            std::replace(connections_.begin(), connections_.end(), existing->second, connection);
+        } else {
+            connections_.push_back(connection);
+        }
+        connectionsByAddress_[address] = connection;
+        return connection;
+    }
+
+    // Registered peer connection for the receiver, or the default connection
+    std::shared_ptr<Connection> connectionFor(const std::string& receiverId) {
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        auto peerIt = peerAddresses_.find(receiverId);
+        if (peerIt != peerAddresses_.end()) {
+            auto connectionIt = connectionsByAddress_.find(peerIt->second);
+            if (connectionIt != connectionsByAddress_.end()) {
+                return connectionIt->second;
+            }
+        }
+        return defaultConnection_;
+    }
+
+    std::shared_ptr<LocalEndpoint> localEndpointFor(Connection& connection) {
+        if (!inProcessDelivery_.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        uint64_t generation = LocalTransportRegistry::generation();
+        std::lock_guard<std::mutex> lock(connection.localMutex);
+        if (connection.localGeneration != generation) {
+            connection.localEndpoint = LocalTransportRegistry::find(connection.address);
+            connection.localGeneration = generation;
+        }
+        return connection.localEndpoint;
+    }
+
+    // On failure (endpoint stopping or its queue full) message and callback are left intact
+    bool postLocal(LocalEndpoint& endpoint,
+                   AgentMessage& message,
+                   std::function<void(const AgentResponse&)>& callback) {
+        bool copyPayload = copyPayloads();
+        LocalEndpoint::ResponseCallback deliver =
+            [callback, copyPayload](AgentResponse&& response) {
+                adaptPayload(response.responseData, response.responseView, copyPayload);
+                if (callback) {
+                    callback(response);
+                }
+            };
+        return endpoint.post(message, deliver);
+    }
+
+    // A handle, if given, can cancel the call when it goes out as a unary call.
+    // Takes const or rvalue messages; rvalues destined for this process are moved, not copied
+    template <typename Message>
+    void sendOn(Connection& connection,
+                Message&& message,
+                std::function<void(const AgentResponse&)> callback,
+                std::shared_ptr<CallHandle> handle = nullptr) {
+        if (auto endpoint = localEndpointFor(connection)) {
+            AgentMessage local(std::forward<Message>(message));
+            if (!postLocal(*endpoint, local, callback)) {
+                sendRemote(connection, local, std::move(callback), std::move(handle));
+            }
+            return;
+        }
+        sendRemote(connection, message, std::move(callback), std::move(handle));
+    }
+
+    // Calls with a handle always go out as unary calls: a shared stream cannot
+    // cancel one message, so the peer would never learn of the cancellation
+    void sendRemote(Connection& connection,
+                    const AgentMessage& message,
+                    std::function<void(const AgentResponse&)> callback,
+                    std::shared_ptr<CallHandle> handle) {
+        if (handle || !streamingEnabled_.load()) {
+            startCall(connection, message, std::move(callback), std::move(handle));
+            return;
+        }
+
+        // Streams match responses by correlationId, so every message needs one
+        const AgentMessage* toSend = &message;
+        AgentMessage withId;
+        if (message.correlationId.empty()) {
+            withId = message;
+            withId.correlationId = newCorrelationId("s");
+            toSend = &withId;
+        }
+
+        std::lock_guard<std::mutex> lock(connection.streamMutex);
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (!connection.stream || connection.stream->isBroken()) {
+                connection.stream = ClientStream::open(this, acquireChannel(connection), connection.compression,
+                                                       clientCq_.get(), ringFor(connection));
+            }
+            if (connection.stream->send(*toSend, callback)) {
+                return;
+            }
+        }
+
+        // Stream failed twice in a row; fall back to a unary call
+        startCall(connection, *toSend, std::move(callback));
+    }
+
+    BatchingOptions currentBatchingOptions() {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        return batchingOptions_;
+    }
+
+    void enqueueBatched(const std::shared_ptr<Connection>& connection,
+                        const AgentMessage& message,
+                        std::function<void(const AgentResponse&)> callback) {
+        BatchingOptions options = currentBatchingOptions();
+        BatchQueue& queue = connection->batchQueue;
+        std::vector<QueuedSend> batch;
+        bool scheduleFlush = false;
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.pending.push_back(QueuedSend{message, std::move(callback)});
+            queue.pendingBytes += MessageCodec::encodedSize(message);
+
+            bool full = queue.pending.size() >= options.maxBatchMessages ||
+                        queue.pendingBytes >= options.maxBatchBytes;
+            bool idle = queue.inFlightBatches < options.maxInFlightBatches;
+            if (full || idle) {
+                batch = takeBatch(queue);
+            } else if (queue.pending.size() == 1) {
+                scheduleFlush = true;
+                generation = queue.generation;
+            }
+        }
+
+        if (!batch.empty()) {
+            sendBatch(connection, std::move(batch));
+        } else if (scheduleFlush) {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            flushDeadlines_.push(FlushDeadline{std::chrono::steady_clock::now() + options.flushDelay,
+                                               connection, generation});
+            flushCv_.notify_one();
+        }
+    }
+
+    // Caller holds queue.mutex
+    std::vector<QueuedSend> takeBatch(BatchQueue& queue) {
+        std::vector<QueuedSend> batch;
+        batch.swap(queue.pending);
+        queue.pendingBytes = 0;
+        queue.generation++;
+        queue.inFlightBatches++;
+        return batch;
+    }
+
+    void sendBatch(const std::shared_ptr<Connection>& connection, std::vector<QueuedSend> batch) {
+        std::weak_ptr<Connection> weakConnection = connection;
+        auto onComplete = [this, weakConnection]() {
+            if (auto owner = weakConnection.lock()) {
+                onBatchComplete(owner);
+            }
+        };
+
+        // A batch of one goes out as a plain message, not worth the batch framing
+        if (batch.size() == 1) {
+            auto callback = std::move(batch.front().callback);
+            sendOn(*connection, std::move(batch.front().message),
+                   [callback, onComplete](const AgentResponse& response) {
+                       if (callback) {
+                           callback(response);
+                       }
+                       onComplete();
+                   });
+            return;
+        }
+
+        std::vector<AgentMessage> messages;
+        std::vector<std::string> correlationIds;
+        std::vector<std::function<void(const AgentResponse&)>> callbacks;
+        messages.reserve(batch.size());
+        correlationIds.reserve(batch.size());
+        callbacks.reserve(batch.size());
+        for (auto& queued : batch) {
+            correlationIds.push_back(queued.message.correlationId);
+            callbacks.push_back(std::move(queued.callback));
+            messages.push_back(std::move(queued.message));
+        }
+
+        auto* call = new ClientBatchCall(std::move(correlationIds), std::move(callbacks), onComplete);
+        call->copyPayload = copyPayloads();
+        call->context.set_deadline(std::chrono::system_clock::now() +
+                                   std::chrono::milliseconds(connectionTimeoutMs_.load()));
+        call->channel = acquireChannel(*connection);
+        call->compression = connection->compression;
+        grpc::ByteBuffer request = MessageCodec::encodeMessageBatch(messages, ringFor(*connection));
+        prepareContext(call->context, *call->compression, request.Length());
+        call->reader = call->channel->stub->PrepareUnaryCall(
+            &call->context, MessageCodec::kBatchMethod, request, clientCq_.get());
+        call->reader->StartCall();
+        call->reader->Finish(&call->response_, &call->status_, call);
+    }
+
+    // A completed batch frees an in-flight slot, so whatever queued behind it goes now
+    void onBatchComplete(const std::shared_ptr<Connection>& connection) {
+        std::vector<QueuedSend> batch;
+        {
+            std::lock_guard<std::mutex> lock(connection->batchQueue.mutex);
+            connection->batchQueue.inFlightBatches--;
+            if (!connection->batchQueue.pending.empty()) {
+                batch = takeBatch(connection->batchQueue);
+            }
+        }
+
+        if (!batch.empty()) {
+            sendBatch(connection, std::move(batch));
+        }
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        while (!flusherStop_) {
+            if (flushDeadlines_.empty()) {
+                flushCv_.wait(lock);
+                continue;
+            }
+
+            auto next = flushDeadlines_.top();
+            if (std::chrono::steady_clock::now() < next.when) {
+                flushCv_.wait_until(lock, next.when);
+                continue;
+            }
+            flushDeadlines_.pop();
+
+            lock.unlock();
+            if (auto connection = next.connection.lock()) {
+                std::vector<QueuedSend> batch;
+                {
+                    std::lock_guard<std::mutex> queueLock(connection->batchQueue.mutex);
+                    if (connection->batchQueue.generation == next.generation &&
+                        !connection->batchQueue.pending.empty()) {
+                        batch = takeBatch(connection->batchQueue);
+                    }
+                }
+                if (!batch.empty()) {
+                    sendBatch(connection, std::move(batch));
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    void startCall(Connection& connection,
+                   const AgentMessage& message,
+                   std::function<void(const AgentResponse&)> callback,
+                   std::shared_ptr<CallHandle> handle = nullptr) {
+        auto* call = new ClientCall(message.correlationId, std::move(callback));
+        call->copyPayload = copyPayloads();
+        auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(connectionTimeoutMs_.load());
+        if (handle) {
+            deadline = std::min(deadline, handle->deadline);
+            handle->attach(&call->context);
+            call->handle = std::move(handle);
+        }
+        call->context.set_deadline(deadline);
+
+        call->channel = acquireChannel(connection);
+        call->compression = connection.compression;
+        grpc::ByteBuffer request = MessageCodec::encodeMessage(message, ringFor(connection));
+        prepareContext(call->context, *call->compression, request.Length());
+        call->reader = call->channel->stub->PrepareUnaryCall(
+            &call->context, MessageCodec::kUnaryMethod, request, clientCq_.get());
+        call->reader->StartCall();
+        call->reader->Finish(&call->response_, &call->status_, call);
+    }
+
+    void stopClient() {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            flusherStop_ = true;
+            flushCv_.notify_all();
+        }
+        if (flusherThread_.joinable()) {
+            flusherThread_.join();
+        }
+
+        std::unique_ptr<grpc::CompletionQueue> cq;
+        std::vector<QueuedSend> unsent;
+        clientStopping_ = true;
+        {
+            std::lock_guard<std::mutex> lock(clientMutex_);
+            if (poolSweeper_) {
+                poolSweeper_->cancel();
+                poolSweeper_ = nullptr;
+            }
+            for (auto& connection : connections_) {
+                {
+                    std::lock_guard<std::mutex> windowLock(connection->window.mutex);
+                    for (auto& queued : connection->window.queued) {
+                        unsent.push_back(std::move(queued));
+                    }
+                    connection->window.queued.clear();
+                    connection->window.cv.notify_all();
+                }
+                {
+                    std::lock_guard<std::mutex> queueLock(connection->batchQueue.mutex);
+                    for (auto& queued : connection->batchQueue.pending) {
+                        unsent.push_back(std::move(queued));
+                    }
+                    connection->batchQueue.pending.clear();
+                }
+
+                std::lock_guard<std::mutex> streamLock(connection->streamMutex);
+                if (connection->stream) {
+                    connection->stream->cancel();
+                    connection->stream.reset();
+                }
+            }
+            connections_.clear();
+            connectionsByAddress_.clear();
+            peerAddresses_.clear();
+            defaultConnection_.reset();
+            cq = std::move(clientCq_);
+        }
+
+        for (auto& queued : unsent) {
+            if (queued.callback) {
+                queued.callback(makeErrorResponse(queued.message.correlationId, "Client shut down"));
+            }
+        }
+
+        // Cancelled streams still issue their final operations on the queue, and
+        // every stream object refers back to this instance
+        {
+            std::unique_lock<std::mutex> lock(liveStreamsMutex_);
+            liveStreamsCv_.wait(lock, [this]() { return liveStreams_ == 0; });
+        }
+
+        if (cq) {
+            cq->Shutdown();
+            if (clientThread_.joinable()) {
+                clientThread_.join();
+            }
+        }
+
+        // Admitted sends delivered in-process complete on other servers' workers,
+        // and their completions refer back to this instance; like stopServer(),
+        // wait for handlers still running however long they take
+        std::unique_lock<std::mutex> lock(liveAdmittedMutex_);
+        liveAdmittedCv_.wait(lock, [this]() { return liveAdmitted_ == 0; });
+    }
+};
+
+// GrpcCommunicationProtocol implementation
+
+GrpcCommunicationProtocol::GrpcCommunicationProtocol()
+    : pImpl_(std::make_unique<Impl>()) {}
+
+GrpcCommunicationProtocol::~GrpcCommunicationProtocol() = default;
+
+bool GrpcCommunicationProtocol::initializeServer(const std::string& serverAddress,
+                                                 const std::string& tlsCertPath,
+                                                 const std::string& tlsKeyPath,
+                                                 const std::string& caCertPath) {
+    return pImpl_->initializeServer(serverAddress, tlsCertPath, tlsKeyPath, caCertPath);
+}
+
+bool GrpcCommunicationProtocol::initializeClient(const std::string& serverAddress,
+                                                 const std::string& tlsCertPath,
+                                                 const std::string& tlsKeyPath,
+                                                 const std::string& caCertPath) {
+    return pImpl_->initializeClient(serverAddress, tlsCertPath, tlsKeyPath, caCertPath);
+}
+
+void GrpcCommunicationProtocol::setZeroCopyPayloads(bool enabled) {
+    pImpl_->setZeroCopyPayloads(enabled);
+}
+
+void GrpcCommunicationProtocol::setBatchingOptions(const BatchingOptions& options) {
+    pImpl_->setBatchingOptions(options);
+}
+
+bool GrpcCommunicationProtocol::registerPeer(const std::string& agentId,
+                                             const std::string& serverAddress,
+                                             const std::string& agentType) {
+    return pImpl_->registerPeer(agentId, serverAddress, agentType);
+}
+
+void GrpcCommunicationProtocol::setStreamingEnabled(bool enabled) {
+    pImpl_->setStreamingEnabled(enabled);
+}
+
+void GrpcCommunicationProtocol::setServerThreadCount(int threadCount) {
+    pImpl_->setServerThreadCount(threadCount);
+}
+
+bool GrpcCommunicationProtocol::startServer() {
+    return pImpl_->startServer();
+}
+
+void GrpcCommunicationProtocol::stopServer() {
+    pImpl_->stopServer();
+}
+
+GrpcCommunicationProtocol::AgentResponse GrpcCommunicationProtocol::sendMessage(
+    const AgentMessage& message) {
+    return pImpl_->sendMessage(message);
+}
+
+GrpcCommunicationProtocol::AgentResponse GrpcCommunicationProtocol::sendMessage(
+    const AgentMessage& message, const CancellationToken& cancellation) {
+    return pImpl_->sendMessage(message, cancellation);
+}
+
+bool GrpcCommunicationProtocol::sendMessageAsync(AgentMessage&& message,
+                                                 std::function<void(const AgentResponse&)> callback) {
+    return pImpl_->sendMessageAsync(std::move(message), std::move(callback));
+}
+
+void GrpcCommunicationProtocol::setSendQueueOptions(const SendQueueOptions& options) {
+    pImpl_->setSendQueueOptions(options);
+}
+
+std::vector<GrpcCommunicationProtocol::SendQueueStats> GrpcCommunicationProtocol::getSendQueueStats() const {
+    return pImpl_->getSendQueueStats();
+}
+
+void GrpcCommunicationProtocol::setSharedMemoryTransfer(bool enabled) {
+    pImpl_->setSharedMemoryTransfer(enabled);
+}
+
+void GrpcCommunicationProtocol::setInProcessDelivery(bool enabled) {
+    pImpl_->setInProcessDelivery(enabled);
+}
+
+bool GrpcCommunicationProtocol::sendMessageAsync(const AgentMessage& message,
+                                                 std::function<void(const AgentResponse&)> callback) {
+    return pImpl_->sendMessageAsync(message, std::move(callback));
+}
+
+bool GrpcCommunicationProtocol::registerMessageHandler(const std::string& messageType,
+                                                       MessageHandler handler,
+                                                       std::shared_ptr<HandlerExecutor> executor) {
+    return pImpl_->registerMessageHandler(messageType, std::move(handler), std::move(executor));
+}
+
+GrpcCommunicationProtocol::MessageTypeId GrpcCommunicationProtocol::internMessageType(
+    const std::string& messageType) {
+    return MessageTypeRegistry::intern(messageType);
+}
+
+std::vector<GrpcCommunicationProtocol::AgentResponse> GrpcCommunicationProtocol::broadcastMessage(
+    const AgentMessage& message) {
+    return pImpl_->broadcastMessage(message);
+}
+
+GrpcCommunicationProtocol::BroadcastResult GrpcCommunicationProtocol::broadcastMessage(
+    const AgentMessage& message, const BroadcastOptions& options) {
+    return pImpl_->broadcastMessage(message, options);
+}
+
+bool GrpcCommunicationProtocol::isConnected() const {
+    return pImpl_->isConnected();
+}
+
+bool GrpcCommunicationProtocol::isServerRunning() const {
+    return pImpl_->isServerRunning();
+}
+
+std::string GrpcCommunicationProtocol::getServerAddress() const {
+    return pImpl_->getServerAddress();
+}
+
+void GrpcCommunicationProtocol::setConnectionTimeout(int timeoutMs) {
+    pImpl_->setConnectionTimeout(timeoutMs);
+}
+
+int GrpcCommunicationProtocol::getActiveConnectionCount() const {
+    return pImpl_->getActiveConnectionCount();
+}
+
+void GrpcCommunicationProtocol::setChannelPoolOptions(const ChannelPoolOptions& options) {
+    pImpl_->setChannelPoolOptions(options);
+}
+
+GrpcCommunicationProtocol::ChannelPoolStats GrpcCommunicationProtocol::getChannelPoolStats() const {
+    return pImpl_->getChannelPoolStats();
+}
+
+void GrpcCommunicationProtocol::setCompressionOptions(const CompressionOptions& options) {
+    pImpl_->setCompressionOptions(options);
+}
+
+std::vector<GrpcCommunicationProtocol::CompressionStats> GrpcCommunicationProtocol::getCompressionStats() const {
+    return pImpl_->getCompressionStats();
+}
+
+void GrpcCommunicationProtocol::setHedgingOptions(const HedgingOptions& options) {
+    pImpl_->setHedgingOptions(options);
+}
+
+void GrpcCommunicationProtocol::setDeduplicationOptions(const DeduplicationOptions& options) {
+    pImpl_->setDeduplicationOptions(options);
+}
+
+GrpcCommunicationProtocol::HedgingStats GrpcCommunicationProtocol::getHedgingStats() const {
+    return pImpl_->getHedgingStats();
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -2,23 +2,38 @@
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/security/credentials.h>
+#include "orchestrator/cancellation_token.h"
+#include "orchestrator/communication/payload_view.h"
 #include <memory>
 #include <string>
 #include <functional>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
+#include <cstdint>
+#include <chrono>
 
 namespace dist_prompt {
 namespace orchestrator {
 namespace communication {
 
+class HandlerExecutor;
+
 /**
  * @brief gRPC communication protocol with TLS for agent coordination
  * 
  * Implements secure communication between agents using gRPC v1.46.3 with TLS encryption.
+ * The server is fully asynchronous: a fixed pool of polling threads drives one
+ * completion queue each, so concurrent RPCs do not each need a thread.
  */
 class GrpcCommunicationProtocol {
 public:
+    /**
+     * @brief Interned message type, see internMessageType()
+     */
+    using MessageTypeId = uint32_t;
+    static constexpr MessageTypeId kUnknownMessageType = 0;
+    
     /**
      * @brief Message structure for agent communication
      */
@@ -29,6 +44,9 @@ public:
         std::string payload;
         int64_t timestamp;
         std::string correlationId;
+        PayloadView payloadView;    // Sent instead of payload when non-empty
+        MessageTypeId messageTypeId = kUnknownMessageType;   // Takes precedence over messageType in this process
+        bool idempotent = false;    // Safe to run on more than one agent; only such messages are hedged
     };
     
     /**
@@ -40,6 +58,214 @@ public:
         std::string errorMessage;
         int64_t timestamp;
         std::string correlationId;
+        PayloadView responseView;   // Sent instead of responseData when non-empty
+    };
+    
+    /**
+     * @brief Coalescing settings for sendMessageAsync()
+     * 
+     * Messages to the same destination are queued and sent as one batch RPC. A
+     * batch is sent as soon as fewer than maxInFlightBatches are outstanding
+     * (Nagle-style), when it reaches maxBatchMessages or maxBatchBytes, or when
+     * its oldest message has waited flushDelay.
+     */
+    struct BatchingOptions {
+        bool enabled = false;
+        size_t maxBatchMessages = 64;
+        size_t maxBatchBytes = 64 * 1024;
+        std::chrono::microseconds flushDelay{200};
+        int maxInFlightBatches = 1;   // Per destination
+    };
+    
+    /**
+     * @brief Outcome of a broadcast for one peer
+     */
+    enum class PeerStatus {
+        OK,          // Peer answered and its handler succeeded
+        FAILED,      // Peer answered with an error, or the RPC failed
+        TIMED_OUT,   // No answer before the broadcast deadline
+        SKIPPED      // Still outstanding when the broadcast stopped early
+    };
+    
+    /**
+     * @brief Result of a broadcast for one peer
+     */
+    struct PeerResult {
+        std::string address;
+        std::vector<std::string> agentIds;   // Peers registered at this address
+        PeerStatus status;
+        AgentResponse response;
+        std::chrono::milliseconds latency;
+    };
+    
+    /**
+     * @brief Broadcast settings
+     */
+    struct BroadcastOptions {
+        // Global deadline for the whole fan-out; zero uses the connection timeout
+        std::chrono::milliseconds deadline{0};
+        
+        // Stop waiting once this many peers answered successfully; zero waits for all
+        size_t quorum = 0;
+        
+        // Called for each answer as it arrives, one at a time; return false to stop waiting
+        std::function<bool(const PeerResult&)> onResponse;
+    };
+    
+    /**
+     * @brief Result of a broadcast
+     */
+    struct BroadcastResult {
+        std::vector<PeerResult> peers;   // One per connection, in connection order
+        size_t succeeded = 0;
+        size_t failed = 0;
+        size_t timedOut = 0;
+        bool complete = false;           // True if every peer answered in time
+    };
+    
+    /**
+     * @brief What sendMessageAsync() does when a peer's send queue is full
+     */
+    enum class OverflowPolicy {
+        BLOCK,         // Wait for room (rejects instead when called from a transport thread)
+        DROP_OLDEST,   // Fail the oldest queued message and queue the new one
+        REJECT         // Return false without queuing
+    };
+    
+    /**
+     * @brief Per-peer backpressure for sendMessageAsync()
+     * 
+     * Each peer gets at most maxInFlight outstanding sends; further messages
+     * wait in a queue of at most maxQueued, and beyond that the overflow policy
+     * applies. With maxQueued at zero nothing is queued, and DROP_OLDEST then
+     * rejects like REJECT. New limits apply to senders already blocked.
+     */
+    struct SendQueueOptions {
+        bool enabled = true;
+        size_t maxInFlight = 1024;
+        size_t maxQueued = 4096;
+        OverflowPolicy overflow = OverflowPolicy::BLOCK;
+        std::chrono::milliseconds blockTimeout{0};   // Zero waits until there is room
+    };
+    
+    /**
+     * @brief Send queue metrics for one peer
+     */
+    struct SendQueueStats {
+        std::string address;
+        size_t inFlight = 0;
+        size_t queued = 0;
+        size_t peakQueued = 0;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;
+        uint64_t rejected = 0;
+        uint64_t blocked = 0;    // Sends that had to wait for room
+    };
+    
+    /**
+     * @brief Channel pool settings
+     * 
+     * Channels to an endpoint are opened on first use. Another channel is only
+     * opened once every existing one carries maxStreamsPerChannel calls, and
+     * channels without calls for idleTimeout are closed.
+     */
+    struct ChannelPoolOptions {
+        size_t maxStreamsPerChannel = 100;
+        size_t maxChannelsPerEndpoint = 4;
+        std::chrono::milliseconds idleTimeout{60000};
+    };
+    
+    /**
+     * @brief Channel pool metrics across all endpoints
+     */
+    struct ChannelPoolStats {
+        size_t endpoints = 0;
+        size_t channels = 0;
+        size_t readyChannels = 0;
+        size_t activeCalls = 0;
+        uint64_t channelsOpened = 0;
+        uint64_t channelsEvicted = 0;
+        uint64_t malformedStreamFrames = 0;   // Stream responses dropped because they failed to decode
+    };
+    
+    /**
+     * @brief Compression applied to messages and responses
+     */
+    enum class CompressionAlgorithm {
+        NONE,
+        DEFLATE,
+        GZIP
+    };
+    
+    /**
+     * @brief Compression settings
+     * 
+     * Peers advertise the encodings they accept on every call, and a message
+     * is compressed only once the peer has agreed to the algorithm and the
+     * encoded message is at least minMessageBytes. Traffic to unix: sockets is
+     * never compressed. NONE also asks peers not to compress toward this side.
+     */
+    struct CompressionOptions {
+        CompressionAlgorithm algorithm = CompressionAlgorithm::GZIP;
+        size_t minMessageBytes = 16 * 1024;
+    };
+    
+    /**
+     * @brief Compression metrics for one peer, or for this server's responses
+     */
+    struct CompressionStats {
+        std::string address;
+        CompressionAlgorithm negotiated = CompressionAlgorithm::NONE;
+        uint64_t compressedMessages = 0;
+        uint64_t uncompressedMessages = 0;
+        uint64_t compressedBytes = 0;    // Encoded size before compression
+    };
+    
+    /**
+     * @brief Request hedging for sendMessage()
+     * 
+     * When the receiver was registered with an agent type that other peers
+     * share, a copy of the message goes to an alternate peer of that type if no
+     * response arrived within the hedge delay, or at once if an attempt fails.
+     * The delay is the given percentile of recent latencies for the type,
+     * clamped to [minDelay, maxDelay]; maxDelay applies until enough samples
+     * exist. The first successful response wins; cancelling the request
+     * cancels every attempt still outstanding. Copies go to different peers,
+     * and each peer's deduplication cache only sees its own arrivals, so a
+     * hedged request may run on more than one agent. Only messages marked
+     * idempotent are hedged; all others go to their receiver alone.
+     */
+    struct HedgingOptions {
+        bool enabled = false;
+        double percentile = 0.95;
+        std::chrono::milliseconds minDelay{1};
+        std::chrono::milliseconds maxDelay{500};
+        int maxHedges = 1;                       // Alternates tried per request
+    };
+    
+    /**
+     * @brief Hedging and deduplication counters
+     */
+    struct HedgingStats {
+        uint64_t hedgeableRequests = 0;     // Sends that had alternates
+        uint64_t hedgesSent = 0;
+        uint64_t hedgeWins = 0;             // Requests answered first by an alternate
+        uint64_t duplicatesSuppressed = 0;  // Arrivals this server answered without running the handler
+    };
+    
+    /**
+     * @brief Receiver-side deduplication of requests
+     * 
+     * Requests are keyed by senderId and correlationId; requests without a
+     * correlationId are never deduplicated. A duplicate of a running request
+     * waits for its response, and a duplicate within window of a finished one
+     * gets the stored response. Off by default, because callers may reuse
+     * correlation IDs for distinct requests.
+     */
+    struct DeduplicationOptions {
+        bool enabled = false;
+        std::chrono::milliseconds window{30000};
+        size_t maxEntries = 100000;
     };
     
     /**
@@ -54,6 +280,10 @@ public:
     
     /**
      * @brief Destructor
+     * 
+     * Stops the server and fails queued sends, then waits for every send
+     * still in flight to complete, including those whose handlers are
+     * running in this process.
      */
     ~GrpcCommunicationProtocol();
     
@@ -63,8 +293,14 @@ public:
      * @param serverAddress Address to bind the server (e.g., "0.0.0.0:50051")
      * @param tlsCertPath Path to TLS certificate file
      * @param tlsKeyPath Path to TLS private key file
-     * @param caCertPath Path to CA certificate file (optional)
+     * @param caCertPath Path to CA certificate file (optional; enables client certificate verification)
      * @return bool True if initialization was successful
+     * 
+     * Passing empty certificate and key paths selects plaintext credentials,
+     * which is intended for localhost loopback testing only. Port 0 lets
+     * startServer() pick a free port, see getServerAddress(). A "unix:" or
+     * "unix-abstract:" address listens on a unix-domain socket with local
+     * credentials instead, and the TLS paths are ignored.
      */
     bool initializeServer(const std::string& serverAddress,
                          const std::string& tlsCertPath,
@@ -79,12 +315,167 @@ public:
      * @param tlsKeyPath Path to client TLS private key file
      * @param caCertPath Path to CA certificate file
      * @return bool True if initialization was successful
+     * 
+     * Each call adds a connection; sendMessage() uses the most recently added one
+     * and broadcastMessage() uses all of them. Empty paths select plaintext
+     * credentials for localhost loopback testing. Connections to "unix:"
+     * addresses always use local credentials.
      */
     bool initializeClient(const std::string& serverAddress,
                          const std::string& tlsCertPath,
                          const std::string& tlsKeyPath,
                          const std::string& caCertPath);
     
+    /**
+     * @brief Route messages for an agent to a server address
+     * 
+     * Messages whose receiverId matches agentId are sent over the connection to
+     * serverAddress, which is created with the credentials of the last
+     * initializeClient() call if it does not exist yet.
+     * 
+     * @param agentId Agent identifier
+     * @param serverAddress Address of the agent's server
+     * @param agentType Peers sharing a non-empty type are alternates for hedging
+     * @return bool True if the peer was registered
+     */
+    bool registerPeer(const std::string& agentId, const std::string& serverAddress,
+                      const std::string& agentType = "");
+    
+    /**
+     * @brief Send messages over persistent bidirectional streams
+     * 
+     * When enabled, each connection keeps one long-lived stream that multiplexes
+     * all messages; responses are matched by correlationId, which is assigned
+     * automatically if empty. Disabled by default (one unary RPC per message).
+     * Sends that can be cancelled on their own, sendMessage() with a
+     * cancellable token and hedged requests, still use unary RPCs.
+     * 
+     * @param enabled True to use streams
+     */
+    void setStreamingEnabled(bool enabled);
+    
+    /**
+     * @brief Configure batching of asynchronous sends
+     * 
+     * Only sendMessageAsync() is batched; sendMessage() and broadcastMessage()
+     * always send immediately.
+     * 
+     * @param options Batching settings
+     */
+    void setBatchingOptions(const BatchingOptions& options);
+    
+    /**
+     * @brief Configure per-peer send queues and their overflow policy
+     * 
+     * @param options Queue limits and overflow policy
+     */
+    void setSendQueueOptions(const SendQueueOptions& options);
+    
+    /**
+     * @brief Get send queue metrics for every peer
+     * 
+     * @return std::vector<SendQueueStats> One entry per connection
+     */
+    std::vector<SendQueueStats> getSendQueueStats() const;
+    
+    /**
+     * @brief Configure the per-endpoint channel pool
+     * 
+     * @param options Pool limits and idle timeout
+     */
+    void setChannelPoolOptions(const ChannelPoolOptions& options);
+    
+    /**
+     * @brief Get channel pool metrics
+     * 
+     * @return ChannelPoolStats Current pool state
+     */
+    ChannelPoolStats getChannelPoolStats() const;
+    
+    /**
+     * @brief Configure message compression
+     * 
+     * @param options Algorithm and size threshold
+     */
+    void setCompressionOptions(const CompressionOptions& options);
+    
+    /**
+     * @brief Get compression metrics
+     * 
+     * @return std::vector<CompressionStats> One entry per connection, plus one
+     *         for the server's address covering the responses it sent
+     */
+    std::vector<CompressionStats> getCompressionStats() const;
+    
+    /**
+     * @brief Configure request hedging
+     * 
+     * @param options Hedging settings
+     */
+    void setHedgingOptions(const HedgingOptions& options);
+    
+    /**
+     * @brief Configure receiver-side deduplication; replaces the cache
+     * 
+     * @param options Deduplication settings
+     */
+    void setDeduplicationOptions(const DeduplicationOptions& options);
+    
+    /**
+     * @brief Get hedging and deduplication counters
+     * 
+     * @return HedgingStats Current counters
+     */
+    HedgingStats getHedgingStats() const;
+    
+    /**
+     * @brief Enable or disable shared memory for large payloads on unix: connections
+     * 
+     * When enabled (the default), payloads of SharedMemoryRing::kMinPayloadSize
+     * bytes or more sent over a unix-domain socket are copied into a POSIX
+     * shared-memory ring and only a reference crosses the socket. The receiver
+     * must run as the same user. Ignored for TCP addresses.
+     * 
+     * @param enabled Whether to use the shared-memory ring
+     */
+    void setSharedMemoryTransfer(bool enabled);
+    
+    /**
+     * @brief Enable or disable the in-process shortcut
+     * 
+     * When enabled (the default), messages addressed to a server running in the
+     * same process are handed to its handlers through an in-memory queue,
+     * without serialization, TLS or sockets. Handlers and callbacks see the
+     * same messages and responses as over gRPC; only the connection timeout
+     * does not apply, since nothing can be lost in transit.
+     * 
+     * @param enabled Whether to deliver to co-located servers in-process
+     */
+    void setInProcessDelivery(bool enabled);
+    
+    /**
+     * @brief Deliver received payloads as views instead of strings
+     * 
+     * When enabled, received payloads arrive in payloadView/responseView,
+     * pointing into the receive buffer, and payload/responseData are left
+     * empty. When disabled (the default) they are copied into the string
+     * fields and the views are left empty.
+     * 
+     * @param enabled Whether to deliver payloads as views
+     */
+    void setZeroCopyPayloads(bool enabled);
+    
+    /**
+     * @brief Set the number of server polling threads
+     * 
+     * Each thread owns one completion queue. Must be called before startServer().
+     * Handlers registered without a HandlerExecutor run on these threads, so
+     * long-running ones should be given an executor or hand work off.
+     * 
+     * @param threadCount Number of polling threads (defaults to hardware concurrency)
+     */
+    void setServerThreadCount(int threadCount);
+    
     /**
      * @brief Start the gRPC server
      * 
@@ -105,24 +496,71 @@ public:
      */
     AgentResponse sendMessage(const AgentMessage& message);
     
+    /**
+     * @brief Send a message to another agent, giving up when cancelled
+     * 
+     * Returns an error response as soon as the token is cancelled. The call
+     * goes out as a unary RPC even with streaming enabled, and is cancelled
+     * while still on the wire so the peer can stop working on it; the
+     * token's deadline caps the call deadline.
+     * 
+     * @param message Message to send
+     * @param cancellation Token that abandons the call when cancelled
+     * @return AgentResponse Response from the target agent
+     */
+    AgentResponse sendMessage(const AgentMessage& message, const CancellationToken& cancellation);
+    
     /**
      * @brief Send an asynchronous message to another agent
      * 
      * @param message Message to send
      * @param callback Callback function to handle the response
-     * @return bool True if message was queued successfully
+     * @return bool True if message was queued successfully; false if there is no
+     *              connection or the peer's send queue rejected it
      */
     bool sendMessageAsync(const AgentMessage& message, 
                          std::function<void(const AgentResponse&)> callback);
     
+    /**
+     * @brief Send an asynchronous message, moving it when the receiver is in this process
+     * 
+     * @param message Message to send
+     * @param callback Callback function to handle the response
+     * @return bool True if message was queued successfully
+     */
+    bool sendMessageAsync(AgentMessage&& message,
+                         std::function<void(const AgentResponse&)> callback);
+    
     /**
      * @brief Register a message handler for a specific message type
      * 
+     * Handlers are kept in a table indexed by interned type. Messages
+     * delivered in-process with messageTypeId set reach their handler with one
+     * table index; all others, including every message from the network, are
+     * looked up by their type string first. Without an executor the handler
+     * runs on the thread that received the message; with one, it runs on the
+     * executor's threads.
+     * 
      * @param messageType Type of message to handle
      * @param handler Handler function
+     * @param executor Executor to run the handler on, or nullptr
      * @return bool True if registration was successful
      */
-    bool registerMessageHandler(const std::string& messageType, MessageHandler handler);
+    bool registerMessageHandler(const std::string& messageType, MessageHandler handler,
+                                std::shared_ptr<HandlerExecutor> executor = nullptr);
+    
+    /**
+     * @brief Get the process-wide ID of a message type
+     * 
+     * Setting AgentMessage::messageTypeId from this spares the receiver a
+     * string lookup when the message is delivered within the process. IDs are
+     * not portable between processes, so a message sent over the network
+     * carries the type string instead, resolved from the ID if left empty.
+     * 
+     * @param messageType Message type string
+     * @return MessageTypeId ID, stable for the life of the process
+     */
+    static MessageTypeId internMessageType(const std::string& messageType);
     
     /**
      * @brief Broadcast a message to all connected agents
@@ -132,6 +570,19 @@ public:
      */
     std::vector<AgentResponse> broadcastMessage(const AgentMessage& message);
     
+    /**
+     * @brief Broadcast a message to all connected agents under a global deadline
+     * 
+     * Sends to every peer concurrently and returns when all have answered, the
+     * deadline passes, the quorum is reached or onResponse asks to stop.
+     * Answers that arrive later are discarded.
+     * 
+     * @param message Message to broadcast
+     * @param options Deadline, quorum and streaming callback
+     * @return BroadcastResult Per-peer results, including partial ones
+     */
+    BroadcastResult broadcastMessage(const AgentMessage& message, const BroadcastOptions& options);
+    
     /**
      * @brief Get connection status
      * 
@@ -146,6 +597,16 @@ public:
      */
     bool isServerRunning() const;
     
+    /**
+     * @brief Get the address the server listens on
+     * 
+     * Once the server has started, a requested port 0 is replaced by the
+     * port that was picked, so the address can be handed to clients.
+     * 
+     * @return std::string Server address, empty before initializeServer()
+     */
+    std::string getServerAddress() const;
+    
     /**
      * @brief Set connection timeout in milliseconds
      * 
@@ -156,6 +617,9 @@ public:
     /**
      * @brief Get number of active connections
      * 
+     * Counts pooled channels that are currently connected, so an endpoint
+     * served by several channels contributes more than one.
+     * 
      * @return int Number of active connections
      */
     int getActiveConnectionCount() const;
@@ -0,0 +1,73 @@
+#include "orchestrator/communication/handler_executor.h"
+#include <algorithm>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+HandlerExecutor::HandlerExecutor(std::string name, int threadCount, size_t queueCapacity)
+    : name_(std::move(name)), capacity_(std::max<size_t>(1, queueCapacity)) {
+    threadCount = std::max(1, threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&HandlerExecutor::workerLoop, this);
+    }
+}
+
+HandlerExecutor::~HandlerExecutor() {
+    stop();
+}
+
+bool HandlerExecutor::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || tasks_.size() >= capacity_) {
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void HandlerExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t HandlerExecutor::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void HandlerExecutor::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                // Stopping and drained
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Dedicated thread pool for the handlers of selected message types
+ *
+ * Binding heavy message types to their own executor keeps them from occupying
+ * the server's completion-queue threads, which then stay free for latency-
+ * critical control messages. Tasks run in FIFO order; with one thread, the
+ * handlers of a type also complete in arrival order.
+ */
+class HandlerExecutor {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Construct and start an executor
+     *
+     * @param name Name for diagnostics
+     * @param threadCount Number of worker threads
+     * @param queueCapacity Maximum number of queued tasks
+     */
+    HandlerExecutor(std::string name, int threadCount, size_t queueCapacity = 4096);
+
+    /**
+     * @brief Destructor; stops the executor
+     */
+    ~HandlerExecutor();
+
+    HandlerExecutor(const HandlerExecutor&) = delete;
+    HandlerExecutor& operator=(const HandlerExecutor&) = delete;
+
+    /**
+     * @brief Queue a task
+     *
+     * @param task Task to run on a worker thread
+     * @return bool False if the executor is stopped or its queue is full
+     */
+    bool post(Task task);
+
+    /**
+     * @brief Stop accepting tasks, run the queued ones and join the workers
+     */
+    void stop();
+
+    /**
+     * @brief Get the executor name
+     *
+     * @return const std::string& Name given at construction
+     */
+    const std::string& name() const { return name_; }
+
+    /**
+     * @brief Get the number of tasks waiting for a worker
+     *
+     * @return size_t Queued tasks
+     */
+    size_t queued() const;
+
+private:
+    void workerLoop();
+
+    std::string name_;
+    size_t capacity_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
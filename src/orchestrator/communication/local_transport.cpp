@@ -0,0 +1,181 @@
+#include "orchestrator/communication/local_transport.h"
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+namespace {
+
+struct Registry {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<LocalEndpoint>> endpoints;
+    std::atomic<uint64_t> generation{1};
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local bool tWorkerThread = false;
+
+// Maps wildcard and loopback hosts to one key per port
+std::string canonicalAddress(const std::string& address) {
+    static const char* const kLocalHosts[] = {
+        "0.0.0.0", "[::]", "::", "localhost", "127.0.0.1", "[::1]", "ipv4:127.0.0.1", "ipv6:[::1]", "dns:localhost"
+    };
+
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || address.compare(0, 5, "unix:") == 0) {
+        return address;
+    }
+
+    std::string host = address.substr(0, colon);
+    for (const char* localHost : kLocalHosts) {
+        if (host == localHost) {
+            return "local:" + address.substr(colon + 1);
+        }
+    }
+    return address;
+}
+
+} // namespace
+
+LocalEndpoint::LocalEndpoint(int workerCount, size_t queueCapacity, Dispatcher dispatcher)
+    : dispatcher_(std::move(dispatcher)), queue_(queueCapacity) {
+    workerCount = std::max(1, workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        workers_.emplace_back(&LocalEndpoint::workerLoop, this);
+    }
+}
+
+LocalEndpoint::~LocalEndpoint() {
+    stop();
+}
+
+bool LocalEndpoint::post(AgentMessage& message, ResponseCallback& callback) {
+    activePosters_.fetch_add(1);
+    if (stopping_.load()) {
+        activePosters_.fetch_sub(1);
+        return false;
+    }
+
+    Delivery delivery{std::move(message), std::move(callback)};
+    bool queued = queue_.tryPush(delivery);
+    activePosters_.fetch_sub(1);
+
+    if (!queued) {
+        message = std::move(delivery.message);
+        callback = std::move(delivery.callback);
+        return false;
+    }
+
+    // Pairs with the fence in waitForWork(): either the worker sees the item or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parkedWorkers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        parkCv_.notify_one();
+    }
+    return true;
+}
+
+void LocalEndpoint::stop() {
+    {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        if (stopping_.exchange(true)) {
+            return;
+        }
+        parkCv_.notify_all();
+    }
+
+    // A poster that saw stopping_ == false may still be pushing
+    while (activePosters_.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+bool LocalEndpoint::waitForWork(Delivery& delivery) {
+    for (int spin = 0; spin < kSpinsBeforePark; ++spin) {
+        if (queue_.tryPop(delivery)) {
+            return true;
+        }
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(parkMutex_);
+    parkedWorkers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool found = false;
+    while (!(found = queue_.tryPop(delivery)) && !stopping_.load()) {
+        parkCv_.wait(lock);
+    }
+    parkedWorkers_.fetch_sub(1, std::memory_order_relaxed);
+    return found;
+}
+
+bool LocalEndpoint::onWorkerThread() {
+    return tWorkerThread;
+}
+
+void LocalEndpoint::workerLoop() {
+    tWorkerThread = true;
+    Delivery delivery;
+    while (true) {
+        if (!waitForWork(delivery)) {
+            // Stopping; drain whatever was accepted before the stop
+            if (activePosters_.load() > 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!queue_.tryPop(delivery)) {
+                return;
+            }
+        }
+
+        dispatcher_(std::move(delivery.message), std::move(delivery.callback));
+        delivery = Delivery();
+    }
+}
+
+void LocalTransportRegistry::registerEndpoint(const std::string& address,
+                                              std::shared_ptr<LocalEndpoint> endpoint) {
+    Registry& instance = registry();
+    std::unique_lock<std::shared_mutex> lock(instance.mutex);
+    instance.endpoints[canonicalAddress(address)] = std::move(endpoint);
+    instance.generation.fetch_add(1);
+}
+
+void LocalTransportRegistry::unregisterEndpoint(const std::string& address, const LocalEndpoint* endpoint) {
+    Registry& instance = registry();
+    std::unique_lock<std::shared_mutex> lock(instance.mutex);
+    auto it = instance.endpoints.find(canonicalAddress(address));
+    if (it != instance.endpoints.end() && it->second.get() == endpoint) {
+        instance.endpoints.erase(it);
+        instance.generation.fetch_add(1);
+    }
+}
+
+std::shared_ptr<LocalEndpoint> LocalTransportRegistry::find(const std::string& address) {
+    Registry& instance = registry();
+    std::shared_lock<std::shared_mutex> lock(instance.mutex);
+    auto it = instance.endpoints.find(canonicalAddress(address));
+    return it != instance.endpoints.end() ? it->second : nullptr;
+}
+
+uint64_t LocalTransportRegistry::generation() {
+    return registry().generation.load(std::memory_order_acquire);
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
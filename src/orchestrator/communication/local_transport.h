@@ -0,0 +1,137 @@
+#pragma once
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/communication/mpmc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief In-process delivery point of a running agent server
+ * 
+ * Co-located clients hand messages to the endpoint's lock-free queue instead
+ * of going through gRPC; the endpoint's workers run the server's handlers and
+ * invoke the sender's callback. Messages are moved, never serialized.
+ */
+class LocalEndpoint {
+public:
+    using AgentMessage = GrpcCommunicationProtocol::AgentMessage;
+    using AgentResponse = GrpcCommunicationProtocol::AgentResponse;
+    using ResponseCallback = std::function<void(AgentResponse&&)>;
+    using Dispatcher = std::function<void(AgentMessage&&, ResponseCallback&&)>;
+
+    /**
+     * @brief Construct and start an endpoint
+     * 
+     * @param workerCount Number of worker threads
+     * @param queueCapacity Maximum number of queued messages
+     * @param dispatcher Runs or schedules the handler for one message and
+     *                   eventually passes its response to the callback
+     */
+    LocalEndpoint(int workerCount, size_t queueCapacity, Dispatcher dispatcher);
+
+    /**
+     * @brief Destructor; stops the endpoint
+     */
+    ~LocalEndpoint();
+
+    /**
+     * @brief Queue a message for delivery
+     * 
+     * @param message Message to move into the queue; left untouched on failure
+     * @param callback Invoked with the handler's response, on a worker thread
+     *                 or on the executor bound to the message type
+     * @return bool False if the endpoint is stopped or its queue is full
+     */
+    bool post(AgentMessage& message, ResponseCallback& callback);
+
+    /**
+     * @brief Stop accepting messages, finish queued ones and join the workers
+     */
+    void stop();
+
+    /**
+     * @brief Check whether the calling thread is a worker of some endpoint
+     * 
+     * @return bool True on an endpoint worker thread
+     */
+    static bool onWorkerThread();
+
+private:
+    struct Delivery {
+        AgentMessage message{};
+        ResponseCallback callback;
+    };
+
+    void workerLoop();
+    bool waitForWork(Delivery& delivery);
+
+    static constexpr int kSpinsBeforePark = 64;
+
+    Dispatcher dispatcher_;
+    MpmcQueue<Delivery> queue_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> activePosters_{0};
+
+    // Parking for idle workers; posters only take the mutex when someone is parked
+    std::atomic<int> parkedWorkers_{0};
+    std::mutex parkMutex_;
+    std::condition_variable parkCv_;
+};
+
+/**
+ * @brief Process-wide directory of local endpoints by listening address
+ * 
+ * Wildcard and loopback hosts on the same port resolve to the same endpoint,
+ * so a client of "localhost:50051" finds a server listening on "0.0.0.0:50051".
+ */
+class LocalTransportRegistry {
+public:
+    /**
+     * @brief Publish an endpoint under an address, replacing any previous one
+     * 
+     * @param address Listening address of the server
+     * @param endpoint Endpoint to publish
+     */
+    static void registerEndpoint(const std::string& address, std::shared_ptr<LocalEndpoint> endpoint);
+
+    /**
+     * @brief Withdraw the endpoint registered under an address
+     * 
+     * @param address Listening address of the server
+     * @param endpoint Endpoint to withdraw; a newer registration is left in place
+     */
+    static void unregisterEndpoint(const std::string& address, const LocalEndpoint* endpoint);
+
+    /**
+     * @brief Look up the endpoint for a target address
+     * 
+     * @param address Target address as given to the client
+     * @return std::shared_ptr<LocalEndpoint> Endpoint, or nullptr if not in this process
+     */
+    static std::shared_ptr<LocalEndpoint> find(const std::string& address);
+
+    /**
+     * @brief Get the registry generation, bumped on every change
+     * 
+     * Lets callers cache lookups and revalidate with a single atomic load.
+     * 
+     * @return uint64_t Current generation
+     */
+    static uint64_t generation();
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,536 @@
+#include "orchestrator/communication/message_codec.h"
+#include "orchestrator/communication/message_types.h"
+#include <grpc/slice.h>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+const char* const MessageCodec::kUnaryMethod = "/dist_prompt.orchestrator.AgentService/Send";
+const char* const MessageCodec::kStreamMethod = "/dist_prompt.orchestrator.AgentService/Stream";
+const char* const MessageCodec::kBatchMethod = "/dist_prompt.orchestrator.AgentService/SendBatch";
+
+namespace {
+
+constexpr uint8_t kFormatVersion = 1;
+
+// Same layout, but the payload field is a shared-memory reference (segment, offset, length)
+constexpr uint8_t kSharedMemoryFormatVersion = 2;
+
+using ShmReference = std::optional<SharedMemoryRing::Reference>;
+
+// Views at least this large travel as their own slice; smaller ones are copied into the frame
+constexpr size_t kOutOfLinePayloadSize = 1024;
+
+bool isOutOfLine(const PayloadView& view) {
+    return view.size() >= kOutOfLinePayloadSize;
+}
+
+// Appends fixed-width little-endian fields to a preallocated buffer
+class Writer {
+public:
+    explicit Writer(uint8_t* out) : start_(out), out_(out) {}
+
+    void putU8(uint8_t value) {
+        *out_++ = value;
+    }
+
+    void putU32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            *out_++ = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    void putI64(int64_t value) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (int i = 0; i < 8; ++i) {
+            *out_++ = static_cast<uint8_t>(bits >> (8 * i));
+        }
+    }
+
+    void putU64(uint64_t value) {
+        putI64(static_cast<int64_t>(value));
+    }
+
+    void putBytes(const char* data, size_t size) {
+        putU32(static_cast<uint32_t>(size));
+        if (size > 0) {
+            std::memcpy(out_, data, size);
+            out_ += size;
+        }
+    }
+
+    void putString(const std::string& value) {
+        putBytes(value.data(), value.size());
+    }
+
+    size_t offset() const {
+        return static_cast<size_t>(out_ - start_);
+    }
+
+    static size_t stringSize(const std::string& value) {
+        return 4 + value.size();
+    }
+
+private:
+    uint8_t* start_;
+    uint8_t* out_;
+};
+
+// Builds a byte buffer from one frame slice holding every inline field,
+// interleaved with out-of-line payload slices that are referenced, not copied
+class Encoder {
+public:
+    explicit Encoder(size_t frameSize)
+        : frame_(grpc_slice_malloc(frameSize), grpc::Slice::STEAL_REF),
+          writer_(const_cast<uint8_t*>(frame_.begin())) {}
+
+    Writer& writer() {
+        return writer_;
+    }
+
+    void putReference(const SharedMemoryRing::Reference& reference) {
+        writer_.putString(reference.segment);
+        writer_.putU64(reference.offset);
+        writer_.putU64(reference.length);
+    }
+
+    void putPayload(const std::string& bytes, const PayloadView& view) {
+        if (view.empty()) {
+            writer_.putString(bytes);
+        } else if (!isOutOfLine(view)) {
+            writer_.putBytes(view.data(), view.size());
+        } else {
+            writer_.putU32(static_cast<uint32_t>(view.size()));
+            cut();
+            view.appendSlices(&slices_);
+        }
+    }
+
+    grpc::ByteBuffer finish() {
+        if (slices_.empty()) {
+            return grpc::ByteBuffer(&frame_, 1);
+        }
+        cut();
+        return grpc::ByteBuffer(slices_.data(), slices_.size());
+    }
+
+private:
+    // Ends the current frame segment at the writer position
+    void cut() {
+        size_t offset = writer_.offset();
+        if (offset > segmentStart_) {
+            slices_.push_back(frame_.sub(segmentStart_, offset));
+        }
+        segmentStart_ = offset;
+    }
+
+    grpc::Slice frame_;
+    Writer writer_;
+    std::vector<grpc::Slice> slices_;
+    size_t segmentStart_ = 0;
+};
+
+// Bounds-checked reader over the slices of an encoded buffer. Fields may
+// straddle slice boundaries, since gRPC splits received buffers wherever
+// the transport read ended.
+class Reader {
+public:
+    explicit Reader(std::vector<grpc::Slice> slices) : slices_(std::move(slices)) {
+        for (const auto& slice : slices_) {
+            size_ += slice.size();
+        }
+    }
+
+    bool getU8(uint8_t* value) {
+        return read(value, 1);
+    }
+
+    bool getU32(uint32_t* value) {
+        uint8_t bytes[4];
+        if (!read(bytes, sizeof(bytes))) {
+            return false;
+        }
+        uint32_t result = 0;
+        for (int i = 0; i < 4; ++i) {
+            result |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+        }
+        *value = result;
+        return true;
+    }
+
+    bool getI64(int64_t* value) {
+        uint8_t bytes[8];
+        if (!read(bytes, sizeof(bytes))) {
+            return false;
+        }
+        uint64_t result = 0;
+        for (int i = 0; i < 8; ++i) {
+            result |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        *value = static_cast<int64_t>(result);
+        return true;
+    }
+
+    bool getU64(uint64_t* value) {
+        int64_t result = 0;
+        if (!getI64(&result)) {
+            return false;
+        }
+        *value = static_cast<uint64_t>(result);
+        return true;
+    }
+
+    bool getString(std::string* value) {
+        uint32_t length = 0;
+        if (!getU32(&length) || remaining() < length) {
+            return false;
+        }
+        value->clear();
+        value->reserve(length);
+        consume(length, [value](const uint8_t* data, size_t size) {
+            value->append(reinterpret_cast<const char*>(data), size);
+        });
+        return true;
+    }
+
+    // Locates a length-prefixed field without copying it
+    bool getSpan(size_t* offset, size_t* length) {
+        uint32_t size = 0;
+        if (!getU32(&size) || remaining() < size) {
+            return false;
+        }
+        *offset = position_;
+        *length = size;
+        consume(size, [](const uint8_t*, size_t) {});
+        return true;
+    }
+
+    size_t remaining() const {
+        return size_ - position_;
+    }
+
+    const std::vector<grpc::Slice>& slices() const {
+        return slices_;
+    }
+
+private:
+    bool read(uint8_t* out, size_t length) {
+        if (remaining() < length) {
+            return false;
+        }
+        consume(length, [&out](const uint8_t* data, size_t size) {
+            std::memcpy(out, data, size);
+            out += size;
+        });
+        return true;
+    }
+
+    // Hands the next length bytes to sink, one piece per slice; caller checked remaining()
+    template <typename Sink>
+    void consume(size_t length, Sink sink) {
+        while (length > 0) {
+            const grpc::Slice& slice = slices_[index_];
+            size_t size = std::min(length, slice.size() - inSlice_);
+            sink(slice.begin() + inSlice_, size);
+            length -= size;
+            position_ += size;
+            inSlice_ += size;
+            if (inSlice_ == slice.size()) {
+                index_++;
+                inSlice_ = 0;
+            }
+        }
+    }
+
+    std::vector<grpc::Slice> slices_;
+    size_t size_ = 0;
+    size_t position_ = 0;
+    size_t index_ = 0;     // Slice holding position_
+    size_t inSlice_ = 0;   // Offset of position_ within that slice
+};
+
+// Decoding source: the buffer's slices plus, in view mode, a view sharing them
+struct Source {
+    Reader reader;
+    PayloadView whole;
+    bool copyPayload;
+
+    bool getPayload(uint8_t version, std::string* bytes, PayloadView* view) {
+        if (version == kSharedMemoryFormatVersion) {
+            SharedMemoryRing::Reference reference;
+            std::string payload;
+            if (!(reader.getString(&reference.segment) && reader.getU64(&reference.offset) &&
+                  reader.getU64(&reference.length) && SharedMemoryRing::read(reference, &payload))) {
+                return false;
+            }
+            if (copyPayload) {
+                *bytes = std::move(payload);
+            } else {
+                *view = PayloadView::fromString(std::move(payload));
+            }
+            return true;
+        }
+
+        if (copyPayload) {
+            return reader.getString(bytes);
+        }
+        size_t offset = 0;
+        size_t length = 0;
+        if (!reader.getSpan(&offset, &length)) {
+            return false;
+        }
+        *view = whole.subview(offset, length);
+        return true;
+    }
+};
+
+template <typename DecodeFn>
+bool decodeFrom(const grpc::ByteBuffer& buffer, bool copyPayload, DecodeFn decode) {
+    // Takes references to the slices; nothing is copied or joined
+    std::vector<grpc::Slice> slices;
+    if (!buffer.Dump(&slices).ok()) {
+        return false;
+    }
+
+    Source source{Reader(std::move(slices)), PayloadView(), copyPayload};
+    if (!copyPayload) {
+        source.whole = PayloadView::fromSlices(source.reader.slices());
+    }
+    return decode(source);
+}
+
+bool isVersion(uint8_t version) {
+    return version == kFormatVersion || version == kSharedMemoryFormatVersion;
+}
+
+size_t payloadSize(const std::string& bytes, const PayloadView& view) {
+    return 4 + (view.empty() ? bytes.size() : view.size());
+}
+
+// Bytes of the payload field that are written into the frame itself
+size_t inlinePayloadSize(const std::string& bytes, const PayloadView& view, const ShmReference& reference) {
+    if (reference) {
+        return Writer::stringSize(reference->segment) + 8 + 8;
+    }
+    return isOutOfLine(view) ? 4 : payloadSize(bytes, view);
+}
+
+// Moves a large payload into the ring, if there is one and it has room
+ShmReference placePayload(const std::string& bytes, const PayloadView& view, SharedMemoryRing* ring) {
+    const char* data = view.empty() ? bytes.data() : view.data();
+    size_t size = view.empty() ? bytes.size() : view.size();
+    SharedMemoryRing::Reference reference;
+    if (ring && size >= SharedMemoryRing::kMinPayloadSize && ring->write(data, size, &reference)) {
+        return reference;
+    }
+    return std::nullopt;
+}
+
+ShmReference placePayload(const GrpcCommunicationProtocol::AgentMessage& message, SharedMemoryRing* ring) {
+    return placePayload(message.payload, message.payloadView, ring);
+}
+
+ShmReference placePayload(const GrpcCommunicationProtocol::AgentResponse& response, SharedMemoryRing* ring) {
+    return placePayload(response.responseData, response.responseView, ring);
+}
+
+// Interned IDs mean nothing to another process, so a message addressed by ID
+// alone carries the type's string on the wire
+const std::string& wireMessageType(const GrpcCommunicationProtocol::AgentMessage& message,
+                                   std::string* resolved) {
+    if (!message.messageType.empty() ||
+        message.messageTypeId == GrpcCommunicationProtocol::kUnknownMessageType) {
+        return message.messageType;
+    }
+    *resolved = MessageTypeRegistry::name(message.messageTypeId);
+    return *resolved;
+}
+
+size_t messageHeaderSize(const GrpcCommunicationProtocol::AgentMessage& message) {
+    std::string resolved;
+    return 1 + Writer::stringSize(message.senderId) +
+           Writer::stringSize(message.receiverId) +
+           Writer::stringSize(wireMessageType(message, &resolved)) + 8 +
+           Writer::stringSize(message.correlationId);
+}
+
+size_t messageFrameSize(const GrpcCommunicationProtocol::AgentMessage& message, const ShmReference& reference) {
+    return messageHeaderSize(message) + inlinePayloadSize(message.payload, message.payloadView, reference);
+}
+
+void writeMessage(Encoder& encoder, const GrpcCommunicationProtocol::AgentMessage& message,
+                  const ShmReference& reference) {
+    Writer& writer = encoder.writer();
+    writer.putU8(reference ? kSharedMemoryFormatVersion : kFormatVersion);
+    writer.putString(message.senderId);
+    writer.putString(message.receiverId);
+    std::string resolved;
+    writer.putString(wireMessageType(message, &resolved));
+    writer.putI64(message.timestamp);
+    writer.putString(message.correlationId);
+    if (reference) {
+        encoder.putReference(*reference);
+    } else {
+        encoder.putPayload(message.payload, message.payloadView);
+    }
+}
+
+bool readMessage(Source& source, GrpcCommunicationProtocol::AgentMessage* message) {
+    Reader& reader = source.reader;
+    uint8_t version = 0;
+    return reader.getU8(&version) && isVersion(version) &&
+           reader.getString(&message->senderId) &&
+           reader.getString(&message->receiverId) &&
+           reader.getString(&message->messageType) &&
+           reader.getI64(&message->timestamp) &&
+           reader.getString(&message->correlationId) &&
+           source.getPayload(version, &message->payload, &message->payloadView);
+}
+
+size_t responseFrameSize(const GrpcCommunicationProtocol::AgentResponse& response,
+                         const ShmReference& reference) {
+    return 1 + 1 + Writer::stringSize(response.errorMessage) + 8 +
+           Writer::stringSize(response.correlationId) +
+           inlinePayloadSize(response.responseData, response.responseView, reference);
+}
+
+void writeResponse(Encoder& encoder, const GrpcCommunicationProtocol::AgentResponse& response,
+                   const ShmReference& reference) {
+    Writer& writer = encoder.writer();
+    writer.putU8(reference ? kSharedMemoryFormatVersion : kFormatVersion);
+    writer.putU8(response.success ? 1 : 0);
+    writer.putString(response.errorMessage);
+    writer.putI64(response.timestamp);
+    writer.putString(response.correlationId);
+    if (reference) {
+        encoder.putReference(*reference);
+    } else {
+        encoder.putPayload(response.responseData, response.responseView);
+    }
+}
+
+bool readResponse(Source& source, GrpcCommunicationProtocol::AgentResponse* response) {
+    Reader& reader = source.reader;
+    uint8_t version = 0;
+    uint8_t success = 0;
+    if (!(reader.getU8(&version) && isVersion(version) && reader.getU8(&success))) {
+        return false;
+    }
+
+    response->success = success != 0;
+    return reader.getString(&response->errorMessage) &&
+           reader.getI64(&response->timestamp) &&
+           reader.getString(&response->correlationId) &&
+           source.getPayload(version, &response->responseData, &response->responseView);
+}
+
+// Batches are a version byte and a count followed by back-to-back encoded items
+template <typename Item, typename SizeFn, typename WriteFn>
+grpc::ByteBuffer encodeBatch(const std::vector<Item>& items, SharedMemoryRing* ring,
+                             SizeFn frameSizeOf, WriteFn write) {
+    std::vector<ShmReference> references;
+    references.reserve(items.size());
+    size_t size = 1 + 4;
+    for (const auto& item : items) {
+        references.push_back(placePayload(item, ring));
+        size += frameSizeOf(item, references.back());
+    }
+
+    Encoder encoder(size);
+    encoder.writer().putU8(kFormatVersion);
+    encoder.writer().putU32(static_cast<uint32_t>(items.size()));
+    for (size_t i = 0; i < items.size(); ++i) {
+        write(encoder, items[i], references[i]);
+    }
+
+    return encoder.finish();
+}
+
+template <typename Item, typename SizeFn, typename WriteFn>
+grpc::ByteBuffer encodeSingle(const Item& item, SharedMemoryRing* ring, SizeFn frameSizeOf, WriteFn write) {
+    ShmReference reference = placePayload(item, ring);
+    Encoder encoder(frameSizeOf(item, reference));
+    write(encoder, item, reference);
+    return encoder.finish();
+}
+
+template <typename Item, typename ReadFn>
+bool decodeBatch(const grpc::ByteBuffer& buffer, std::vector<Item>* items, bool copyPayload, ReadFn read) {
+    return decodeFrom(buffer, copyPayload, [&](Source& source) {
+        uint8_t version = 0;
+        uint32_t count = 0;
+        if (!(source.reader.getU8(&version) && version == kFormatVersion &&
+              source.reader.getU32(&count))) {
+            return false;
+        }
+
+        // Every item needs at least its version byte, which bounds a hostile count
+        if (count > source.reader.remaining()) {
+            return false;
+        }
+
+        items->clear();
+        items->resize(count);
+        for (auto& item : *items) {
+            if (!read(source, &item)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+} // namespace
+
+grpc::ByteBuffer MessageCodec::encodeMessage(const AgentMessage& message, SharedMemoryRing* ring) {
+    return encodeSingle(message, ring, messageFrameSize, writeMessage);
+}
+
+bool MessageCodec::decodeMessage(const grpc::ByteBuffer& buffer, AgentMessage* message, bool copyPayload) {
+    return decodeFrom(buffer, copyPayload, [message](Source& source) {
+        return readMessage(source, message);
+    });
+}
+
+grpc::ByteBuffer MessageCodec::encodeResponse(const AgentResponse& response, SharedMemoryRing* ring) {
+    return encodeSingle(response, ring, responseFrameSize, writeResponse);
+}
+
+bool MessageCodec::decodeResponse(const grpc::ByteBuffer& buffer, AgentResponse* response, bool copyPayload) {
+    return decodeFrom(buffer, copyPayload, [response](Source& source) {
+        return readResponse(source, response);
+    });
+}
+
+size_t MessageCodec::encodedSize(const AgentMessage& message) {
+    return messageHeaderSize(message) + payloadSize(message.payload, message.payloadView);
+}
+
+grpc::ByteBuffer MessageCodec::encodeMessageBatch(const std::vector<AgentMessage>& messages,
+                                                  SharedMemoryRing* ring) {
+    return encodeBatch(messages, ring, messageFrameSize, writeMessage);
+}
+
+bool MessageCodec::decodeMessageBatch(const grpc::ByteBuffer& buffer, std::vector<AgentMessage>* messages,
+                                      bool copyPayload) {
+    return decodeBatch(buffer, messages, copyPayload, readMessage);
+}
+
+grpc::ByteBuffer MessageCodec::encodeResponseBatch(const std::vector<AgentResponse>& responses,
+                                                   SharedMemoryRing* ring) {
+    return encodeBatch(responses, ring, responseFrameSize, writeResponse);
+}
+
+bool MessageCodec::decodeResponseBatch(const grpc::ByteBuffer& buffer,
+                                       std::vector<AgentResponse>* responses,
+                                       bool copyPayload) {
+    return decodeBatch(buffer, responses, copyPayload, readResponse);
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/communication/shared_memory_ring.h"
+#include <grpcpp/support/byte_buffer.h>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Wire encoding of agent messages for the generic gRPC service
+ *
+ * Messages travel as raw grpc::ByteBuffer payloads of a generic service, so no
+ * protoc step is needed. Fields are length-prefixed little-endian values with a
+ * leading format version byte; the bulk payload is always the last field.
+ *
+ * Payload views are sent as their own slices and decoded payloads are views into
+ * the received buffer, so the payload bytes are not copied by the codec. A
+ * payload that arrived split over several slices is decoded into a segmented
+ * view over those slices rather than joined. When a
+ * shared-memory ring is passed, large payloads are placed in it and only their
+ * reference goes on the wire (format version 2).
+ */
+class MessageCodec {
+public:
+    using AgentMessage = GrpcCommunicationProtocol::AgentMessage;
+    using AgentResponse = GrpcCommunicationProtocol::AgentResponse;
+
+    /**
+     * @brief Fully qualified method names served by the agent service
+     */
+    static const char* const kUnaryMethod;
+    static const char* const kStreamMethod;
+    static const char* const kBatchMethod;
+
+    /**
+     * @brief Encode a message into a byte buffer
+     *
+     * @param message Message to encode
+     * @param ring Ring for large payloads, or nullptr to send everything inline
+     * @return grpc::ByteBuffer Encoded message
+     */
+    static grpc::ByteBuffer encodeMessage(const AgentMessage& message, SharedMemoryRing* ring = nullptr);
+
+    /**
+     * @brief Decode a message
+     *
+     * @param buffer Encoded message
+     * @param message Output message
+     * @param copyPayload Copy the payload into message->payload instead of viewing it
+     * @return bool True if the buffer held a well-formed message
+     */
+    static bool decodeMessage(const grpc::ByteBuffer& buffer, AgentMessage* message,
+                              bool copyPayload = true);
+
+    /**
+     * @brief Encode a response into a byte buffer
+     *
+     * @param response Response to encode
+     * @param ring Ring for large payloads, or nullptr to send everything inline
+     * @return grpc::ByteBuffer Encoded response
+     */
+    static grpc::ByteBuffer encodeResponse(const AgentResponse& response, SharedMemoryRing* ring = nullptr);
+
+    /**
+     * @brief Decode a response
+     *
+     * @param buffer Encoded response
+     * @param response Output response
+     * @param copyPayload Copy the payload into response->responseData instead of viewing it
+     * @return bool True if the buffer held a well-formed response
+     */
+    static bool decodeResponse(const grpc::ByteBuffer& buffer, AgentResponse* response,
+                               bool copyPayload = true);
+    
+    /**
+     * @brief Get the encoded size of a message in bytes
+     *
+     * @param message Message to measure
+     * @return size_t Number of bytes encodeMessage() would produce
+     */
+    static size_t encodedSize(const AgentMessage& message);
+
+    /**
+     * @brief Encode several messages into one buffer, preserving order
+     *
+     * @param messages Messages to encode
+     * @param ring Ring for large payloads, or nullptr to send everything inline
+     * @return grpc::ByteBuffer Encoded batch
+     */
+    static grpc::ByteBuffer encodeMessageBatch(const std::vector<AgentMessage>& messages,
+                                               SharedMemoryRing* ring = nullptr);
+
+    /**
+     * @brief Decode a message batch
+     *
+     * @param buffer Encoded batch
+     * @param messages Output messages in batch order
+     * @param copyPayload Copy payloads into the string fields instead of viewing them
+     * @return bool True if the buffer held a well-formed batch
+     */
+    static bool decodeMessageBatch(const grpc::ByteBuffer& buffer, std::vector<AgentMessage>* messages,
+                                   bool copyPayload = true);
+
+    /**
+     * @brief Encode the responses to a batch, in the same order as its messages
+     *
+     * @param responses Responses to encode
+     * @param ring Ring for large payloads, or nullptr to send everything inline
+     * @return grpc::ByteBuffer Encoded response batch
+     */
+    static grpc::ByteBuffer encodeResponseBatch(const std::vector<AgentResponse>& responses,
+                                                SharedMemoryRing* ring = nullptr);
+
+    /**
+     * @brief Decode a response batch
+     *
+     * @param buffer Encoded response batch
+     * @param responses Output responses in batch order
+     * @param copyPayload Copy payloads into the string fields instead of viewing them
+     * @return bool True if the buffer held a well-formed response batch
+     */
+    static bool decodeResponseBatch(const grpc::ByteBuffer& buffer, std::vector<AgentResponse>* responses,
+                                    bool copyPayload = true);
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,59 @@
+#include "orchestrator/communication/message_types.h"
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+namespace {
+
+struct TypeTable {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, MessageTypeRegistry::MessageTypeId> ids;
+    std::vector<std::string> names{std::string()};   // Index 0 is kUnknownMessageType
+};
+
+TypeTable& table() {
+    static TypeTable instance;
+    return instance;
+}
+
+} // namespace
+
+MessageTypeRegistry::MessageTypeId MessageTypeRegistry::intern(const std::string& messageType) {
+    if (messageType.empty()) {
+        return GrpcCommunicationProtocol::kUnknownMessageType;
+    }
+
+    MessageTypeId id = find(messageType);
+    if (id != GrpcCommunicationProtocol::kUnknownMessageType) {
+        return id;
+    }
+
+    TypeTable& instance = table();
+    std::unique_lock<std::shared_mutex> lock(instance.mutex);
+    auto [it, inserted] = instance.ids.emplace(messageType, static_cast<MessageTypeId>(instance.names.size()));
+    if (inserted) {
+        instance.names.push_back(messageType);
+    }
+    return it->second;
+}
+
+MessageTypeRegistry::MessageTypeId MessageTypeRegistry::find(const std::string& messageType) {
+    TypeTable& instance = table();
+    std::shared_lock<std::shared_mutex> lock(instance.mutex);
+    auto it = instance.ids.find(messageType);
+    return it != instance.ids.end() ? it->second : GrpcCommunicationProtocol::kUnknownMessageType;
+}
+
+std::string MessageTypeRegistry::name(MessageTypeId id) {
+    TypeTable& instance = table();
+    std::shared_lock<std::shared_mutex> lock(instance.mutex);
+    return id < instance.names.size() ? instance.names[id] : std::string();
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include <string>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Process-wide table of interned message types
+ *
+ * Each message type string maps to a small integer ID that never changes for
+ * the life of the process, so handlers can be kept in a vector indexed by ID.
+ * ID 0 (kUnknownMessageType) is never assigned.
+ */
+class MessageTypeRegistry {
+public:
+    using MessageTypeId = GrpcCommunicationProtocol::MessageTypeId;
+
+    /**
+     * @brief Get the ID of a message type, assigning one on first use
+     *
+     * @param messageType Message type string
+     * @return MessageTypeId ID, or kUnknownMessageType for an empty string
+     */
+    static MessageTypeId intern(const std::string& messageType);
+
+    /**
+     * @brief Look up the ID of a message type without assigning one
+     *
+     * Used on the receive path, so strings from the network never grow the table.
+     *
+     * @param messageType Message type string
+     * @return MessageTypeId ID, or kUnknownMessageType if never interned
+     */
+    static MessageTypeId find(const std::string& messageType);
+
+    /**
+     * @brief Get the string of an interned message type
+     *
+     * @param id Message type ID
+     * @return std::string Message type, or empty if the ID was never assigned
+     */
+    static std::string name(MessageTypeId id);
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,170 @@
+#include "orchestrator/communication/payload_view.h"
+#include <grpc/slice.h>
+#include <algorithm>
+#include <mutex>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+// Slices of a segmented view and, once data() was called, their joined copy
+struct PayloadView::Chain {
+    std::vector<grpc::Slice> slices;
+    std::vector<size_t> starts;   // Offset of each slice within the view
+    size_t size = 0;
+
+    std::once_flag joinOnce;
+    std::string joined;
+
+    const std::string& join() {
+        std::call_once(joinOnce, [this]() {
+            joined.reserve(size);
+            for (const auto& slice : slices) {
+                joined.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+            }
+        });
+        return joined;
+    }
+};
+
+namespace {
+
+// Releases the owner reference handed to gRPC by toSlice()
+void releaseOwner(void* owner) {
+    delete static_cast<std::shared_ptr<const void>*>(owner);
+}
+
+} // namespace
+
+PayloadView::PayloadView(std::shared_ptr<Chain> chain)
+    : size_(chain->size), chain_(std::move(chain)) {}
+
+PayloadView PayloadView::fromString(std::string bytes) {
+    if (bytes.empty()) {
+        return PayloadView();
+    }
+
+    auto owner = std::make_shared<const std::string>(std::move(bytes));
+    const char* data = owner->data();
+    size_t size = owner->size();
+    return PayloadView(std::move(owner), data, size);
+}
+
+PayloadView PayloadView::fromSlice(grpc::Slice slice) {
+    if (slice.size() == 0) {
+        return PayloadView();
+    }
+
+    auto owner = std::make_shared<const grpc::Slice>(std::move(slice));
+    const char* data = reinterpret_cast<const char*>(owner->begin());
+    size_t size = owner->size();
+    return PayloadView(std::move(owner), data, size);
+}
+
+PayloadView PayloadView::fromSlices(std::vector<grpc::Slice> slices) {
+    slices.erase(std::remove_if(slices.begin(), slices.end(),
+                                [](const grpc::Slice& slice) { return slice.size() == 0; }),
+                 slices.end());
+    if (slices.empty()) {
+        return PayloadView();
+    }
+    if (slices.size() == 1) {
+        return fromSlice(std::move(slices.front()));
+    }
+
+    auto chain = std::make_shared<Chain>();
+    chain->starts.reserve(slices.size());
+    for (const auto& slice : slices) {
+        chain->starts.push_back(chain->size);
+        chain->size += slice.size();
+    }
+    chain->slices = std::move(slices);
+    return PayloadView(std::move(chain));
+}
+
+grpc::Slice PayloadView::toSlice() const {
+    if (size_ == 0) {
+        return grpc::Slice();
+    }
+    if (chain_) {
+        // The joined bytes live as long as the chain
+        return PayloadView(chain_, chain_->join().data(), size_).toSlice();
+    }
+
+    // Small payloads are cheaper to copy than to track
+    if (size_ <= GRPC_SLICE_INLINED_SIZE) {
+        return grpc::Slice(data_, size_);
+    }
+
+    grpc_slice raw = grpc_slice_new_with_user_data(const_cast<char*>(data_), size_, releaseOwner,
+                                                   new std::shared_ptr<const void>(owner_));
+    return grpc::Slice(raw, grpc::Slice::STEAL_REF);
+}
+
+void PayloadView::appendSlices(std::vector<grpc::Slice>* slices) const {
+    if (chain_) {
+        slices->insert(slices->end(), chain_->slices.begin(), chain_->slices.end());
+    } else if (size_ > 0) {
+        slices->push_back(toSlice());
+    }
+}
+
+PayloadView PayloadView::subview(size_t offset, size_t length) const {
+    offset = std::min(offset, size_);
+    length = std::min(length, size_ - offset);
+    if (length == 0) {
+        return PayloadView();
+    }
+    if (!chain_) {
+        return PayloadView(owner_, data_ + offset, length);
+    }
+
+    // First slice holding offset, then slices until length is covered
+    size_t index = static_cast<size_t>(
+        std::upper_bound(chain_->starts.begin(), chain_->starts.end(), offset) - chain_->starts.begin() - 1);
+    std::vector<grpc::Slice> slices;
+    size_t begin = offset - chain_->starts[index];
+    while (length > 0) {
+        const grpc::Slice& slice = chain_->slices[index++];
+        size_t end = std::min(slice.size(), begin + length);
+        slices.push_back(begin == 0 && end == slice.size() ? slice : slice.sub(begin, end));
+        length -= end - begin;
+        begin = 0;
+    }
+    return fromSlices(std::move(slices));
+}
+
+std::string PayloadView::toString() const {
+    if (!chain_) {
+        return std::string(data_, size_);
+    }
+    std::string bytes;
+    bytes.reserve(size_);
+    for (const auto& slice : chain_->slices) {
+        bytes.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+    }
+    return bytes;
+}
+
+size_t PayloadView::segmentCount() const {
+    if (chain_) {
+        return chain_->slices.size();
+    }
+    return size_ > 0 ? 1 : 0;
+}
+
+std::string_view PayloadView::segment(size_t index) const {
+    if (!chain_) {
+        return std::string_view(data_, size_);
+    }
+    const grpc::Slice& slice = chain_->slices[index];
+    return std::string_view(reinterpret_cast<const char*>(slice.begin()), slice.size());
+}
+
+const char* PayloadView::joinedData() const {
+    return chain_->join().data();
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
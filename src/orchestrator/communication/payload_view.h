@@ -0,0 +1,149 @@
+#pragma once
+
+#include <grpcpp/support/slice.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Immutable, reference-counted view of payload bytes
+ * 
+ * A view shares ownership of the buffer it points into, so copying, slicing
+ * and forwarding a view never copies the bytes. Views over received gRPC
+ * slices point straight into the receive buffer, and sending a view hands the
+ * same bytes back to gRPC without an intermediate copy.
+ *
+ * A large payload usually arrives split over many slices. Its view keeps
+ * them as segments: segment() and appendSlices() reach the bytes in place,
+ * while data(), view() and toSlice() join the segments into one buffer on
+ * first use, once per view and its copies.
+ */
+class PayloadView {
+public:
+    /**
+     * @brief Construct an empty view
+     */
+    PayloadView() = default;
+
+    /**
+     * @brief Take ownership of a string's bytes without copying them
+     * 
+     * @param bytes String to adopt
+     * @return PayloadView View over the whole string
+     */
+    static PayloadView fromString(std::string bytes);
+
+    /**
+     * @brief Reference a gRPC slice without copying it
+     * 
+     * @param slice Slice to reference
+     * @return PayloadView View over the whole slice
+     */
+    static PayloadView fromSlice(grpc::Slice slice);
+
+    /**
+     * @brief Reference a sequence of gRPC slices without copying or joining them
+     * 
+     * @param slices Slices to reference, in order
+     * @return PayloadView View over all slices; contiguous if there is at most one
+     */
+    static PayloadView fromSlices(std::vector<grpc::Slice> slices);
+
+    /**
+     * @brief Get a gRPC slice over the viewed bytes that keeps them alive
+     * 
+     * Joins a segmented view; use appendSlices() to avoid that.
+     * 
+     * @return grpc::Slice Slice sharing ownership with this view
+     */
+    grpc::Slice toSlice() const;
+
+    /**
+     * @brief Append slices over the viewed bytes that keep them alive, one per segment
+     * 
+     * @param slices Output slices
+     */
+    void appendSlices(std::vector<grpc::Slice>* slices) const;
+
+    /**
+     * @brief Get a sub-view sharing ownership with this view
+     * 
+     * @param offset Offset of the first byte, clamped to size()
+     * @param length Maximum number of bytes
+     * @return PayloadView Sub-view
+     */
+    PayloadView subview(size_t offset, size_t length = std::string::npos) const;
+
+    /**
+     * @brief Copy the viewed bytes into a string
+     * 
+     * @return std::string Copy of the payload
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Get the viewed bytes as one contiguous range
+     * 
+     * Joins a segmented view on first use.
+     */
+    std::string_view view() const {
+        return std::string_view(data(), size_);
+    }
+
+    const char* data() const {
+        return chain_ ? joinedData() : data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Check whether the bytes are in one range, so data() does not join them
+     */
+    bool contiguous() const {
+        return !chain_;
+    }
+
+    /**
+     * @brief Get the number of segments; 1 for a non-empty contiguous view
+     */
+    size_t segmentCount() const;
+
+    /**
+     * @brief Get one segment of the viewed bytes without joining them
+     * 
+     * @param index Segment index, less than segmentCount()
+     * @return std::string_view Bytes of the segment
+     */
+    std::string_view segment(size_t index) const;
+
+private:
+    struct Chain;
+
+    PayloadView(std::shared_ptr<const void> owner, const char* data, size_t size)
+        : owner_(std::move(owner)), data_(data), size_(size) {}
+
+    explicit PayloadView(std::shared_ptr<Chain> chain);
+
+    const char* joinedData() const;
+
+    std::shared_ptr<const void> owner_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::shared_ptr<Chain> chain_;   // Set for segmented views; owner_ and data_ are unused then
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,120 @@
+#include "orchestrator/communication/remote_step_runner.h"
+#include "orchestrator/workflow/result_codec.h"
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+namespace {
+
+integration::ExecutionResult failure(const std::string& errorMessage) {
+    integration::ExecutionResult result{};
+    result.success = false;
+    result.errorMessage = errorMessage;
+    return result;
+}
+
+// Releases the step's tokens however the step ends
+class AllocationGuard {
+public:
+    AllocationGuard(resources::TokenBucketResourceManager* manager, std::string allocationId)
+        : manager_(manager), allocationId_(std::move(allocationId)) {}
+
+    ~AllocationGuard() {
+        if (manager_ && !allocationId_.empty()) {
+            manager_->releaseResources(allocationId_);
+        }
+    }
+
+    AllocationGuard(const AllocationGuard&) = delete;
+    AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+private:
+    resources::TokenBucketResourceManager* manager_;
+    std::string allocationId_;
+};
+
+} // namespace
+
+RemoteStepRunner::RemoteStepRunner(std::shared_ptr<GrpcCommunicationProtocol> protocol, std::string senderId,
+                                   std::shared_ptr<resources::TokenBucketResourceManager> resources)
+    : protocol_(std::move(protocol)), senderId_(std::move(senderId)), resources_(std::move(resources)) {}
+
+void RemoteStepRunner::setResourceNeed(const std::string& agentType, const ResourceNeed& need) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    needs_[agentType] = need;
+}
+
+bool RemoteStepRunner::resourceNeedFor(const std::string& agentType, ResourceNeed& need) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = needs_.find(agentType);
+    if (it == needs_.end()) {
+        return false;
+    }
+    need = it->second;
+    return true;
+}
+
+workflow::WorkflowExecutor::StepRunner RemoteStepRunner::stepRunner() {
+    return [this](const workflow::WorkflowExecutor::StepInvocation& invocation) {
+        return run(invocation);
+    };
+}
+
+integration::ExecutionResult RemoteStepRunner::run(const workflow::WorkflowExecutor::StepInvocation& invocation) {
+    const auto& step = *invocation.step;
+    const std::string& receiverId = invocation.agentId.empty() ? step.agentType : invocation.agentId;
+
+    std::string allocationId;
+    ResourceNeed need;
+    if (resources_ && resourceNeedFor(step.agentType, need)) {
+        resources::TokenBucketResourceManager::ResourceRequest request;
+        request.agentId = receiverId;
+        request.resourceType = need.resourceType;
+        request.tokensRequested = need.tokens;
+        request.priority = need.priority;
+        request.timeout = need.maxWait;
+        auto allocation = resources_->acquireResources(request, need.maxWait, invocation.cancellation);
+        if (!allocation.success) {
+            return failure("No " + need.resourceType + " tokens: " + allocation.errorMessage);
+        }
+        allocationId = std::move(allocation.allocationId);
+    }
+    AllocationGuard guard(resources_.get(), std::move(allocationId));
+
+    workflow::StepRequest request;
+    request.executionId = invocation.executionId;
+    request.stepId = step.stepId;
+    request.action = step.action;
+    request.parameters = invocation.parameters;
+    for (const auto* input : invocation.inputs) {
+        request.inputs.push_back(*input);
+    }
+
+    GrpcCommunicationProtocol::AgentMessage message{};
+    message.senderId = senderId_;
+    message.receiverId = receiverId;
+    message.messageType = step.action;
+    message.payload = workflow::ResultCodec::encodeStepRequest(request);
+    message.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    message.correlationId = invocation.executionId + "/" + step.stepId + "/" + std::to_string(invocation.attempt);
+
+    auto response = protocol_->sendMessage(message, invocation.cancellation);
+    if (!response.success) {
+        return failure(response.errorMessage);
+    }
+
+    integration::ExecutionResult result{};
+    bool decoded = response.responseView.empty() ?
+        workflow::ResultCodec::decodeResult(response.responseData, result) :
+        workflow::ResultCodec::decodeResult(response.responseView.toString(), result);
+    if (!decoded) {
+        return failure("Malformed step result from " + receiverId);
+    }
+    return result;
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/resources/token_bucket_manager.h"
+#include "orchestrator/workflow/workflow_executor.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Step runner that sends each workflow step to an agent
+ *
+ * Each step goes to the agent the executor assigned, or to the peer
+ * registered under the step's agentType when none was assigned. The message
+ * type is the step's action and the payload a ResultCodec step request; the
+ * agent answers with ResultCodec::encodeResult(). Steps of agent types with
+ * a resource need first acquire tokens from the resource manager and hold
+ * them until the agent answers.
+ *
+ * The step's cancellation token is passed to both the resource wait and the
+ * RPC, so cancelling the execution or reaching the step's timeout abandons
+ * the wait or cancels the call and releases the tokens at once.
+ */
+class RemoteStepRunner {
+public:
+    /**
+     * @brief Tokens a step of one agent type holds while it runs
+     */
+    struct ResourceNeed {
+        std::string resourceType;
+        int tokens = 1;
+        int priority = 0;
+        std::chrono::milliseconds maxWait{30000};
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param protocol Protocol with client connections to the agents
+     * @param senderId Sender ID put on every message
+     * @param resources Resource manager for steps with a resource need, or nullptr
+     */
+    RemoteStepRunner(std::shared_ptr<GrpcCommunicationProtocol> protocol, std::string senderId,
+                     std::shared_ptr<resources::TokenBucketResourceManager> resources = nullptr);
+
+    RemoteStepRunner(const RemoteStepRunner&) = delete;
+    RemoteStepRunner& operator=(const RemoteStepRunner&) = delete;
+
+    /**
+     * @brief Make steps of an agent type hold tokens while they run
+     *
+     * @param agentType Agent type
+     * @param need Resource type, token count, priority and maximum wait
+     */
+    void setResourceNeed(const std::string& agentType, const ResourceNeed& need);
+
+    /**
+     * @brief Run one step on its agent
+     *
+     * @param invocation Step invocation from the executor
+     * @return integration::ExecutionResult The agent's result, or a failure if
+     *         no tokens were granted, the call failed or it was cancelled
+     */
+    integration::ExecutionResult run(const workflow::WorkflowExecutor::StepInvocation& invocation);
+
+    /**
+     * @brief Get a step runner for a WorkflowExecutor that calls run()
+     *
+     * @return workflow::WorkflowExecutor::StepRunner Runner; this object must outlive the executor
+     */
+    workflow::WorkflowExecutor::StepRunner stepRunner();
+
+private:
+    bool resourceNeedFor(const std::string& agentType, ResourceNeed& need) const;
+
+    std::shared_ptr<GrpcCommunicationProtocol> protocol_;
+    std::string senderId_;
+    std::shared_ptr<resources::TokenBucketResourceManager> resources_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, ResourceNeed> needs_;
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
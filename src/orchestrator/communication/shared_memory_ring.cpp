@@ -0,0 +1,254 @@
+#include "orchestrator/communication/shared_memory_ring.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x4450524e47303031ULL;   // "DPRNG001"
+constexpr size_t kAlignment = 64;
+
+enum BlockState : uint32_t {
+    kBlockUsed = 1,       // Written, waiting for the receiver
+    kBlockReading = 2,    // Receiver is copying it out
+    kBlockReleased = 3,   // Free to reclaim
+    kBlockPadding = 4     // Filler before a wrap to offset zero
+};
+
+struct SegmentHeader {
+    uint64_t magic;
+    uint64_t capacity;
+};
+
+struct BlockHeader {
+    std::atomic<uint32_t> state;
+    uint32_t reserved;
+    uint64_t size;            // Whole block, header included
+    int64_t allocatedAtMs;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Ring blocks need address-free atomics");
+
+constexpr size_t kDataOffset = (sizeof(SegmentHeader) + kAlignment - 1) / kAlignment * kAlignment;
+constexpr size_t kBlockHeaderSize = (sizeof(BlockHeader) + kAlignment - 1) / kAlignment * kAlignment;
+
+size_t alignUp(size_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BlockHeader* blockAt(uint8_t* data, uint64_t offset) {
+    return reinterpret_cast<BlockHeader*>(data + offset);
+}
+
+// Read-side mappings of other processes' rings, kept for the life of the process
+struct Mapping {
+    uint8_t* base = nullptr;
+    size_t size = 0;
+};
+
+std::mutex mappingsMutex;
+std::unordered_map<std::string, Mapping> mappings;
+
+bool mapSegment(const std::string& name, Mapping* mapping) {
+    std::lock_guard<std::mutex> lock(mappingsMutex);
+    auto it = mappings.find(name);
+    if (it != mappings.end()) {
+        *mapping = it->second;
+        return true;
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kDataOffset) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    auto* header = static_cast<SegmentHeader*>(base);
+    if (header->magic != kSegmentMagic || header->capacity + kDataOffset > size) {
+        munmap(base, size);
+        return false;
+    }
+
+    Mapping result{static_cast<uint8_t*>(base), size};
+    mappings[name] = result;
+    *mapping = result;
+    return true;
+}
+
+} // namespace
+
+SharedMemoryRing* SharedMemoryRing::local() {
+    static std::unique_ptr<SharedMemoryRing> ring(create(kDefaultCapacity));
+    return ring.get();
+}
+
+SharedMemoryRing* SharedMemoryRing::create(size_t capacity) {
+    // The nonce keeps a reused pid from aliasing a stale mapping in a peer
+    std::random_device random;
+    std::string name = "/dist_prompt-" + std::to_string(getpid()) + "-" + std::to_string(random());
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    size_t size = kDataOffset + capacity;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    auto* header = static_cast<SegmentHeader*>(base);
+    header->magic = kSegmentMagic;
+    header->capacity = capacity;
+    return new SharedMemoryRing(std::move(name), static_cast<uint8_t*>(base), capacity);
+}
+
+SharedMemoryRing::SharedMemoryRing(std::string name, uint8_t* base, size_t capacity)
+    : name_(std::move(name)), base_(base), capacity_(capacity) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+    munmap(base_, kDataOffset + capacity_);
+    shm_unlink(name_.c_str());
+}
+
+void SharedMemoryRing::reclaim() {
+    uint8_t* data = base_ + kDataOffset;
+    int64_t now = steadyMillis();
+    while (used_ > 0) {
+        BlockHeader* block = blockAt(data, tail_);
+        uint32_t state = block->state.load(std::memory_order_acquire);
+        if (state == kBlockUsed && now - block->allocatedAtMs > kBlockLeaseMs) {
+            // Receiver never came for it; take it back unless a read just started
+            if (block->state.compare_exchange_strong(state, kBlockReleased, std::memory_order_acq_rel)) {
+                state = kBlockReleased;
+            }
+        }
+        if (state != kBlockReleased && state != kBlockPadding) {
+            break;
+        }
+
+        used_ -= block->size;
+        tail_ = (tail_ + block->size) % capacity_;
+    }
+
+    if (used_ == 0) {
+        head_ = tail_ = 0;
+    }
+}
+
+bool SharedMemoryRing::write(const char* data, size_t size, Reference* reference) {
+    size_t blockSize = kBlockHeaderSize + alignUp(size);
+    if (blockSize > capacity_ / 2) {
+        return false;
+    }
+
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reclaim();
+
+        uint8_t* area = base_ + kDataOffset;
+        size_t toEnd = capacity_ - head_;
+        size_t padding = 0;
+        if (blockSize > toEnd) {
+            // Wrap; the tail of the data area becomes a padding block
+            padding = toEnd;
+        }
+        if (used_ + padding + blockSize > capacity_) {
+            return false;
+        }
+
+        if (padding > 0) {
+            BlockHeader* pad = blockAt(area, head_);
+            pad->size = padding;
+            pad->allocatedAtMs = 0;
+            pad->state.store(kBlockPadding, std::memory_order_release);
+            used_ += padding;
+            head_ = 0;
+        }
+
+        offset = head_;
+        BlockHeader* block = blockAt(area, offset);
+        block->size = blockSize;
+        block->allocatedAtMs = steadyMillis();
+        std::memcpy(area + offset + kBlockHeaderSize, data, size);
+        block->state.store(kBlockUsed, std::memory_order_release);
+
+        used_ += blockSize;
+        head_ = (head_ + blockSize) % capacity_;
+    }
+
+    reference->segment = name_;
+    reference->offset = offset;
+    reference->length = size;
+    return true;
+}
+
+bool SharedMemoryRing::read(const Reference& reference, std::string* out) {
+    Mapping mapping;
+    if (!mapSegment(reference.segment, &mapping)) {
+        return false;
+    }
+
+    size_t capacity = mapping.size - kDataOffset;
+    if (reference.offset % kAlignment != 0 || reference.offset + kBlockHeaderSize > capacity ||
+        reference.length > capacity - reference.offset - kBlockHeaderSize) {
+        return false;
+    }
+
+    uint8_t* area = mapping.base + kDataOffset;
+    BlockHeader* block = blockAt(area, reference.offset);
+    uint32_t expected = kBlockUsed;
+    if (!block->state.compare_exchange_strong(expected, kBlockReading, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    bool valid = block->size >= kBlockHeaderSize + reference.length;
+    if (valid) {
+        out->assign(reinterpret_cast<const char*>(area + reference.offset + kBlockHeaderSize),
+                    reference.length);
+    }
+    block->state.store(kBlockReleased, std::memory_order_release);
+    return valid;
+}
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
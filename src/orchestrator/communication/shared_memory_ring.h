@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace communication {
+
+/**
+ * @brief Process-owned POSIX shared-memory ring for large payloads to same-host peers
+ * 
+ * The owning process copies a payload into a block of its ring and sends only
+ * a reference; the receiving process maps the ring by name, copies the bytes
+ * out and marks the block released. The owner reclaims released blocks in
+ * order, and blocks whose receiver never showed up after kBlockLease.
+ * 
+ * Only used on unix: connections, where both ends are known to share a host.
+ */
+class SharedMemoryRing {
+public:
+    /**
+     * @brief Location of a payload in some process's ring
+     */
+    struct Reference {
+        std::string segment;
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    // Payloads smaller than this are cheaper to send inline
+    static constexpr size_t kMinPayloadSize = 64 * 1024;
+
+    static constexpr size_t kDefaultCapacity = 64 * 1024 * 1024;
+    static constexpr int64_t kBlockLeaseMs = 60 * 1000;
+
+    /**
+     * @brief Get this process's ring, creating it on first use
+     * 
+     * @return SharedMemoryRing* Ring, or nullptr if shared memory is unavailable
+     */
+    static SharedMemoryRing* local();
+
+    /**
+     * @brief Copy a payload into the ring
+     * 
+     * @param data Payload bytes
+     * @param size Payload size
+     * @param reference Output reference to send to the receiver
+     * @return bool False if the ring has no room; the caller sends inline
+     */
+    bool write(const char* data, size_t size, Reference* reference);
+
+    /**
+     * @brief Copy a payload out of a (possibly foreign) ring and release its block
+     * 
+     * @param reference Reference received from the owner
+     * @param out Output payload
+     * @return bool False if the reference is invalid or already released
+     */
+    static bool read(const Reference& reference, std::string* out);
+
+    ~SharedMemoryRing();
+
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+private:
+    SharedMemoryRing(std::string name, uint8_t* base, size_t capacity);
+
+    static SharedMemoryRing* create(size_t capacity);
+
+    // Caller holds mutex_
+    void reclaim();
+
+    std::string name_;
+    uint8_t* base_;
+    size_t capacity_;   // Size of the data area
+
+    std::mutex mutex_;
+    uint64_t head_ = 0;   // Next allocation offset in the data area
+    uint64_t tail_ = 0;   // Oldest block not yet reclaimed
+    uint64_t used_ = 0;   // Bytes between tail and head, including wrap padding
+};
+
+} // namespace communication
+} // namespace orchestrator
+} // namespace dist_prompt
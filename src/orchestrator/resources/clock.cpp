@@ -0,0 +1,69 @@
+#include "orchestrator/resources/clock.h"
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace resources {
+
+// SystemClock implementation
+
+Clock::TimePoint SystemClock::now() const {
+    return std::chrono::system_clock::now();
+}
+
+void SystemClock::sleepUntil(TimePoint deadline, const std::function<bool()>& interrupted) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_until(lock, deadline, [&interrupted]() { return interrupted(); });
+}
+
+void SystemClock::wakeAll() {
+    // Taking the mutex orders this notification after any predicate check in progress
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_all();
+}
+
+// VirtualClock implementation
+
+VirtualClock::VirtualClock(TimePoint origin)
+    : ticks_(origin.time_since_epoch().count()) {}
+
+Clock::TimePoint VirtualClock::now() const {
+    return TimePoint(Duration(ticks_.load(std::memory_order_acquire)));
+}
+
+void VirtualClock::sleepUntil(TimePoint deadline, const std::function<bool()>& interrupted) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return now() >= deadline || interrupted(); });
+}
+
+void VirtualClock::wakeAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_all();
+}
+
+void VirtualClock::advance(Duration delta) {
+    if (delta <= Duration::zero()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ticks_.fetch_add(delta.count(), std::memory_order_acq_rel);
+    }
+    cv_.notify_all();
+}
+
+void VirtualClock::advanceTo(TimePoint target) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Duration::rep targetTicks = target.time_since_epoch().count();
+        if (targetTicks <= ticks_.load(std::memory_order_acquire)) {
+            return;
+        }
+        ticks_.store(targetTicks, std::memory_order_release);
+    }
+    cv_.notify_all();
+}
+
+} // namespace resources
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace resources {
+
+/**
+ * @brief Time source used by the resource manager
+ *
+ * Abstracts "now" and "sleep" so that refill and expiry behaviour can be driven
+ * either by the wall clock or by a virtual clock in simulations.
+ */
+class Clock {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+    using Duration = std::chrono::system_clock::duration;
+
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Get the current time
+     *
+     * @return TimePoint Current time according to this clock
+     */
+    virtual TimePoint now() const = 0;
+
+    /**
+     * @brief Block until the clock reaches a deadline or the sleep is interrupted
+     *
+     * @param deadline Time point to sleep until
+     * @param interrupted Predicate checked on every wake-up; returning true ends the sleep
+     */
+    virtual void sleepUntil(TimePoint deadline, const std::function<bool()>& interrupted) = 0;
+
+    /**
+     * @brief Wake all sleepers so they re-evaluate their interrupt predicate
+     */
+    virtual void wakeAll() = 0;
+};
+
+/**
+ * @brief Clock backed by std::chrono::system_clock
+ */
+class SystemClock : public Clock {
+public:
+    TimePoint now() const override;
+    void sleepUntil(TimePoint deadline, const std::function<bool()>& interrupted) override;
+    void wakeAll() override;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+/**
+ * @brief Manually advanced clock for deterministic simulations
+ *
+ * Time only moves when advance() or advanceTo() is called, so a trace spanning
+ * hours of virtual time can be replayed in milliseconds of wall time.
+ */
+class VirtualClock : public Clock {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param origin Initial virtual time (defaults to the system_clock epoch)
+     */
+    explicit VirtualClock(TimePoint origin = TimePoint());
+
+    TimePoint now() const override;
+    void sleepUntil(TimePoint deadline, const std::function<bool()>& interrupted) override;
+    void wakeAll() override;
+
+    /**
+     * @brief Move virtual time forward
+     *
+     * @param delta Amount of virtual time to advance (negative values are ignored)
+     */
+    void advance(Duration delta);
+
+    /**
+     * @brief Move virtual time forward to a given point
+     *
+     * @param target Target time; ignored if it lies in the past
+     */
+    void advanceTo(TimePoint target);
+
+private:
+    std::atomic<Duration::rep> ticks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+} // namespace resources
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,273 @@
+#include "orchestrator/resources/load_simulator.h"
+#include "orchestrator/resources/clock.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace resources {
+
+namespace {
+
+// Per-agent bookkeeping used for the fairness computation
+struct AgentTally {
+    long tokensRequested = 0;
+    long tokensGranted = 0;
+};
+
+// Pending release of a granted allocation, ordered by release time
+struct PendingRelease {
+    Clock::TimePoint releaseTime;
+    std::string allocationId;
+
+    bool operator>(const PendingRelease& other) const {
+        return releaseTime > other.releaseTime;
+    }
+};
+
+std::vector<std::string> splitCsvLine(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+double jainFairnessIndex(const std::map<std::string, double>& values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    for (const auto& [agentId, value] : values) {
+        sum += value;
+        sumOfSquares += value * value;
+    }
+
+    if (sumOfSquares <= 0.0) {
+        return 0.0;
+    }
+
+    return (sum * sum) / (static_cast<double>(values.size()) * sumOfSquares);
+}
+
+} // namespace
+
+std::vector<ResourceLoadSimulator::TraceEvent> ResourceLoadSimulator::generateSyntheticTrace(
+    const SyntheticTraceConfig& config) {
+    std::vector<TraceEvent> trace;
+    if (config.agentCount <= 0 || config.resourceTypes.empty() || config.requestsPerSecond <= 0.0) {
+        return trace;
+    }
+
+    std::mt19937 gen(config.seed);
+    std::exponential_distribution<double> interArrival(config.requestsPerSecond);
+    std::uniform_int_distribution<int> tokens(config.minTokens, std::max(config.minTokens, config.maxTokens));
+    std::uniform_int_distribution<size_t> resource(0, config.resourceTypes.size() - 1);
+
+    double meanHoldSeconds = std::chrono::duration<double>(config.meanHoldTime).count();
+    std::exponential_distribution<double> hold(meanHoldSeconds > 0.0 ? 1.0 / meanHoldSeconds : 1.0);
+
+    // Zipf-like agent popularity: weight(k) = 1 / (k + 1)^skew
+    std::vector<double> weights;
+    weights.reserve(config.agentCount);
+    for (int k = 0; k < config.agentCount; ++k) {
+        weights.push_back(1.0 / std::pow(static_cast<double>(k + 1), config.agentSkew));
+    }
+    std::discrete_distribution<int> agent(weights.begin(), weights.end());
+
+    double durationSeconds = std::chrono::duration<double>(config.duration).count();
+    trace.reserve(static_cast<size_t>(durationSeconds * config.requestsPerSecond * 1.1));
+
+    double t = interArrival(gen);
+    while (t < durationSeconds) {
+        TraceEvent event;
+        event.offset = std::chrono::microseconds(static_cast<int64_t>(t * 1e6));
+        event.agentId = "agent-" + std::to_string(agent(gen));
+        event.resourceType = config.resourceTypes[resource(gen)];
+        event.tokensRequested = tokens(gen);
+        event.priority = 0;
+        event.holdTime = meanHoldSeconds > 0.0 ?
+            std::chrono::microseconds(static_cast<int64_t>(hold(gen) * 1e6)) :
+            std::chrono::microseconds(0);
+        trace.push_back(std::move(event));
+
+        t += interArrival(gen);
+    }
+
+    return trace;
+}
+
+std::vector<ResourceLoadSimulator::TraceEvent> ResourceLoadSimulator::loadTrace(const std::string& path) {
+    std::vector<TraceEvent> trace;
+    std::ifstream in(path);
+    if (!in) {
+        return trace;
+    }
+
+    std::string line;
+    bool firstLine = true;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        auto fields = splitCsvLine(line);
+        if (fields.size() < 6) {
+            return {};
+        }
+
+        try {
+            TraceEvent event;
+            event.offset = std::chrono::microseconds(std::stoll(fields[0]));
+            event.agentId = fields[1];
+            event.resourceType = fields[2];
+            event.tokensRequested = std::stoi(fields[3]);
+            event.priority = std::stoi(fields[4]);
+            event.holdTime = std::chrono::microseconds(std::stoll(fields[5]));
+            trace.push_back(std::move(event));
+        } catch (const std::exception&) {
+            // Tolerate a header row, reject anything else that does not parse
+            if (!firstLine) {
+                return {};
+            }
+        }
+        firstLine = false;
+    }
+
+    std::stable_sort(trace.begin(), trace.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.offset < b.offset; });
+    return trace;
+}
+
+bool ResourceLoadSimulator::saveTrace(const std::string& path, const std::vector<TraceEvent>& trace) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << "offset_us,agent_id,resource_type,tokens,priority,hold_us\n";
+    for (const auto& event : trace) {
+        out << event.offset.count() << ',' << event.agentId << ',' << event.resourceType << ','
+            << event.tokensRequested << ',' << event.priority << ',' << event.holdTime.count() << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+ResourceLoadSimulator::SimulationReport ResourceLoadSimulator::run(
+    const Scenario& scenario, const std::vector<TraceEvent>& trace) const {
+    SimulationReport report;
+    report.scenarioName = scenario.name;
+
+    auto clock = std::make_shared<VirtualClock>();
+    TokenBucketResourceManager manager(clock);
+    manager.initialize(scenario.resources);
+    for (const auto& [agentId, quotas] : scenario.agentQuotas) {
+        for (const auto& [resourceType, maxTokens] : quotas) {
+            manager.setAgentQuota(agentId, resourceType, maxTokens);
+        }
+    }
+
+    const Clock::TimePoint origin = clock->now();
+    const auto maintenanceInterval = std::max(scenario.maintenanceInterval, std::chrono::milliseconds(1));
+    Clock::TimePoint nextMaintenance = origin + maintenanceInterval;
+
+    std::priority_queue<PendingRelease, std::vector<PendingRelease>, std::greater<PendingRelease>> releases;
+    std::unordered_map<std::string, AgentTally> tallies;
+
+    // Advance virtual time to `target`, firing releases and maintenance passes in time order
+    auto advanceTo = [&](Clock::TimePoint target) {
+        while (true) {
+            bool releaseDue = !releases.empty() && releases.top().releaseTime <= target;
+            bool maintenanceDue = nextMaintenance <= target;
+            if (!releaseDue && !maintenanceDue) {
+                break;
+            }
+
+            if (releaseDue && (!maintenanceDue || releases.top().releaseTime <= nextMaintenance)) {
+                clock->advanceTo(releases.top().releaseTime);
+                manager.releaseResources(releases.top().allocationId);
+                releases.pop();
+            } else {
+                clock->advanceTo(nextMaintenance);
+                manager.runMaintenance();
+                nextMaintenance += maintenanceInterval;
+            }
+        }
+        clock->advanceTo(target);
+    };
+
+    TokenBucketResourceManager::ResourceRequest request;
+    request.timeout = scenario.allocationTimeout;
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (const auto& event : trace) {
+        advanceTo(origin + event.offset);
+
+        request.agentId = event.agentId;
+        request.resourceType = event.resourceType;
+        request.tokensRequested = event.tokensRequested;
+        request.priority = event.priority;
+
+        AgentTally& tally = tallies[event.agentId];
+        tally.tokensRequested += event.tokensRequested;
+        report.totalRequests++;
+
+        auto result = manager.requestResources(request);
+        if (result.success) {
+            report.grantedRequests++;
+            report.tokensGranted += result.tokensAllocated;
+            tally.tokensGranted += result.tokensAllocated;
+            releases.push({clock->now() + event.holdTime, std::move(result.allocationId)});
+        } else {
+            report.deniedRequests++;
+        }
+    }
+
+    auto wallEnd = std::chrono::steady_clock::now();
+
+    report.virtualSeconds = trace.empty() ? 0.0 :
+        std::chrono::duration<double>(trace.back().offset).count();
+    report.wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    report.denialRate = report.totalRequests > 0 ?
+        static_cast<double>(report.deniedRequests) / report.totalRequests : 0.0;
+    report.throughput = report.virtualSeconds > 0.0 ?
+        report.grantedRequests / report.virtualSeconds : 0.0;
+    report.tokenThroughput = report.virtualSeconds > 0.0 ?
+        report.tokensGranted / report.virtualSeconds : 0.0;
+    report.simulatedRequestsPerSecond = report.wallSeconds > 0.0 ?
+        report.totalRequests / report.wallSeconds : 0.0;
+
+    for (const auto& [agentId, tally] : tallies) {
+        report.agentSatisfaction[agentId] = tally.tokensRequested > 0 ?
+            static_cast<double>(tally.tokensGranted) / tally.tokensRequested : 0.0;
+    }
+    report.fairnessIndex = jainFairnessIndex(report.agentSatisfaction);
+
+    return report;
+}
+
+std::vector<ResourceLoadSimulator::SimulationReport> ResourceLoadSimulator::runAll(
+    const std::vector<Scenario>& scenarios, const std::vector<TraceEvent>& trace) const {
+    std::vector<SimulationReport> reports;
+    reports.reserve(scenarios.size());
+    for (const auto& scenario : scenarios) {
+        reports.push_back(run(scenario, trace));
+    }
+    return reports;
+}
+
+} // namespace resources
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -1,10 +1,12 @@
 #include "orchestrator/resources/token_bucket_manager.h"
 #include <thread>
 #include <condition_variable>
+#include <shared_mutex>
 #include <queue>
 #include <unordered_map>
 #include <algorithm>
 #include <random>
+#include <vector>
 
 namespace dist_prompt {
 namespace orchestrator {
@@ -13,6 +15,17 @@ namespace resources {
 // Private implementation class (PIMPL idiom)
 class TokenBucketResourceManager::Impl {
 public:
+    // Advance booking of tokens for a future window
+    struct Reservation {
+        std::string reservationId;
+        std::string agentId;
+        int tokens;
+        std::chrono::system_clock::time_point startTime;
+        std::chrono::system_clock::time_point expirationTime;
+        std::chrono::milliseconds allocationTimeout;
+        bool active;             // Window open: tokens withheld from immediate requests
+    };
+    
     // Token bucket for a specific resource type
     struct TokenBucket {
         std::string resourceType;
@@ -24,10 +37,52 @@ public:
         std::chrono::system_clock::time_point lastRefill;
         mutable std::mutex mutex;
         
+        // Advance reservations (guarded by mutex)
+        std::unordered_map<std::string, Reservation> reservations;
+        int reservedTokens = 0;  // Sum of tokens held by active reservations
+        std::chrono::system_clock::time_point nextReservationEvent =
+            std::chrono::system_clock::time_point::max();
+        
         // Statistics
         std::atomic<long> totalRequests{0};
         std::atomic<long> successfulRequests{0};
         std::atomic<long> totalTokensDispensed{0};
+        std::atomic<long> cancelledWaits{0};
+        std::atomic<long> timedOutWaits{0};
+    };
+    
+    // Quota and current allocation of one agent for one resource type. The two
+    // counters sit side by side so that the quota check and the increment are a
+    // single compare-and-add on `allocated`.
+    struct LedgerEntry {
+        static constexpr int kUnlimited = -1;
+        
+        std::atomic<int> quota{kUnlimited};
+        std::atomic<int> allocated{0};
+        
+        // Charge tokens against the quota; fails without side effects if it would be exceeded
+        bool tryCharge(int tokens) {
+            int current = allocated.load(std::memory_order_relaxed);
+            do {
+                int limit = quota.load(std::memory_order_acquire);
+                if (limit != kUnlimited && current + tokens > limit) {
+                    return false;
+                }
+            } while (!allocated.compare_exchange_weak(current, current + tokens,
+                                                      std::memory_order_acq_rel,
+                                                      std::memory_order_relaxed));
+            return true;
+        }
+        
+        void refund(int tokens) {
+            allocated.fetch_sub(tokens, std::memory_order_acq_rel);
+        }
+    };
+    
+    // Per-agent ledger. Entries are shared with the allocations charged to them;
+    // an idle entry without a quota is reclaimed once nothing else holds it.
+    struct AgentLedger {
+        std::unordered_map<std::string, std::shared_ptr<LedgerEntry>> entries;  // By resource type
     };
     
     // Active resource allocation
@@ -36,11 +91,14 @@ public:
         std::string agentId;
         std::string resourceType;
         int tokensAllocated;
+        std::shared_ptr<LedgerEntry> ledgerEntry;
         std::chrono::system_clock::time_point allocationTime;
         std::chrono::system_clock::time_point expirationTime;
     };
 
-    Impl() : running_(false), stopRequested_(false) {}
+    explicit Impl(std::shared_ptr<Clock> clock)
+        : clock_(clock ? std::move(clock) : std::make_shared<SystemClock>()),
+          running_(false), stopRequested_(false) {}
     
     ~Impl() {
         stop();
@@ -50,6 +108,10 @@ public:
         std::lock_guard<std::mutex> lock(bucketsMutex_);
         
         buckets_.clear();
+        {
+            std::lock_guard<std::mutex> indexLock(reservationIndexMutex_);
+            reservationIndex_.clear();
+        }
         
         for (const auto& [resourceType, config] : configs) {
             if (!createBucket(config)) {
@@ -82,65 +144,255 @@ public:
         // Update statistics
         bucket.totalRequests++;
         
-        // Check agent quota
-        if (!checkAgentQuota(request.agentId, request.resourceType, request.tokensRequested)) {
-            result.errorMessage = "Agent quota exceeded";
+        tryAllocate(bucket, request, result);
+        return result;
+    }
+    
+    AllocationResult acquireResources(const ResourceRequest& request,
+                                      std::chrono::milliseconds maxWait,
+                                      const CancellationToken& cancellation) {
+        AllocationResult result;
+        result.success = false;
+        result.tokensAllocated = 0;
+        
+        auto bucketIt = buckets_.find(request.resourceType);
+        if (bucketIt == buckets_.end()) {
+            result.errorMessage = "Resource type not found: " + request.resourceType;
+            return result;
+        }
+        
+        TokenBucket& bucket = bucketIt->second;
+        if (request.tokensRequested > bucket.maxTokens) {
+            result.errorMessage = "Request exceeds bucket capacity. Requested: " +
+                                 std::to_string(request.tokensRequested) +
+                                 ", Capacity: " + std::to_string(bucket.maxTokens);
             return result;
         }
         
+        bucket.totalRequests++;
+        
+        // Releases and cancellation wake the sleep below; refills are picked up
+        // once per refill interval
+        waiters_++;
+        CancellationCallback wake(cancellation, [this]() { clock_->wakeAll(); });
+        auto deadline = clock_->now() + maxWait;
+        while (true) {
+            if (cancellation.isCancelled()) {
+                bucket.cancelledWaits++;
+                result.errorMessage = "Cancelled: " + cancellation.reason();
+                break;
+            }
+            
+            uint64_t generation = releaseGeneration_.load(std::memory_order_acquire);
+            if (tryAllocate(bucket, request, result)) {
+                break;
+            }
+            
+            auto now = clock_->now();
+            if (now >= deadline || stopRequested_.load()) {
+                bucket.timedOutWaits++;
+                break;
+            }
+            clock_->sleepUntil(std::min(deadline, now + bucket.refillInterval), [&]() {
+                return releaseGeneration_.load(std::memory_order_acquire) != generation ||
+                       cancellation.isCancelled() || stopRequested_.load();
+            });
+        }
+        waiters_--;
+        
+        return result;
+    }
+    
+    // One allocation attempt without statistics; fills result and returns true on success
+    bool tryAllocate(TokenBucket& bucket, const ResourceRequest& request, AllocationResult& result) {
+        // Charge the agent's quota up front; refunded below if the bucket is short
+        auto ledgerEntry = getLedgerEntry(request.agentId, request.resourceType);
+        if (!ledgerEntry->tryCharge(request.tokensRequested)) {
+            result.errorMessage = "Agent quota exceeded";
+            return false;
+        }
+        
         // Try to allocate tokens
         std::unique_lock<std::mutex> lock(bucket.mutex);
         
         // Refill tokens if needed
         refillBucket(bucket);
+        updateReservations(bucket, clock_->now());
         
-        if (bucket.currentTokens >= request.tokensRequested) {
+        int unreservedTokens = bucket.currentTokens - bucket.reservedTokens;
+        if (unreservedTokens >= request.tokensRequested) {
             // Allocation successful
             bucket.currentTokens -= request.tokensRequested;
-            bucket.successfulRequests++;
-            bucket.totalTokensDispensed += request.tokensRequested;
-            
-            // Create allocation record
-            std::string allocationId = generateAllocationId();
-            Allocation allocation;
-            allocation.allocationId = allocationId;
-            allocation.agentId = request.agentId;
-            allocation.resourceType = request.resourceType;
-            allocation.tokensAllocated = request.tokensRequested;
-            allocation.allocationTime = std::chrono::system_clock::now();
-            allocation.expirationTime = allocation.allocationTime + request.timeout;
-            
-            // Store allocation
-            {
-                std::lock_guard<std::mutex> allocLock(allocationsMutex_);
-                allocations_[allocationId] = allocation;
-                
-                // Update agent allocation tracking
-                agentAllocations_[request.agentId][request.resourceType] += request.tokensRequested;
+            commitAllocation(bucket, request.agentId, ledgerEntry, request.tokensRequested,
+                             request.timeout, result);
+            return true;
+        }
+        
+        ledgerEntry->refund(request.tokensRequested);
+        result.errorMessage = "Insufficient tokens available. Requested: " + 
+                             std::to_string(request.tokensRequested) + 
+                             ", Available: " + std::to_string(std::max(unreservedTokens, 0));
+        return false;
+    }
+    
+    ReservationResult reserveResources(const ReservationRequest& request) {
+        ReservationResult result;
+        result.success = false;
+        
+        auto bucketIt = buckets_.find(request.resourceType);
+        if (bucketIt == buckets_.end()) {
+            result.errorMessage = "Resource type not found: " + request.resourceType;
+            return result;
+        }
+        
+        TokenBucket& bucket = bucketIt->second;
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        
+        auto now = clock_->now();
+        updateReservations(bucket, now);
+        
+        Reservation reservation;
+        reservation.agentId = request.agentId;
+        reservation.tokens = request.tokensRequested;
+        reservation.startTime = std::max(request.startTime, now);
+        reservation.expirationTime = reservation.startTime + request.claimWindow;
+        reservation.allocationTimeout = request.allocationTimeout;
+        reservation.active = false;
+        
+        // Capacity check: everything booked for an overlapping window counts against the bucket
+        int overlappingTokens = 0;
+        for (const auto& [reservationId, other] : bucket.reservations) {
+            if (other.startTime <= reservation.expirationTime &&
+                reservation.startTime <= other.expirationTime) {
+                overlappingTokens += other.tokens;
             }
-            
-            result.success = true;
-            result.tokensAllocated = request.tokensRequested;
-            result.allocationId = allocationId;
-            result.expirationTime = allocation.expirationTime;
-        } else {
-            result.errorMessage = "Insufficient tokens available. Requested: " + 
-                                 std::to_string(request.tokensRequested) + 
-                                 ", Available: " + std::to_string(bucket.currentTokens);
         }
         
+        if (overlappingTokens + reservation.tokens > bucket.maxTokens) {
+            result.errorMessage = "Insufficient capacity for reservation window. Requested: " +
+                                 std::to_string(reservation.tokens) +
+                                 ", Already booked: " + std::to_string(overlappingTokens);
+            return result;
+        }
+        
+        reservation.reservationId = generateAllocationId();
+        bucket.nextReservationEvent = std::min(bucket.nextReservationEvent, reservation.startTime);
+        bucket.reservations[reservation.reservationId] = reservation;
+        {
+            std::lock_guard<std::mutex> indexLock(reservationIndexMutex_);
+            reservationIndex_[reservation.reservationId] = &bucket;
+        }
+        
+        // A window that is already open starts withholding tokens right away
+        updateReservations(bucket, now);
+        
+        result.success = true;
+        result.reservationId = reservation.reservationId;
+        result.startTime = reservation.startTime;
+        result.expirationTime = reservation.expirationTime;
         return result;
     }
     
-    bool releaseResources(const std::string& allocationId) {
-        std::lock_guard<std::mutex> lock(allocationsMutex_);
+    AllocationResult claimReservation(const std::string& reservationId) {
+        AllocationResult result;
+        result.success = false;
+        result.tokensAllocated = 0;
+        
+        TokenBucket* bucket = findReservationBucket(reservationId);
+        if (bucket == nullptr) {
+            result.errorMessage = "Reservation not found or expired: " + reservationId;
+            return result;
+        }
+        
+        std::lock_guard<std::mutex> lock(bucket->mutex);
+        refillBucket(*bucket);
+        updateReservations(*bucket, clock_->now());
+        
+        auto reservationIt = bucket->reservations.find(reservationId);
+        if (reservationIt == bucket->reservations.end()) {
+            result.errorMessage = "Reservation not found or expired: " + reservationId;
+            return result;
+        }
+        
+        const Reservation& reservation = reservationIt->second;
+        bucket->totalRequests++;
+        
+        auto ledgerEntry = getLedgerEntry(reservation.agentId, bucket->resourceType);
+        if (!ledgerEntry->tryCharge(reservation.tokens)) {
+            result.errorMessage = "Agent quota exceeded";
+            return result;
+        }
+        
+        // An active reservation draws on its own withheld tokens but not on those
+        // withheld for other active reservations; an early claim has to fit in
+        // the unreserved pool like an immediate request
+        int usableTokens = reservation.active ?
+            bucket->currentTokens - (bucket->reservedTokens - reservation.tokens) :
+            bucket->currentTokens - bucket->reservedTokens;
+        if (usableTokens < reservation.tokens) {
+            ledgerEntry->refund(reservation.tokens);
+            result.errorMessage = "Reserved tokens not yet available. Requested: " +
+                                 std::to_string(reservation.tokens) +
+                                 ", Available: " + std::to_string(std::max(usableTokens, 0));
+            return result;
+        }
+        
+        bucket->currentTokens -= reservation.tokens;
+        if (reservation.active) {
+            bucket->reservedTokens -= reservation.tokens;
+        }
+        
+        commitAllocation(*bucket, reservation.agentId, ledgerEntry, reservation.tokens,
+                         reservation.allocationTimeout, result);
+        eraseReservation(*bucket, reservationIt);
+        return result;
+    }
+    
+    bool cancelReservation(const std::string& reservationId) {
+        TokenBucket* bucket = findReservationBucket(reservationId);
+        if (bucket == nullptr) {
+            return false;
+        }
         
-        auto allocIt = allocations_.find(allocationId);
-        if (allocIt == allocations_.end()) {
+        std::lock_guard<std::mutex> lock(bucket->mutex);
+        auto reservationIt = bucket->reservations.find(reservationId);
+        if (reservationIt == bucket->reservations.end()) {
             return false;
         }
         
-        const Allocation& allocation = allocIt->second;
+        if (reservationIt->second.active) {
+            bucket->reservedTokens -= reservationIt->second.tokens;
+        }
+        eraseReservation(*bucket, reservationIt);
+        return true;
+    }
+    
+    int getReservedTokens(const std::string& resourceType) const {
+        auto bucketIt = buckets_.find(resourceType);
+        if (bucketIt == buckets_.end()) {
+            return 0;
+        }
+        
+        const TokenBucket& bucket = bucketIt->second;
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        return bucket.reservedTokens;
+    }
+    
+    bool releaseResources(const std::string& allocationId) {
+        // Detach the record first so allocationsMutex_ is never held while taking a
+        // bucket mutex (commitAllocation() nests them the other way round)
+        Allocation allocation;
+        {
+            std::lock_guard<std::mutex> lock(allocationsMutex_);
+            
+            auto allocIt = allocations_.find(allocationId);
+            if (allocIt == allocations_.end()) {
+                return false;
+            }
+            
+            allocation = std::move(allocIt->second);
+            allocations_.erase(allocIt);
+        }
         
         // Return tokens to bucket
         auto bucketIt = buckets_.find(allocation.resourceType);
@@ -153,16 +405,12 @@ public:
         }
         
         // Update agent allocation tracking
-        agentAllocations_[allocation.agentId][allocation.resourceType] -= allocation.tokensAllocated;
-        if (agentAllocations_[allocation.agentId][allocation.resourceType] <= 0) {
-            agentAllocations_[allocation.agentId].erase(allocation.resourceType);
-            if (agentAllocations_[allocation.agentId].empty()) {
-                agentAllocations_.erase(allocation.agentId);
-            }
-        }
+        allocation.ledgerEntry->refund(allocation.tokensAllocated);
         
-        // Remove allocation
-        allocations_.erase(allocIt);
+        releaseGeneration_.fetch_add(1, std::memory_order_acq_rel);
+        if (waiters_.load() > 0) {
+            clock_->wakeAll();
+        }
         
         return true;
     }
@@ -175,7 +423,7 @@ public:
         
         const TokenBucket& bucket = bucketIt->second;
         std::lock_guard<std::mutex> lock(bucket.mutex);
-        return bucket.currentTokens;
+        return std::max(bucket.currentTokens - bucket.reservedTokens, 0);
     }
     
     std::map<std::string, double> getResourceStats(const std::string& resourceType) const {
@@ -199,6 +447,10 @@ public:
         stats["total_tokens_dispensed"] = static_cast<double>(bucket.totalTokensDispensed.load());
         stats["current_tokens"] = static_cast<double>(bucket.currentTokens);
         stats["max_tokens"] = static_cast<double>(bucket.maxTokens);
+        stats["reserved_tokens"] = static_cast<double>(bucket.reservedTokens);
+        stats["pending_reservations"] = static_cast<double>(bucket.reservations.size());
+        stats["cancelled_waits"] = static_cast<double>(bucket.cancelledWaits.load());
+        stats["timed_out_waits"] = static_cast<double>(bucket.timedOutWaits.load());
         stats["utilization"] = bucket.maxTokens > 0 ? 
             1.0 - (static_cast<double>(bucket.currentTokens) / bucket.maxTokens) : 0.0;
         
@@ -208,26 +460,38 @@ public:
     bool setAgentQuota(const std::string& agentId, 
                       const std::string& resourceType, 
                       int maxTokens) {
-        std::lock_guard<std::mutex> lock(quotasMutex_);
-        agentQuotas_[agentId][resourceType] = maxTokens;
+        getLedgerEntry(agentId, resourceType)->quota.store(maxTokens, std::memory_order_release);
         return true;
     }
     
     int getAgentAllocation(const std::string& agentId, 
                           const std::string& resourceType) const {
-        std::lock_guard<std::mutex> lock(allocationsMutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgersMutex_);
         
-        auto agentIt = agentAllocations_.find(agentId);
-        if (agentIt == agentAllocations_.end()) {
+        auto agentIt = ledgers_.find(agentId);
+        if (agentIt == ledgers_.end()) {
             return 0;
         }
         
-        auto resourceIt = agentIt->second.find(resourceType);
-        if (resourceIt == agentIt->second.end()) {
+        auto resourceIt = agentIt->second.entries.find(resourceType);
+        if (resourceIt == agentIt->second.entries.end()) {
             return 0;
         }
         
-        return resourceIt->second;
+        return resourceIt->second->allocated.load(std::memory_order_acquire);
+    }
+    
+    void runMaintenance() {
+        {
+            std::lock_guard<std::mutex> lock(bucketsMutex_);
+            for (auto& [resourceType, bucket] : buckets_) {
+                std::lock_guard<std::mutex> bucketLock(bucket.mutex);
+                refillBucket(bucket);
+                updateReservations(bucket, clock_->now());
+            }
+        }
+        
+        releaseExpiredAllocations();
     }
     
     bool start() {
@@ -249,6 +513,7 @@ public:
         }
         
         stopRequested_ = true;
+        clock_->wakeAll();
         
         if (refillThread_.joinable()) {
             refillThread_.join();
@@ -266,15 +531,29 @@ public:
     }
 
 private:
+    static constexpr std::chrono::milliseconds kRefillPeriod{100};
+    static constexpr std::chrono::seconds kCleanupPeriod{5};
+    
+    std::shared_ptr<Clock> clock_;
+    
     std::unordered_map<std::string, TokenBucket> buckets_;
     mutable std::mutex bucketsMutex_;
     
     std::unordered_map<std::string, Allocation> allocations_;
     mutable std::mutex allocationsMutex_;
     
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> agentAllocations_;
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> agentQuotas_;
-    mutable std::mutex quotasMutex_;
+    // Reservation ID -> bucket holding it; lets claims and cancels skip a scan of
+    // all buckets. Taken after a bucket mutex, never before one.
+    std::unordered_map<std::string, TokenBucket*> reservationIndex_;
+    std::mutex reservationIndexMutex_;
+    
+    // Agent ID -> ledger; the lock only guards the table shape, counters are atomic
+    std::unordered_map<std::string, AgentLedger> ledgers_;
+    mutable std::shared_mutex ledgersMutex_;
+    
+    // Bumped on every release so acquireResources() waiters retry
+    std::atomic<uint64_t> releaseGeneration_{0};
+    std::atomic<int> waiters_{0};
     
     std::atomic<bool> running_;
     std::atomic<bool> stopRequested_;
@@ -282,21 +561,119 @@ private:
     std::thread cleanupThread_;
     
     bool createBucket(const ResourceConfig& config) {
-        TokenBucket bucket;
+        // Buckets hold a mutex and atomics, so they are (re)initialized in place
+        TokenBucket& bucket = buckets_[config.resourceType];
+        std::lock_guard<std::mutex> bucketLock(bucket.mutex);
+        
         bucket.resourceType = config.resourceType;
         bucket.maxTokens = config.maxTokens;
         bucket.currentTokens = config.maxTokens;  // Start full
         bucket.refillRate = config.refillRate;
         bucket.burstSize = config.burstSize;
         bucket.refillInterval = config.refillInterval;
-        bucket.lastRefill = std::chrono::system_clock::now();
+        bucket.lastRefill = clock_->now();
+        bucket.totalRequests = 0;
+        bucket.successfulRequests = 0;
+        bucket.totalTokensDispensed = 0;
+        {
+            std::lock_guard<std::mutex> indexLock(reservationIndexMutex_);
+            for (const auto& [reservationId, reservation] : bucket.reservations) {
+                reservationIndex_.erase(reservationId);
+            }
+        }
+        bucket.reservations.clear();
+        bucket.reservedTokens = 0;
+        bucket.nextReservationEvent = std::chrono::system_clock::time_point::max();
         
-        buckets_[config.resourceType] = bucket;
         return true;
     }
     
+    // Records a successful allocation; caller holds bucket.mutex and has already taken the tokens
+    void commitAllocation(TokenBucket& bucket,
+                          const std::string& agentId,
+                          const std::shared_ptr<LedgerEntry>& ledgerEntry,
+                          int tokens,
+                          std::chrono::milliseconds timeout,
+                          AllocationResult& result) {
+        bucket.successfulRequests++;
+        bucket.totalTokensDispensed += tokens;
+        
+        // Create allocation record
+        std::string allocationId = generateAllocationId();
+        Allocation allocation;
+        allocation.allocationId = allocationId;
+        allocation.agentId = agentId;
+        allocation.resourceType = bucket.resourceType;
+        allocation.tokensAllocated = tokens;
+        allocation.ledgerEntry = ledgerEntry;
+        allocation.allocationTime = clock_->now();
+        allocation.expirationTime = allocation.allocationTime + timeout;
+        
+        result.success = true;
+        result.tokensAllocated = tokens;
+        result.allocationId = allocationId;
+        result.expirationTime = allocation.expirationTime;
+        
+        // Store allocation
+        {
+            std::lock_guard<std::mutex> allocLock(allocationsMutex_);
+            allocations_.emplace(std::move(allocationId), std::move(allocation));
+        }
+    }
+    
+    // Opens reservation windows that have started and drops unclaimed ones that have
+    // closed; caller holds bucket.mutex
+    void updateReservations(TokenBucket& bucket, std::chrono::system_clock::time_point now) {
+        if (now < bucket.nextReservationEvent) {
+            return;
+        }
+        
+        auto nextEvent = std::chrono::system_clock::time_point::max();
+        auto it = bucket.reservations.begin();
+        while (it != bucket.reservations.end()) {
+            Reservation& reservation = it->second;
+            
+            if (now > reservation.expirationTime) {
+                if (reservation.active) {
+                    bucket.reservedTokens -= reservation.tokens;
+                }
+                it = eraseReservation(bucket, it);
+                continue;
+            }
+            
+            if (!reservation.active && now >= reservation.startTime) {
+                reservation.active = true;
+                bucket.reservedTokens += reservation.tokens;
+            }
+            
+            nextEvent = std::min(nextEvent, reservation.active ?
+                reservation.expirationTime + std::chrono::system_clock::duration(1) :
+                reservation.startTime);
+            ++it;
+        }
+        
+        bucket.nextReservationEvent = nextEvent;
+    }
+    
+    // The bucket is only a hint; callers re-check the reservation under its mutex
+    TokenBucket* findReservationBucket(const std::string& reservationId) {
+        std::lock_guard<std::mutex> lock(reservationIndexMutex_);
+        auto it = reservationIndex_.find(reservationId);
+        return it != reservationIndex_.end() ? it->second : nullptr;
+    }
+    
+    // Drops a reservation and its index entry; caller holds bucket.mutex
+    std::unordered_map<std::string, Reservation>::iterator eraseReservation(
+        TokenBucket& bucket, std::unordered_map<std::string, Reservation>::iterator it) {
+        {
+            std::lock_guard<std::mutex> lock(reservationIndexMutex_);
+            reservationIndex_.erase(it->first);
+        }
+        return bucket.reservations.erase(it);
+    }
+    
     void refillBucket(TokenBucket& bucket) {
-        auto now = std::chrono::system_clock::now();
+        auto now = clock_->now();
         auto timeSinceLastRefill = std::chrono::duration_cast<std::chrono::milliseconds>(
             now - bucket.lastRefill);
         
@@ -316,38 +693,59 @@ private:
         }
     }
     
-    bool checkAgentQuota(const std::string& agentId, 
-                        const std::string& resourceType, 
-                        int requestedTokens) {
-        std::lock_guard<std::mutex> lock(quotasMutex_);
-        
-        auto agentIt = agentQuotas_.find(agentId);
-        if (agentIt == agentQuotas_.end()) {
-            return true;  // No quota set
+    // Finds or creates the ledger entry; the common case only takes the shared lock
+    std::shared_ptr<LedgerEntry> getLedgerEntry(const std::string& agentId, const std::string& resourceType) {
+        {
+            std::shared_lock<std::shared_mutex> lock(ledgersMutex_);
+            auto agentIt = ledgers_.find(agentId);
+            if (agentIt != ledgers_.end()) {
+                auto resourceIt = agentIt->second.entries.find(resourceType);
+                if (resourceIt != agentIt->second.entries.end()) {
+                    return resourceIt->second;
+                }
+            }
         }
         
-        auto resourceIt = agentIt->second.find(resourceType);
-        if (resourceIt == agentIt->second.end()) {
-            return true;  // No quota for this resource type
+        std::unique_lock<std::shared_mutex> lock(ledgersMutex_);
+        auto& entry = ledgers_[agentId].entries[resourceType];
+        if (!entry) {
+            entry = std::make_shared<LedgerEntry>();
         }
-        
-        int currentAllocation = getAgentAllocation(agentId, resourceType);
-        return (currentAllocation + requestedTokens) <= resourceIt->second;
+        return entry;
     }
     
-    std::string generateAllocationId() {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<> dis(0, 15);
-        
-        std::string id;
-        for (int i = 0; i < 16; ++i) {
-            int val = dis(gen);
-            if (val < 10) {
-                id += ('0' + val);
-            } else {
-                id += ('a' + val - 10);
+    // Drops entries that carry no state: no quota, nothing allocated, and no
+    // reference outside the table. References are only handed out under the
+    // shared lock, so with the exclusive lock held the use count cannot grow.
+    void reclaimIdleLedgerEntries() {
+        std::unique_lock<std::shared_mutex> lock(ledgersMutex_);
+        for (auto agentIt = ledgers_.begin(); agentIt != ledgers_.end();) {
+            auto& entries = agentIt->second.entries;
+            for (auto entryIt = entries.begin(); entryIt != entries.end();) {
+                const auto& entry = entryIt->second;
+                if (entry.use_count() == 1 &&
+                    entry->quota.load(std::memory_order_acquire) == LedgerEntry::kUnlimited &&
+                    entry->allocated.load(std::memory_order_acquire) == 0) {
+                    entryIt = entries.erase(entryIt);
+                } else {
+                    ++entryIt;
+                }
             }
+            agentIt = entries.empty() ? ledgers_.erase(agentIt) : std::next(agentIt);
+        }
+    }
+    
+    // 16 hex digits from one 64-bit draw; the generator is per thread since
+    // requests arrive concurrently
+    std::string generateAllocationId() {
+        static constexpr char kHexDigits[] = "0123456789abcdef";
+        thread_local std::mt19937_64 gen(std::random_device{}());
+        
+        uint64_t value = gen();
+        std::string id(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            id[i] = kHexDigits[value & 0xf];
+            value >>= 4;
         }
         
         return id;
@@ -360,43 +758,57 @@ private:
                 for (auto& [resourceType, bucket] : buckets_) {
                     std::lock_guard<std::mutex> bucketLock(bucket.mutex);
                     refillBucket(bucket);
+                    
+                    // Also releases unclaimed reservations within one refill period
+                    updateReservations(bucket, clock_->now());
                 }
             }
             
             // Sleep for minimum refill interval
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            sleepFor(kRefillPeriod);
         }
     }
     
     void cleanupLoop() {
         while (!stopRequested_) {
-            auto now = std::chrono::system_clock::now();
+            releaseExpiredAllocations();
             
-            {
-                std::lock_guard<std::mutex> lock(allocationsMutex_);
-                
-                auto it = allocations_.begin();
-                while (it != allocations_.end()) {
-                    if (now > it->second.expirationTime) {
-                        // Allocation has expired, release it
-                        releaseResources(it->first);
-                        it = allocations_.erase(it);
-                    } else {
-                        ++it;
-                    }
+            // Check every 5 seconds
+            sleepFor(kCleanupPeriod);
+        }
+    }
+    
+    void releaseExpiredAllocations() {
+        auto now = clock_->now();
+        
+        // Collect first: releaseResources() takes allocationsMutex_ itself
+        std::vector<std::string> expired;
+        {
+            std::lock_guard<std::mutex> lock(allocationsMutex_);
+            for (const auto& [allocationId, allocation] : allocations_) {
+                if (now > allocation.expirationTime) {
+                    expired.push_back(allocationId);
                 }
             }
-            
-            // Check every 5 seconds
-            std::this_thread::sleep_for(std::chrono::seconds(5));
         }
+        
+        for (const auto& allocationId : expired) {
+            releaseResources(allocationId);
+        }
+        
+        reclaimIdleLedgerEntries();
+    }
+    
+    void sleepFor(std::chrono::milliseconds period) {
+        clock_->sleepUntil(clock_->now() + period,
+                           [this]() { return stopRequested_.load(); });
     }
 };
 
 // TokenBucketResourceManager implementation
 
-TokenBucketResourceManager::TokenBucketResourceManager() 
-    : pImpl_(std::make_unique<Impl>()) {}
+TokenBucketResourceManager::TokenBucketResourceManager(std::shared_ptr<Clock> clock) 
+    : pImpl_(std::make_unique<Impl>(std::move(clock))) {}
 
 TokenBucketResourceManager::~TokenBucketResourceManager() = default;
 
@@ -413,10 +825,33 @@ TokenBucketResourceManager::AllocationResult TokenBucketResourceManager::request
     return pImpl_->requestResources(request);
 }
 
+TokenBucketResourceManager::AllocationResult TokenBucketResourceManager::acquireResources(
+    const ResourceRequest& request, std::chrono::milliseconds maxWait, const CancellationToken& cancellation) {
+    return pImpl_->acquireResources(request, maxWait, cancellation);
+}
+
 bool TokenBucketResourceManager::releaseResources(const std::string& allocationId) {
     return pImpl_->releaseResources(allocationId);
 }
 
+TokenBucketResourceManager::ReservationResult TokenBucketResourceManager::reserveResources(
+    const ReservationRequest& request) {
+    return pImpl_->reserveResources(request);
+}
+
+TokenBucketResourceManager::AllocationResult TokenBucketResourceManager::claimReservation(
+    const std::string& reservationId) {
+    return pImpl_->claimReservation(reservationId);
+}
+
+bool TokenBucketResourceManager::cancelReservation(const std::string& reservationId) {
+    return pImpl_->cancelReservation(reservationId);
+}
+
+int TokenBucketResourceManager::getReservedTokens(const std::string& resourceType) const {
+    return pImpl_->getReservedTokens(resourceType);
+}
+
 int TokenBucketResourceManager::getAvailableTokens(const std::string& resourceType) const {
     return pImpl_->getAvailableTokens(resourceType);
 }
@@ -437,6 +872,10 @@ int TokenBucketResourceManager::getAgentAllocation(const std::string& agentId,
     return pImpl_->getAgentAllocation(agentId, resourceType);
 }
 
+void TokenBucketResourceManager::runMaintenance() {
+    pImpl_->runMaintenance();
+}
+
 bool TokenBucketResourceManager::start() {
     return pImpl_->start();
 }
@@ -6,6 +6,8 @@
 #include <chrono>
 #include <mutex>
 #include <atomic>
+#include "orchestrator/cancellation_token.h"
+#include "orchestrator/resources/clock.h"
 
 namespace dist_prompt {
 namespace orchestrator {
@@ -50,11 +52,39 @@ public:
         std::chrono::system_clock::time_point expirationTime;
         std::string errorMessage;
     };
+    
+    /**
+     * @brief Advance reservation request structure
+     * 
+     * Books capacity for a future start time, e.g. for a workflow step whose
+     * dependencies are still running.
+     */
+    struct ReservationRequest {
+        std::string agentId;
+        std::string resourceType;
+        int tokensRequested;
+        std::chrono::system_clock::time_point startTime;  // When the tokens must be available
+        std::chrono::milliseconds claimWindow;            // How long after startTime the booking is held
+        std::chrono::milliseconds allocationTimeout;      // Lifetime of the allocation once claimed
+    };
+    
+    /**
+     * @brief Advance reservation result
+     */
+    struct ReservationResult {
+        bool success;
+        std::string reservationId;
+        std::chrono::system_clock::time_point startTime;
+        std::chrono::system_clock::time_point expirationTime;  // Released automatically if unclaimed by then
+        std::string errorMessage;
+    };
 
     /**
      * @brief Constructor
+     * 
+     * @param clock Time source for refill and expiry (defaults to the system clock)
      */
-    TokenBucketResourceManager();
+    explicit TokenBucketResourceManager(std::shared_ptr<Clock> clock = nullptr);
     
     /**
      * @brief Destructor
@@ -85,6 +115,23 @@ public:
      */
     AllocationResult requestResources(const ResourceRequest& request);
     
+    /**
+     * @brief Request resource allocation, waiting for tokens if necessary
+     * 
+     * Retries whenever tokens are released or refilled, until the request
+     * succeeds, maxWait passes on the manager's clock, the cancellation token
+     * fires or the manager is stopped. Unknown resource types and requests
+     * larger than the bucket fail at once.
+     * 
+     * @param request Resource request
+     * @param maxWait Maximum time to wait for tokens
+     * @param cancellation Token that abandons the wait when cancelled
+     * @return AllocationResult Result of the allocation attempt
+     */
+    AllocationResult acquireResources(const ResourceRequest& request,
+                                      std::chrono::milliseconds maxWait,
+                                      const CancellationToken& cancellation = CancellationToken());
+    
     /**
      * @brief Release allocated resources
      * 
@@ -93,11 +140,50 @@ public:
      */
     bool releaseResources(const std::string& allocationId);
     
+    /**
+     * @brief Book tokens for a future time window
+     * 
+     * Admission is checked against the bucket capacity minus other reservations
+     * overlapping the window. From startTime on, the booked tokens are withheld
+     * from immediate requests until claimed, cancelled or the window closes.
+     * 
+     * @param request Reservation request
+     * @return ReservationResult Result of the booking attempt
+     */
+    ReservationResult reserveResources(const ReservationRequest& request);
+    
+    /**
+     * @brief Convert a reservation into an allocation
+     * 
+     * May be called before startTime; the tokens are then taken from the
+     * unreserved pool if available.
+     * 
+     * @param reservationId ID returned by reserveResources()
+     * @return AllocationResult Allocation backed by the reserved tokens
+     */
+    AllocationResult claimReservation(const std::string& reservationId);
+    
+    /**
+     * @brief Cancel an unclaimed reservation
+     * 
+     * @param reservationId ID returned by reserveResources()
+     * @return bool True if the reservation existed and was cancelled
+     */
+    bool cancelReservation(const std::string& reservationId);
+    
+    /**
+     * @brief Get tokens currently withheld for active reservations
+     * 
+     * @param resourceType Type of resource
+     * @return int Number of tokens held for reservations whose window is open
+     */
+    int getReservedTokens(const std::string& resourceType) const;
+    
     /**
      * @brief Get current token count for a resource type
      * 
      * @param resourceType Type of resource
-     * @return int Current number of available tokens
+     * @return int Current number of tokens available to immediate requests
      */
     int getAvailableTokens(const std::string& resourceType) const;
     
@@ -131,6 +217,14 @@ public:
     int getAgentAllocation(const std::string& agentId, 
                           const std::string& resourceType) const;
     
+    /**
+     * @brief Run one refill and expiry pass at the clock's current time
+     * 
+     * Performs the work of the background threads synchronously, so that
+     * simulations on a VirtualClock can drive the manager without start().
+     */
+    void runMaintenance();
+    
     /**
      * @brief Start the resource manager (begins token refill process)
      * 
@@ -0,0 +1,131 @@
+#include "orchestrator/workflow/agent_pool.h"
+#include <algorithm>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+AgentPool::AgentPool(std::shared_ptr<AgentSelectionStrategy> defaultStrategy)
+    : defaultStrategy_(defaultStrategy ? std::move(defaultStrategy)
+                                       : std::make_shared<PowerOfTwoChoicesStrategy>()) {}
+
+bool AgentPool::addAgent(const std::string& agentId, const std::string& agentType) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (agents_.count(agentId) > 0) {
+        return false;
+    }
+    auto agent = std::make_shared<Agent>();
+    agent->load.agentId = agentId;
+    agent->agentType = agentType;
+    agents_.emplace(agentId, agent);
+    groups_[agentType].agents.push_back(std::move(agent));
+    return true;
+}
+
+bool AgentPool::removeAgent(const std::string& agentId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = agents_.find(agentId);
+    if (it == agents_.end()) {
+        return false;
+    }
+    auto& group = groups_[it->second->agentType].agents;
+    group.erase(std::remove(group.begin(), group.end(), it->second), group.end());
+    agents_.erase(it);
+    return true;
+}
+
+void AgentPool::updateMetrics(const std::string& agentId, double cpuUsage, double memoryUsage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = agents_.find(agentId);
+    if (it != agents_.end()) {
+        it->second->load.cpuUsage = cpuUsage;
+        it->second->load.memoryUsage = memoryUsage;
+    }
+}
+
+void AgentPool::updateMetrics(const AgentLifecycle::AgentContext& context) {
+    updateMetrics(context.id, context.cpuUsage, context.memoryUsage);
+}
+
+void AgentPool::setStrategy(const std::string& agentType, std::shared_ptr<AgentSelectionStrategy> strategy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    groups_[agentType].strategy = std::move(strategy);
+}
+
+bool AgentPool::hasAgents(const std::string& agentType) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = groups_.find(agentType);
+    return it != groups_.end() && !it->second.agents.empty();
+}
+
+std::string AgentPool::acquire(const std::string& agentType, const std::string& affinityKey,
+                               const std::vector<std::string>& excluded) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = groups_.find(agentType);
+    if (it == groups_.end() || it->second.agents.empty()) {
+        return "";
+    }
+
+    candidates_.clear();
+    candidateAgents_.clear();
+    for (const auto& agent : it->second.agents) {
+        if (std::find(excluded.begin(), excluded.end(), agent->load.agentId) != excluded.end()) {
+            continue;
+        }
+        candidates_.push_back(agent->load);
+        candidateAgents_.push_back(agent.get());
+    }
+    if (candidates_.empty()) {
+        exhausted_++;
+        return "";
+    }
+
+    auto& strategy = it->second.strategy ? it->second.strategy : defaultStrategy_;
+    size_t index = std::min(strategy->select(candidates_, affinityKey), candidates_.size() - 1);
+    Agent* chosen = candidateAgents_[index];
+    chosen->load.inFlight++;
+    selections_++;
+    return chosen->load.agentId;
+}
+
+void AgentPool::release(const std::string& agentId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = agents_.find(agentId);
+    if (it != agents_.end() && it->second->load.inFlight > 0) {
+        it->second->load.inFlight--;
+    }
+}
+
+std::vector<AgentLoad> AgentPool::getLoads(const std::string& agentType) const {
+    std::vector<AgentLoad> loads;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = groups_.find(agentType);
+    if (it != groups_.end()) {
+        for (const auto& agent : it->second.agents) {
+            loads.push_back(agent->load);
+        }
+    }
+    return loads;
+}
+
+std::map<std::string, double> AgentPool::getStatistics() const {
+    std::map<std::string, double> stats;
+    stats["selections"] = static_cast<double>(selections_.load());
+    stats["selections_exhausted"] = static_cast<double>(exhausted_.load());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t inFlight = 0;
+    size_t maxInFlight = 0;
+    for (const auto& [agentId, agent] : agents_) {
+        inFlight += agent->load.inFlight;
+        maxInFlight = std::max(maxInFlight, agent->load.inFlight);
+    }
+    stats["agents"] = static_cast<double>(agents_.size());
+    stats["steps_in_flight"] = static_cast<double>(inFlight);
+    stats["max_agent_in_flight"] = static_cast<double>(maxInFlight);
+    return stats;
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "orchestrator/agent_lifecycle.h"
+#include "orchestrator/workflow/agent_selection.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Registered agents per agentType with their live load
+ *
+ * Picks the agent for each workflow step with the strategy set for the
+ * step's agentType, and counts the step against that agent until it is
+ * released. Metrics reported from AgentLifecycle contexts feed strategies
+ * that look beyond queue depth.
+ */
+class AgentPool {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param defaultStrategy Strategy for agent types without their own; nullptr uses power of two choices
+     */
+    explicit AgentPool(std::shared_ptr<AgentSelectionStrategy> defaultStrategy = nullptr);
+
+    /**
+     * @brief Add an agent
+     *
+     * @param agentId Agent identifier
+     * @param agentType Agent type it serves steps for
+     * @return bool False if the agent is already registered
+     */
+    bool addAgent(const std::string& agentId, const std::string& agentType);
+
+    /**
+     * @brief Remove an agent; steps already dispatched to it are unaffected
+     *
+     * @param agentId Agent identifier
+     * @return bool True if the agent was registered
+     */
+    bool removeAgent(const std::string& agentId);
+
+    /**
+     * @brief Report an agent's resource use
+     *
+     * @param agentId Agent identifier
+     * @param cpuUsage CPU use
+     * @param memoryUsage Memory use
+     */
+    void updateMetrics(const std::string& agentId, double cpuUsage, double memoryUsage);
+
+    /**
+     * @brief Report an agent's resource use from its lifecycle context
+     *
+     * @param context Agent context
+     */
+    void updateMetrics(const AgentLifecycle::AgentContext& context);
+
+    /**
+     * @brief Set the selection strategy of an agent type
+     *
+     * @param agentType Agent type
+     * @param strategy Strategy, or nullptr to use the default strategy
+     */
+    void setStrategy(const std::string& agentType, std::shared_ptr<AgentSelectionStrategy> strategy);
+
+    /**
+     * @brief Check whether any agent of a type is registered
+     *
+     * @param agentType Agent type
+     * @return bool True if at least one agent is registered
+     */
+    bool hasAgents(const std::string& agentType) const;
+
+    /**
+     * @brief Pick an agent for a step and count the step against it
+     *
+     * @param agentType Agent type of the step
+     * @param affinityKey Key passed to the strategy for cache affinity
+     * @param excluded Agents that must not be chosen, e.g. those running earlier attempts
+     * @return std::string Agent ID, or empty if no agent of the type is left to choose
+     */
+    std::string acquire(const std::string& agentType, const std::string& affinityKey,
+                        const std::vector<std::string>& excluded = {});
+
+    /**
+     * @brief Mark a step dispatched by acquire() as finished
+     *
+     * @param agentId Agent returned by acquire()
+     */
+    void release(const std::string& agentId);
+
+    /**
+     * @brief Get the current load of the agents of a type
+     *
+     * @param agentType Agent type
+     * @return std::vector<AgentLoad> One entry per registered agent
+     */
+    std::vector<AgentLoad> getLoads(const std::string& agentType) const;
+
+    /**
+     * @brief Get pool statistics
+     *
+     * @return std::map<std::string, double> Agent, selection and in-flight counters
+     */
+    std::map<std::string, double> getStatistics() const;
+
+private:
+    struct Agent {
+        AgentLoad load;
+        std::string agentType;
+    };
+
+    struct AgentGroup {
+        std::vector<std::shared_ptr<Agent>> agents;
+        std::shared_ptr<AgentSelectionStrategy> strategy;  // nullptr uses the default
+    };
+
+    std::shared_ptr<AgentSelectionStrategy> defaultStrategy_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, AgentGroup> groups_;                // By agent type
+    std::unordered_map<std::string, std::shared_ptr<Agent>> agents_;    // By agent ID
+    std::vector<AgentLoad> candidates_;                                  // Scratch for acquire()
+    std::vector<Agent*> candidateAgents_;
+
+    std::atomic<uint64_t> selections_{0};
+    std::atomic<uint64_t> exhausted_{0};
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,118 @@
+#include "orchestrator/workflow/agent_selection.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+namespace {
+
+// FNV-1a; stable across processes so keys map to the same agents after a restart
+uint64_t hashString(const std::string& value, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (unsigned char c : value) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// splitmix64 finalizer; spreads the FNV output so weights of similar IDs are unrelated
+uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+std::mt19937_64& threadRandom() {
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    return gen;
+}
+
+} // namespace
+
+size_t PowerOfTwoChoicesStrategy::select(const std::vector<AgentLoad>& candidates,
+                                         const std::string& /*affinityKey*/) {
+    if (candidates.size() < 2) {
+        return 0;
+    }
+    auto& gen = threadRandom();
+    std::uniform_int_distribution<size_t> first(0, candidates.size() - 1);
+    std::uniform_int_distribution<size_t> second(0, candidates.size() - 2);
+    size_t a = first(gen);
+    size_t b = second(gen);
+    if (b >= a) {
+        b++;  // Distinct from a
+    }
+
+    const auto& left = candidates[a];
+    const auto& right = candidates[b];
+    if (left.inFlight != right.inFlight) {
+        return left.inFlight < right.inFlight ? a : b;
+    }
+    return left.cpuUsage <= right.cpuUsage ? a : b;
+}
+
+LeastLoadedStrategy::LeastLoadedStrategy()
+    : LeastLoadedStrategy(Weights()) {}
+
+LeastLoadedStrategy::LeastLoadedStrategy(Weights weights)
+    : weights_(weights) {}
+
+size_t LeastLoadedStrategy::select(const std::vector<AgentLoad>& candidates,
+                                   const std::string& /*affinityKey*/) {
+    // Start the scan at a rotating offset so ties do not all go to the first agent
+    size_t offset = rotation_++ % candidates.size();
+    size_t best = offset;
+    double bestScore = 0.0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        size_t index = (offset + i) % candidates.size();
+        const auto& load = candidates[index];
+        double score = weights_.inFlight * static_cast<double>(load.inFlight) +
+                       weights_.cpuUsage * load.cpuUsage + weights_.memoryUsage * load.memoryUsage;
+        if (i == 0 || score < bestScore) {
+            best = index;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+ConsistentHashStrategy::ConsistentHashStrategy(double loadFactor)
+    : loadFactor_(std::max(1.0, loadFactor)) {}
+
+size_t ConsistentHashStrategy::select(const std::vector<AgentLoad>& candidates,
+                                      const std::string& affinityKey) {
+    size_t total = 0;
+    for (const auto& load : candidates) {
+        total += load.inFlight;
+    }
+    // Counting the step being placed guarantees that some agent is under the bound
+    auto limit = static_cast<size_t>(
+        std::ceil(loadFactor_ * static_cast<double>(total + 1) / static_cast<double>(candidates.size())));
+
+    uint64_t keyHash = hashString(affinityKey);
+    size_t best = 0;
+    uint64_t bestWeight = 0;
+    bool found = false;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].inFlight + 1 > limit) {
+            continue;
+        }
+        uint64_t weight = mix(hashString(candidates[i].agentId, keyHash));
+        if (!found || weight > bestWeight) {
+            best = i;
+            bestWeight = weight;
+            found = true;
+        }
+    }
+    return best;
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
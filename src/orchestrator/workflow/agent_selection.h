@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Load of one agent as seen by a selection strategy
+ */
+struct AgentLoad {
+    std::string agentId;
+    size_t inFlight = 0;        // Steps dispatched to the agent that have not returned
+    double cpuUsage = 0.0;      // Last reported AgentContext::cpuUsage
+    double memoryUsage = 0.0;   // Last reported AgentContext::memoryUsage
+};
+
+/**
+ * @brief Policy that picks the agent to run a step
+ *
+ * Called with the pool's lock held, so implementations must be fast and
+ * must not call back into the pool. They may be shared between pools and
+ * called from several threads.
+ */
+class AgentSelectionStrategy {
+public:
+    virtual ~AgentSelectionStrategy() = default;
+
+    /**
+     * @brief Pick an agent
+     *
+     * @param candidates Agents of the step's type that may be chosen; never empty
+     * @param affinityKey Stable key of the work, equal for steps that would hit the same cached state
+     * @return size_t Index into candidates
+     */
+    virtual size_t select(const std::vector<AgentLoad>& candidates, const std::string& affinityKey) = 0;
+};
+
+/**
+ * @brief Power of two choices on live queue depth
+ *
+ * Samples two distinct agents at random and takes the one with fewer steps
+ * in flight. Needs no global view yet keeps the maximum queue depth close to
+ * the average, and avoids the herding that always picking the global
+ * minimum causes when many steps are dispatched at once.
+ */
+class PowerOfTwoChoicesStrategy : public AgentSelectionStrategy {
+public:
+    size_t select(const std::vector<AgentLoad>& candidates, const std::string& affinityKey) override;
+};
+
+/**
+ * @brief Lowest weighted load from steps in flight and reported metrics
+ *
+ * Suited to agents with very different capacity, where CPU and memory use
+ * say more than queue depth. Ties rotate among the tied agents.
+ */
+class LeastLoadedStrategy : public AgentSelectionStrategy {
+public:
+    /**
+     * @brief Weights of the load score
+     */
+    struct Weights {
+        double inFlight = 1.0;
+        double cpuUsage = 1.0;
+        double memoryUsage = 0.5;
+    };
+
+    /**
+     * @brief Constructor with default weights
+     */
+    LeastLoadedStrategy();
+
+    /**
+     * @brief Constructor
+     *
+     * @param weights Weights of the load score
+     */
+    explicit LeastLoadedStrategy(Weights weights);
+
+    size_t select(const std::vector<AgentLoad>& candidates, const std::string& affinityKey) override;
+
+private:
+    Weights weights_;
+    std::atomic<size_t> rotation_{0};
+};
+
+/**
+ * @brief Consistent hashing of the affinity key with bounded load
+ *
+ * Uses rendezvous hashing: every agent gets a pseudo-random weight per key
+ * and the heaviest wins. The same key thus keeps going to the same agent,
+ * adding or removing an agent only moves the keys it gains or loses, and
+ * excluding an agent falls back to the key's next choice. An agent with
+ * more than loadFactor times the average steps in flight is passed over, so
+ * a hot key cannot overload its agent.
+ */
+class ConsistentHashStrategy : public AgentSelectionStrategy {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param loadFactor Maximum in-flight steps of the chosen agent relative to the average (>= 1)
+     */
+    explicit ConsistentHashStrategy(double loadFactor = 1.25);
+
+    size_t select(const std::vector<AgentLoad>& candidates, const std::string& affinityKey) override;
+
+private:
+    double loadFactor_;
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,255 @@
+#include "orchestrator/workflow/result_codec.h"
+#include <cstdint>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+namespace {
+
+constexpr uint8_t kFormatVersion = 1;
+constexpr uint8_t kCheckpointVersion = 1;
+constexpr uint8_t kStepRequestVersion = 1;
+
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out_.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    void i64(int64_t value) {
+        auto bits = static_cast<uint64_t>(value);
+        for (int i = 0; i < 8; ++i) {
+            out_.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+        }
+    }
+
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+
+    void map(const std::map<std::string, std::string>& values) {
+        u32(static_cast<uint32_t>(values.size()));
+        for (const auto& [key, value] : values) {
+            str(key);
+            str(value);
+        }
+    }
+
+private:
+    std::string& out_;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string& in) : in_(in) {}
+
+    bool u8(uint8_t& value) {
+        if (remaining() < 1) {
+            return false;
+        }
+        value = static_cast<uint8_t>(in_[pos_++]);
+        return true;
+    }
+
+    bool u32(uint32_t& value) {
+        if (remaining() < 4) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(in_[pos_++])) << (8 * i);
+        }
+        return true;
+    }
+
+    bool i64(int64_t& value) {
+        if (remaining() < 8) {
+            return false;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(in_[pos_++])) << (8 * i);
+        }
+        value = static_cast<int64_t>(bits);
+        return true;
+    }
+
+    bool str(std::string& value) {
+        uint32_t size = 0;
+        if (!u32(size) || remaining() < size) {
+            return false;
+        }
+        value.assign(in_, pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool map(std::map<std::string, std::string>& values) {
+        uint32_t count = 0;
+        if (!u32(count)) {
+            return false;
+        }
+        values.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string key;
+            std::string value;
+            if (!str(key) || !str(value)) {
+                return false;
+            }
+            values.emplace_hint(values.end(), std::move(key), std::move(value));
+        }
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == in_.size(); }
+
+private:
+    size_t remaining() const { return in_.size() - pos_; }
+
+    const std::string& in_;
+    size_t pos_ = 0;
+};
+
+void writeResult(Writer& writer, const integration::ExecutionResult& result) {
+    writer.u8(result.success ? 1 : 0);
+    writer.str(result.resultData);
+    writer.map(result.outputs);
+    writer.str(result.errorMessage);
+    writer.i64(result.executionTime.count());
+}
+
+bool readResult(Reader& reader, integration::ExecutionResult& result) {
+    uint8_t success = 0;
+    int64_t millis = 0;
+    if (!reader.u8(success) || !reader.str(result.resultData) || !reader.map(result.outputs) ||
+        !reader.str(result.errorMessage) || !reader.i64(millis)) {
+        return false;
+    }
+    result.success = success != 0;
+    result.executionTime = std::chrono::milliseconds(millis);
+    return true;
+}
+
+} // namespace
+
+std::string ResultCodec::encodeResult(const integration::ExecutionResult& result) {
+    std::string out;
+    Writer writer(out);
+    writer.u8(kFormatVersion);
+    writeResult(writer, result);
+    return out;
+}
+
+bool ResultCodec::decodeResult(const std::string& bytes, integration::ExecutionResult& result) {
+    Reader reader(bytes);
+    uint8_t version = 0;
+    if (!reader.u8(version) || version != kFormatVersion || !readResult(reader, result)) {
+        return false;
+    }
+    return reader.atEnd();
+}
+
+std::string ResultCodec::encodeCheckpoint(const ExecutionCheckpoint& checkpoint) {
+    std::string out;
+    Writer writer(out);
+    writer.u8(kCheckpointVersion);
+    writer.str(checkpoint.executionId);
+    writer.str(checkpoint.workflowId);
+
+    const auto& context = checkpoint.context;
+    writer.str(context.contextId);
+    writer.str(context.workflowId);
+    writer.map(context.variables);
+    writer.str(context.workingDirectory);
+    writer.i64(std::chrono::duration_cast<std::chrono::milliseconds>(
+        context.startTime.time_since_epoch()).count());
+
+    writer.u32(static_cast<uint32_t>(checkpoint.completedSteps.size()));
+    for (const auto& step : checkpoint.completedSteps) {
+        writer.str(step.stepId);
+        writer.str(step.fingerprint);
+        writeResult(writer, step.result);
+    }
+    return out;
+}
+
+bool ResultCodec::decodeCheckpoint(const std::string& bytes, ExecutionCheckpoint& checkpoint) {
+    Reader reader(bytes);
+    uint8_t version = 0;
+    if (!reader.u8(version) || version != kCheckpointVersion || !reader.str(checkpoint.executionId) ||
+        !reader.str(checkpoint.workflowId)) {
+        return false;
+    }
+
+    auto& context = checkpoint.context;
+    int64_t startMillis = 0;
+    if (!reader.str(context.contextId) || !reader.str(context.workflowId) || !reader.map(context.variables) ||
+        !reader.str(context.workingDirectory) || !reader.i64(startMillis)) {
+        return false;
+    }
+    context.startTime = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(startMillis)));
+
+    uint32_t count = 0;
+    if (!reader.u32(count)) {
+        return false;
+    }
+    checkpoint.completedSteps.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        ExecutionCheckpoint::Step step;
+        step.result = integration::ExecutionResult{};
+        if (!reader.str(step.stepId) || !reader.str(step.fingerprint) || !readResult(reader, step.result)) {
+            return false;
+        }
+        checkpoint.completedSteps.push_back(std::move(step));
+    }
+    return reader.atEnd();
+}
+
+std::string ResultCodec::encodeStepRequest(const StepRequest& request) {
+    std::string out;
+    Writer writer(out);
+    writer.u8(kStepRequestVersion);
+    writer.str(request.executionId);
+    writer.str(request.stepId);
+    writer.str(request.action);
+    writer.map(request.parameters);
+    writer.u32(static_cast<uint32_t>(request.inputs.size()));
+    for (const auto& input : request.inputs) {
+        writeResult(writer, input);
+    }
+    return out;
+}
+
+bool ResultCodec::decodeStepRequest(const std::string& bytes, StepRequest& request) {
+    Reader reader(bytes);
+    uint8_t version = 0;
+    uint32_t count = 0;
+    if (!reader.u8(version) || version != kStepRequestVersion || !reader.str(request.executionId) ||
+        !reader.str(request.stepId) || !reader.str(request.action) || !reader.map(request.parameters) ||
+        !reader.u32(count)) {
+        return false;
+    }
+
+    request.inputs.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        integration::ExecutionResult input{};
+        if (!readResult(reader, input)) {
+            return false;
+        }
+        request.inputs.push_back(std::move(input));
+    }
+    return reader.atEnd();
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "orchestrator_interface.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Saved state of a workflow execution
+ */
+struct ExecutionCheckpoint {
+    /**
+     * @brief A completed step
+     */
+    struct Step {
+        std::string stepId;
+        std::string fingerprint;  // Action, resolved parameters and inputs the result was computed from
+        integration::ExecutionResult result;
+    };
+
+    std::string executionId;
+    std::string workflowId;
+    integration::ExecutionContext context;
+    std::vector<Step> completedSteps;
+};
+
+/**
+ * @brief A step handed to a remote agent
+ */
+struct StepRequest {
+    std::string executionId;
+    std::string stepId;
+    std::string action;
+    std::map<std::string, std::string> parameters;     // With ${name} references resolved
+    std::vector<integration::ExecutionResult> inputs;  // Results of the step's dependencies, in order
+};
+
+/**
+ * @brief Compact binary encoding of step results and execution checkpoints
+ *
+ * Strings are length-prefixed and integers little-endian, with a leading
+ * format version byte, so files written on one host can be read on another.
+ * Used for the disk tier of the step result cache, for checkpoints and for
+ * steps run by remote agents.
+ */
+class ResultCodec {
+public:
+    /**
+     * @brief Encode a result
+     *
+     * @param result Result to encode
+     * @return std::string Encoded bytes
+     */
+    static std::string encodeResult(const integration::ExecutionResult& result);
+
+    /**
+     * @brief Decode a result
+     *
+     * @param bytes Encoded bytes
+     * @param result Output result
+     * @return bool True if the bytes held a well-formed result of a known version
+     */
+    static bool decodeResult(const std::string& bytes, integration::ExecutionResult& result);
+
+    /**
+     * @brief Encode a checkpoint
+     *
+     * @param checkpoint Checkpoint to encode
+     * @return std::string Encoded bytes
+     */
+    static std::string encodeCheckpoint(const ExecutionCheckpoint& checkpoint);
+
+    /**
+     * @brief Decode a checkpoint
+     *
+     * @param bytes Encoded bytes
+     * @param checkpoint Output checkpoint
+     * @return bool True if the bytes held a well-formed checkpoint of a known version
+     */
+    static bool decodeCheckpoint(const std::string& bytes, ExecutionCheckpoint& checkpoint);
+
+    /**
+     * @brief Encode a step request
+     *
+     * @param request Step to encode
+     * @return std::string Encoded bytes
+     */
+    static std::string encodeStepRequest(const StepRequest& request);
+
+    /**
+     * @brief Decode a step request
+     *
+     * @param bytes Encoded bytes
+     * @param request Output step
+     * @return bool True if the bytes held a well-formed step request of a known version
+     */
+    static bool decodeStepRequest(const std::string& bytes, StepRequest& request);
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,93 @@
+#include "orchestrator/workflow/step_history.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+namespace {
+
+// Weight of the newest sample in the running mean
+constexpr double kSmoothing = 0.2;
+
+} // namespace
+
+StepHistory::StepHistory(double defaultMicros)
+    : defaultMicros_(defaultMicros) {}
+
+StepHistory::Slot StepHistory::intern(const std::string& action) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(action);
+    if (it != slots_.end()) {
+        return it->second;
+    }
+    Slot slot = static_cast<Slot>(entries_.size());
+    entries_.emplace_back();
+    slots_.emplace(action, slot);
+    return slot;
+}
+
+void StepHistory::record(Slot slot, double micros) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (slot >= entries_.size()) {
+        return;
+    }
+    auto& entry = entries_[slot];
+    if (entry.window.size() < kWindowSize) {
+        entry.window.push_back(micros);
+    } else {
+        // samples counts every recorded value, so it also gives the ring position
+        entry.window[entry.samples % kWindowSize] = micros;
+    }
+    update(entry, micros);
+    update(overall_, micros);
+}
+
+double StepHistory::expectedMicros(Slot slot) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return estimate(slot);
+}
+
+void StepHistory::expectedMicros(const std::vector<Slot>& slots, std::vector<double>& micros) const {
+    micros.resize(slots.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        micros[i] = estimate(slots[i]);
+    }
+}
+
+bool StepHistory::percentileMicros(Slot slot, double percentile, size_t minSamples, double& micros) const {
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slot >= entries_.size() || entries_[slot].window.size() < std::max<size_t>(1, minSamples)) {
+            return false;
+        }
+        samples = entries_[slot].window;
+    }
+
+    auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(samples.size())));
+    rank = std::min(samples.size(), std::max<size_t>(1, rank)) - 1;
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    micros = samples[rank];
+    return true;
+}
+
+void StepHistory::update(Entry& entry, double micros) {
+    // Plain average until the mean has settled, then exponential smoothing
+    entry.samples++;
+    double weight = std::max(kSmoothing, 1.0 / static_cast<double>(entry.samples));
+    entry.mean += weight * (micros - entry.mean);
+}
+
+double StepHistory::estimate(Slot slot) const {
+    if (slot < entries_.size() && entries_[slot].samples > 0) {
+        return entries_[slot].mean;
+    }
+    return overall_.samples > 0 ? overall_.mean : defaultMicros_;
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
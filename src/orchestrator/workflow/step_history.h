@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Historical step durations per action
+ *
+ * Actions are interned to slots when a workflow is defined, so that
+ * executions read and update estimates by index. Each slot keeps an
+ * exponentially weighted mean of observed durations and a window of recent
+ * samples for percentiles. Actions without history are estimated with the
+ * mean over all steps.
+ */
+class StepHistory {
+public:
+    using Slot = uint32_t;
+
+    /**
+     * @brief Constructor
+     *
+     * @param defaultMicros Estimate used before any step has been observed
+     */
+    explicit StepHistory(double defaultMicros = 1000.0);
+
+    /**
+     * @brief Get the slot of an action, creating it on first use
+     *
+     * @param action Action name
+     * @return Slot Slot index, stable for the lifetime of the history
+     */
+    Slot intern(const std::string& action);
+
+    /**
+     * @brief Record an observed duration
+     *
+     * @param slot Action slot
+     * @param micros Duration in microseconds
+     */
+    void record(Slot slot, double micros);
+
+    /**
+     * @brief Get the expected duration of an action
+     *
+     * @param slot Action slot
+     * @return double Estimate in microseconds
+     */
+    double expectedMicros(Slot slot) const;
+
+    /**
+     * @brief Get the expected durations of several actions under one lock
+     *
+     * @param slots Action slots
+     * @param micros Filled with one estimate per slot
+     */
+    void expectedMicros(const std::vector<Slot>& slots, std::vector<double>& micros) const;
+
+    /**
+     * @brief Get a percentile of the recent durations of an action
+     *
+     * @param slot Action slot
+     * @param percentile Percentile in (0, 1]
+     * @param minSamples Minimum number of recent samples required
+     * @param micros Set to the percentile in microseconds
+     * @return bool False if the action has fewer than minSamples recent samples
+     */
+    bool percentileMicros(Slot slot, double percentile, size_t minSamples, double& micros) const;
+
+private:
+    static constexpr size_t kWindowSize = 128;
+
+    struct Entry {
+        double mean = 0.0;
+        uint64_t samples = 0;
+        std::vector<double> window;  // Ring of the last kWindowSize samples
+    };
+
+    // Caller holds mutex_
+    static void update(Entry& entry, double micros);
+    double estimate(Slot slot) const;
+
+    double defaultMicros_;
+
+    mutable std::mutex mutex_;
+    Entry overall_;
+    std::unordered_map<std::string, Slot> slots_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
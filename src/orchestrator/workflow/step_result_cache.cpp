@@ -0,0 +1,228 @@
+#include "orchestrator/workflow/step_result_cache.h"
+#include "orchestrator/workflow/result_codec.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <thread>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Two FNV-1a style lanes with different bases and multipliers give a 128-bit
+// key that does not depend on std::hash, which differs between standard libraries
+class StableHasher {
+public:
+    void bytes(const std::string& value) {
+        u64(value.size());
+        for (unsigned char c : value) {
+            mix(c);
+        }
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            mix(static_cast<unsigned char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    void map(const std::map<std::string, std::string>& values) {
+        u64(values.size());
+        for (const auto& [key, value] : values) {
+            bytes(key);
+            bytes(value);
+        }
+    }
+
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(32);
+        for (uint64_t lane : {high_, low_}) {
+            for (int shift = 60; shift >= 0; shift -= 4) {
+                out.push_back(digits[(lane >> shift) & 0xf]);
+            }
+        }
+        return out;
+    }
+
+private:
+    static constexpr uint64_t kHighPrime = 0x100000001b3ULL;
+    static constexpr uint64_t kLowMultiplier = 0x9e3779b97f4a7c15ULL;
+
+    void mix(unsigned char c) {
+        high_ = (high_ ^ c) * kHighPrime;
+        low_ = (low_ ^ c) * kLowMultiplier;
+    }
+
+    uint64_t high_ = 0xcbf29ce484222325ULL;
+    uint64_t low_ = 0x84222325cbf29ce4ULL;
+};
+
+size_t entryBytes(const std::string& key, const integration::ExecutionResult& result) {
+    // Key stored twice (entry and index) plus list and hash node overhead
+    size_t bytes = 2 * key.size() + 128 + result.resultData.size() + result.errorMessage.size();
+    for (const auto& [name, value] : result.outputs) {
+        // Rough per-node overhead of std::map
+        bytes += name.size() + value.size() + 64;
+    }
+    return bytes;
+}
+
+} // namespace
+
+StepResultCache::StepResultCache(Options options)
+    : options_(std::move(options)) {
+    if (!options_.directory.empty()) {
+        std::error_code ec;
+        fs::create_directories(options_.directory, ec);
+    }
+}
+
+std::string StepResultCache::makeKey(const std::string& actionId,
+                                     const std::map<std::string, std::string>& parameters,
+                                     const std::vector<const integration::ExecutionResult*>& inputs) {
+    StableHasher hasher;
+    hasher.bytes(actionId);
+    hasher.map(parameters);
+    hasher.u64(inputs.size());
+    for (const auto* input : inputs) {
+        hasher.bytes(input->resultData);
+        hasher.map(input->outputs);
+    }
+    return hasher.hex();
+}
+
+bool StepResultCache::lookup(const std::string& key, integration::ExecutionResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            result = it->second->result;
+            memoryHits_++;
+            return true;
+        }
+    }
+
+    if (!options_.directory.empty()) {
+        std::ifstream in(pathFor(key), std::ios::binary);
+        if (in) {
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (ResultCodec::decodeResult(bytes, result)) {
+                diskHits_++;
+                std::lock_guard<std::mutex> lock(mutex_);
+                insert(key, result);
+                return true;
+            }
+            diskErrors_++;
+        }
+    }
+
+    misses_++;
+    return false;
+}
+
+void StepResultCache::store(const std::string& key, const integration::ExecutionResult& result) {
+    if (!result.success) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        insert(key, result);
+    }
+
+    if (!options_.directory.empty()) {
+        // Write then rename, so readers never see a partial file
+        auto path = pathFor(key);
+        auto tmp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            auto bytes = ResultCodec::encodeResult(result);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!out) {
+                diskErrors_++;
+                return;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        if (ec) {
+            diskErrors_++;
+            fs::remove(tmp, ec);
+        }
+    }
+}
+
+void StepResultCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        index_.clear();
+        memoryBytes_ = 0;
+    }
+
+    if (!options_.directory.empty()) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+            if (entry.path().extension() == ".res") {
+                fs::remove(entry.path(), ec);
+            }
+        }
+    }
+}
+
+std::map<std::string, double> StepResultCache::getStatistics() const {
+    std::map<std::string, double> stats;
+    stats["memory_hits"] = static_cast<double>(memoryHits_.load());
+    stats["disk_hits"] = static_cast<double>(diskHits_.load());
+    stats["misses"] = static_cast<double>(misses_.load());
+    stats["evictions"] = static_cast<double>(evictions_.load());
+    stats["disk_errors"] = static_cast<double>(diskErrors_.load());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats["memory_entries"] = static_cast<double>(lru_.size());
+    stats["memory_bytes"] = static_cast<double>(memoryBytes_);
+    return stats;
+}
+
+void StepResultCache::insert(const std::string& key, const integration::ExecutionResult& result) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        memoryBytes_ -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    size_t bytes = entryBytes(key, result);
+    if (bytes > options_.maxMemoryBytes) {
+        // Larger than the whole memory tier; only the disk copy is kept
+        return;
+    }
+
+    lru_.push_front(Entry{key, result, bytes});
+    index_[key] = lru_.begin();
+    memoryBytes_ += bytes;
+
+    while (memoryBytes_ > options_.maxMemoryBytes) {
+        auto& victim = lru_.back();
+        memoryBytes_ -= victim.bytes;
+        index_.erase(victim.key);
+        lru_.pop_back();
+        evictions_++;
+    }
+}
+
+std::string StepResultCache::pathFor(const std::string& key) const {
+    return (fs::path(options_.directory) / (key + ".res")).string();
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
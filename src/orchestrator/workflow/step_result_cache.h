@@ -0,0 +1,112 @@
+#pragma once
+
+#include "orchestrator_interface.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Content-addressed cache of successful step results
+ *
+ * Keys are a stable 128-bit hash of a versioned action identifier, the
+ * step's resolved parameters and the results of its dependencies, so the same
+ * key is produced across processes and hosts. The memory tier is an LRU
+ * bounded by bytes. With a directory set, every stored result is also written
+ * there and memory misses fall back to it; the disk tier is not bounded and
+ * is emptied by clear().
+ */
+class StepResultCache {
+public:
+    /**
+     * @brief Cache configuration
+     */
+    struct Options {
+        size_t maxMemoryBytes = 64 * 1024 * 1024;
+        std::string directory;  // Disk tier location; empty keeps results in memory only
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param options Cache configuration
+     */
+    explicit StepResultCache(Options options);
+
+    /**
+     * @brief Compute the cache key of a step invocation
+     *
+     * @param actionId Versioned action identifier, e.g. "pcam/decompose@3"
+     * @param parameters Step parameters with variable references resolved
+     * @param inputs Results of the step's dependencies, in declaration order
+     * @return std::string 32 hex digits
+     */
+    static std::string makeKey(const std::string& actionId,
+                               const std::map<std::string, std::string>& parameters,
+                               const std::vector<const integration::ExecutionResult*>& inputs);
+
+    /**
+     * @brief Look up a result
+     *
+     * @param key Cache key
+     * @param result Set to the cached result on a hit
+     * @return bool True on a hit in either tier
+     */
+    bool lookup(const std::string& key, integration::ExecutionResult& result);
+
+    /**
+     * @brief Store a successful result
+     *
+     * @param key Cache key
+     * @param result Result to store; failed results are ignored
+     */
+    void store(const std::string& key, const integration::ExecutionResult& result);
+
+    /**
+     * @brief Drop all entries from both tiers
+     */
+    void clear();
+
+    /**
+     * @brief Get cache statistics
+     *
+     * @return std::map<std::string, double> Hits per tier, misses, evictions and memory use
+     */
+    std::map<std::string, double> getStatistics() const;
+
+private:
+    struct Entry {
+        std::string key;
+        integration::ExecutionResult result;
+        size_t bytes = 0;
+    };
+
+    // Caller holds mutex_
+    void insert(const std::string& key, const integration::ExecutionResult& result);
+    std::string pathFor(const std::string& key) const;
+
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t memoryBytes_ = 0;
+
+    std::atomic<uint64_t> memoryHits_{0};
+    std::atomic<uint64_t> diskHits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> diskErrors_{0};
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,139 @@
+#include "orchestrator/workflow/work_stealing_pool.h"
+#include <algorithm>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+namespace {
+
+// Identifies the pool and deque owned by the current thread, if any
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stop();
+}
+
+bool WorkStealingPool::submit(Task task) {
+    bool local = isWorkerThread();
+    // Workers may still queue follow-up tasks while the pool drains
+    if (stopping_.load() && !local) {
+        return false;
+    }
+
+    if (local) {
+        auto& queue = *queues_[currentIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectionMutex_);
+        injection_.push_back(std::move(task));
+    }
+
+    pending_.fetch_add(1);
+    {
+        // Pairs with the predicate check in workerLoop so the wakeup is not lost
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCv_.notify_one();
+    return true;
+}
+
+void WorkStealingPool::stop() {
+    if (stopping_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool WorkStealingPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+bool WorkStealingPool::takeTask(size_t index, Task& task) {
+    {
+        auto& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex_);
+        if (!injection_.empty()) {
+            task = std::move(injection_.front());
+            injection_.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            pending_.fetch_sub(1);
+            task();
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (stopping_.load() && pending_.load() == 0) {
+            break;
+        }
+        sleepCv_.wait(lock, [this]() { return pending_.load() > 0 || stopping_.load(); });
+        if (stopping_.load() && pending_.load() == 0) {
+            break;
+        }
+    }
+
+    currentPool = nullptr;
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Thread pool with one task deque per worker and stealing between them
+ *
+ * Tasks submitted from a worker go to the back of that worker's own deque and
+ * are popped LIFO, so a step's successors usually run on the thread that just
+ * produced their inputs. Tasks submitted from other threads go to a shared
+ * injection queue. An idle worker takes from the injection queue first and
+ * otherwise steals the oldest task from another worker's deque.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Construct and start a pool
+     *
+     * @param threadCount Number of workers (0 = hardware concurrency)
+     */
+    explicit WorkStealingPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destructor; runs the queued tasks and joins the workers
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Queue a task
+     *
+     * @param task Task to run on a worker thread
+     * @return bool False if the pool is stopping
+     */
+    bool submit(Task task);
+
+    /**
+     * @brief Stop accepting tasks, run the queued ones and join the workers
+     */
+    void stop();
+
+    /**
+     * @brief Get the number of worker threads
+     *
+     * @return size_t Worker count
+     */
+    size_t threadCount() const { return workers_.size(); }
+
+    /**
+     * @brief Check whether the calling thread is one of this pool's workers
+     *
+     * @return bool True on a worker thread
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * @brief Get the number of tasks taken from another worker's deque
+     *
+     * @return uint64_t Steal count
+     */
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of tasks run so far
+     *
+     * @return uint64_t Completed tasks
+     */
+    uint64_t executed() const { return executed_.load(std::memory_order_relaxed); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool takeTask(size_t index, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex injectionMutex_;
+    std::deque<Task> injection_;
+
+    // Tasks queued anywhere; workers sleep only while this is zero
+    std::atomic<size_t> pending_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<uint64_t> steals_{0};
+    std::atomic<uint64_t> executed_{0};
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,1244 @@
+#include "orchestrator/workflow/workflow_executor.h"
+#include "orchestrator/workflow/agent_pool.h"
+#include "orchestrator/workflow/result_codec.h"
+#include "orchestrator/workflow/step_history.h"
+#include "orchestrator/workflow/step_result_cache.h"
+#include "orchestrator/workflow/work_stealing_pool.h"
+#include "orchestrator/workflow/workflow_plan.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+using integration::ExecutionContext;
+using integration::ExecutionResult;
+using integration::Workflow;
+using integration::WorkflowCallback;
+using integration::WorkflowStep;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* kCheckpointExtension = ".ckpt";
+
+// Finished executions kept for status and result queries
+constexpr size_t kMaxRetainedExecutions = 1024;
+
+// Substitute ${name} references with context variables, falling back to the
+// workflow's globalParams; unknown names are left as written
+std::map<std::string, std::string> resolveParameters(const std::map<std::string, std::string>& parameters,
+                                                     const std::map<std::string, std::string>& variables,
+                                                     const std::map<std::string, std::string>& globalParams) {
+    std::map<std::string, std::string> resolved;
+    for (const auto& [key, value] : parameters) {
+        auto start = value.find("${");
+        if (start == std::string::npos) {
+            resolved.emplace_hint(resolved.end(), key, value);
+            continue;
+        }
+
+        std::string out;
+        size_t pos = 0;
+        while (start != std::string::npos) {
+            auto end = value.find('}', start + 2);
+            if (end == std::string::npos) {
+                break;
+            }
+            out.append(value, pos, start - pos);
+            auto name = value.substr(start + 2, end - start - 2);
+            auto it = variables.find(name);
+            if (it != variables.end()) {
+                out += it->second;
+            } else if ((it = globalParams.find(name)) != globalParams.end()) {
+                out += it->second;
+            } else {
+                out.append(value, start, end - start + 1);
+            }
+            pos = end + 1;
+            start = value.find("${", pos);
+        }
+        out.append(value, pos, std::string::npos);
+        resolved.emplace_hint(resolved.end(), key, std::move(out));
+    }
+    return resolved;
+}
+
+} // namespace
+
+// Private implementation class (PIMPL idiom)
+class WorkflowExecutor::Impl {
+public:
+    enum class StepStatus {
+        PENDING,
+        RUNNING,
+        COMPLETED,
+        FAILED,
+        SKIPPED,
+        CANCELLED
+    };
+
+    using StepIndex = WorkflowPlan::StepIndex;
+
+    struct Definition {
+        std::shared_ptr<const WorkflowPlan> plan;
+        // StepHistory slot of each step's action
+        std::shared_ptr<const std::vector<StepHistory::Slot>> actionSlots;
+    };
+
+    struct ReadyStep {
+        double remainingPath = 0.0;
+        uint64_t sequence = 0;
+        StepIndex index = 0;
+    };
+
+    // Longest remaining path first, then first come first served
+    struct ReadyOrder {
+        bool operator()(const ReadyStep& a, const ReadyStep& b) const {
+            if (a.remainingPath != b.remainingPath) {
+                return a.remainingPath < b.remainingPath;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    struct Execution {
+        std::string id;
+        std::shared_ptr<const WorkflowPlan> plan;
+        std::shared_ptr<const std::vector<StepHistory::Slot>> actionSlots;
+        ExecutionContext context;
+        WorkflowCallback callback;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point endTime;
+
+        // Parent of the running steps' tokens; cancelled by cancelExecution()
+        CancellationToken cancellation;
+
+        // Checkpoint of an earlier run this execution resumes; removed on completion
+        std::string resumedFrom;
+
+        // Finished execution whose results are reused by a re-execution, and
+        // the index of each step in it (-1 if the step is new)
+        std::shared_ptr<const Execution> baseline;
+        std::vector<int64_t> baselineIndex;
+
+        // Expected microseconds from each step to the end of the workflow
+        // along its longest path; ready steps with more work behind them go first
+        std::vector<double> remainingPath;
+
+        // Guarded by mutex
+        mutable std::mutex mutex;
+        std::condition_variable finishedCv;
+        std::vector<StepIndex> remaining;
+        std::vector<StepStatus> stepStatus;
+        std::vector<ExecutionResult> results;
+        // Hash of each started step's action, resolved parameters and inputs;
+        // written once by the thread running the step
+        std::vector<std::string> fingerprints;
+        size_t inFlight = 0;
+        bool cancelled = false;
+        bool failed = false;
+        bool finished = false;
+        std::string status = "running";
+        std::string errorMessage;
+        std::chrono::steady_clock::time_point lastCheckpoint;
+        uint64_t checkpointSequence = 0;
+
+        // Serializes checkpoint writes; a snapshot older than the last one written is dropped
+        std::mutex checkpointMutex;
+        uint64_t writtenSequence = 0;
+
+        // Steps whose dependencies are done, waiting for a pool thread
+        std::mutex readyMutex;
+        std::priority_queue<ReadyStep, std::vector<ReadyStep>, ReadyOrder> ready;
+        uint64_t readySequence = 0;
+    };
+
+    // A step past its reuse and cache checks, with the attempts running it
+    struct RunningStep {
+        std::shared_ptr<Execution> execution;
+        StepIndex index = 0;
+        StepInvocation invocation;
+        std::shared_ptr<StepResultCache> cache;
+        std::string cacheKey;
+
+        // Child of the execution's token, with the step's timeout as deadline;
+        // also cancelled once the step has its result
+        CancellationToken cancellation;
+
+        // Pool the attempts' agents come from; null if agents are not assigned
+        std::shared_ptr<AgentPool> agentPool;
+
+        // Guarded by mutex
+        std::mutex mutex;
+        std::vector<std::string> agents;  // Agent of each attempt
+        int attempts = 1;
+        int running = 1;
+        bool done = false;
+    };
+
+    enum class TimerKind {
+        SPECULATE,  // Start a duplicate if the step is still running
+        TIMEOUT     // Fail the step if it is still running
+    };
+
+    struct StepTimer {
+        std::weak_ptr<RunningStep> running;
+        TimerKind kind = TimerKind::SPECULATE;
+    };
+
+    Impl(StepRunner runner, size_t threadCount)
+        : runner_(std::move(runner)), pool_(std::make_unique<WorkStealingPool>(threadCount)),
+          instanceTag_(generateInstanceTag()),
+          speculationOptions_(std::make_shared<const SpeculationOptions>()) {
+        timerThread_ = std::thread(&Impl::timerLoop, this);
+    }
+
+    ~Impl() {
+        std::vector<std::shared_ptr<Execution>> executions;
+        {
+            std::lock_guard<std::mutex> lock(executionsMutex_);
+            for (auto& [id, execution] : executions_) {
+                executions.push_back(execution);
+            }
+        }
+        for (auto& execution : executions) {
+            {
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                execution->cancelled = true;
+            }
+            execution->cancellation.cancel("executor shutting down");
+        }
+        {
+            std::lock_guard<std::mutex> lock(timerMutex_);
+            stopTimers_ = true;
+        }
+        timerCv_.notify_all();
+        timerThread_.join();
+
+        // Queued steps see the cancellation and are skipped while the pool drains
+        pool_->stop();
+    }
+
+    bool defineWorkflow(const Workflow& workflow) {
+        if (workflow.workflowId.empty()) {
+            return false;
+        }
+
+        // Validation, ordering and ID resolution happen once here, not per execution
+        std::string error;
+        Definition definition;
+        definition.plan = WorkflowPlan::compile(workflow, error);
+        if (!definition.plan) {
+            return false;
+        }
+
+        auto actionSlots = std::make_shared<std::vector<StepHistory::Slot>>();
+        actionSlots->reserve(workflow.steps.size());
+        for (const auto& step : workflow.steps) {
+            actionSlots->push_back(history_.intern(step.agentType + "/" + step.action));
+        }
+        definition.actionSlots = std::move(actionSlots);
+
+        std::lock_guard<std::mutex> lock(plansMutex_);
+        plans_[workflow.workflowId] = std::move(definition);
+        return true;
+    }
+
+    std::string executeWorkflow(const std::string& workflowId,
+                                const ExecutionContext& context,
+                                WorkflowCallback callback,
+                                std::shared_ptr<const Execution> baseline = nullptr,
+                                const std::string& resumedFrom = "") {
+        Definition definition;
+        {
+            std::lock_guard<std::mutex> lock(plansMutex_);
+            auto it = plans_.find(workflowId);
+            if (it == plans_.end()) {
+                return "";
+            }
+            definition = it->second;
+        }
+        const auto& plan = definition.plan;
+
+        auto execution = std::make_shared<Execution>();
+        // The instance tag keeps IDs, and thus checkpoint files, unique across restarts
+        execution->id = workflowId + "-" + instanceTag_ + "-" + std::to_string(++executionCounter_);
+        execution->resumedFrom = resumedFrom;
+        execution->plan = plan;
+        execution->actionSlots = definition.actionSlots;
+        execution->context = context;
+        execution->callback = std::move(callback);
+        execution->startTime = std::chrono::steady_clock::now();
+        execution->lastCheckpoint = execution->startTime;
+        execution->cancellation = CancellationToken::create();
+
+        execution->remaining = plan->inDegrees();
+        execution->stepStatus.assign(plan->stepCount(), StepStatus::PENDING);
+        execution->results.resize(plan->stepCount());
+        execution->fingerprints.resize(plan->stepCount());
+        if (baseline) {
+            // Steps are matched by ID, so the workflow may have been redefined in between
+            execution->baselineIndex.assign(plan->stepCount(), -1);
+            for (StepIndex i = 0; i < plan->stepCount(); ++i) {
+                WorkflowPlan::StepIndex previous = 0;
+                if (baseline->plan->findStep(plan->step(i).stepId, previous)) {
+                    execution->baselineIndex[i] = previous;
+                }
+            }
+            execution->baseline = std::move(baseline);
+        }
+        computeRemainingPath(*execution);
+        const auto& roots = plan->roots();
+        execution->inFlight = roots.size();
+
+        {
+            std::lock_guard<std::mutex> lock(executionsMutex_);
+            executions_[execution->id] = execution;
+        }
+        executionsStarted_++;
+
+        if (roots.empty()) {
+            finish(execution);
+        } else {
+            launch(execution, roots);
+        }
+        return execution->id;
+    }
+
+    std::string reexecuteWorkflow(const std::string& executionId,
+                                  const ExecutionContext& context,
+                                  WorkflowCallback callback) {
+        auto baseline = findExecution(executionId);
+        if (!baseline) {
+            return "";
+        }
+        {
+            std::lock_guard<std::mutex> lock(baseline->mutex);
+            if (!baseline->finished) {
+                return "";
+            }
+        }
+        auto workflowId = baseline->plan->workflow().workflowId;
+        return executeWorkflow(workflowId, context, std::move(callback), std::move(baseline));
+    }
+
+    void setSpeculationOptions(const SpeculationOptions& options) {
+        std::atomic_store(&speculationOptions_, std::make_shared<const SpeculationOptions>(options));
+    }
+
+    void setCheckpointOptions(const CheckpointOptions& options) {
+        if (!options.directory.empty()) {
+            std::error_code ec;
+            fs::create_directories(options.directory, ec);
+        }
+        std::atomic_store(&checkpointOptions_, std::make_shared<const CheckpointOptions>(options));
+    }
+
+    std::string resumeExecution(const std::string& executionId, WorkflowCallback callback) {
+        auto options = std::atomic_load(&checkpointOptions_);
+        if (!options || options->directory.empty()) {
+            return "";
+        }
+
+        ExecutionCheckpoint checkpoint;
+        std::ifstream in(checkpointPath(*options, executionId), std::ios::binary);
+        if (!in) {
+            return "";
+        }
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!ResultCodec::decodeCheckpoint(bytes, checkpoint)) {
+            return "";
+        }
+
+        std::shared_ptr<const WorkflowPlan> plan;
+        {
+            std::lock_guard<std::mutex> lock(plansMutex_);
+            auto it = plans_.find(checkpoint.workflowId);
+            if (it == plans_.end()) {
+                return "";
+            }
+            plan = it->second.plan;
+        }
+
+        // A finished execution holding the saved steps serves as the baseline
+        auto baseline = std::make_shared<Execution>();
+        baseline->id = checkpoint.executionId;
+        baseline->plan = plan;
+        baseline->stepStatus.assign(plan->stepCount(), StepStatus::PENDING);
+        baseline->results.resize(plan->stepCount());
+        baseline->fingerprints.resize(plan->stepCount());
+        baseline->finished = true;
+        for (auto& step : checkpoint.completedSteps) {
+            WorkflowPlan::StepIndex index = 0;
+            if (plan->findStep(step.stepId, index)) {
+                baseline->stepStatus[index] = StepStatus::COMPLETED;
+                baseline->fingerprints[index] = std::move(step.fingerprint);
+                baseline->results[index] = std::move(step.result);
+            }
+        }
+
+        return executeWorkflow(checkpoint.workflowId, checkpoint.context, std::move(callback),
+                               std::move(baseline), checkpoint.executionId);
+    }
+
+    std::vector<std::string> listCheckpoints() const {
+        std::vector<std::string> ids;
+        auto options = std::atomic_load(&checkpointOptions_);
+        if (!options || options->directory.empty()) {
+            return ids;
+        }
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(options->directory, ec)) {
+            if (entry.path().extension() == kCheckpointExtension) {
+                ids.push_back(entry.path().stem().string());
+            }
+        }
+        return ids;
+    }
+
+    std::string getExecutionStatus(const std::string& executionId) const {
+        auto execution = findExecution(executionId);
+        if (!execution) {
+            return "unknown";
+        }
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        return execution->status;
+    }
+
+    ExecutionResult getExecutionResults(const std::string& executionId) const {
+        ExecutionResult result{};
+        auto execution = findExecution(executionId);
+        if (!execution) {
+            result.success = false;
+            result.errorMessage = "Unknown execution: " + executionId;
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        const auto& steps = execution->plan->workflow().steps;
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (execution->stepStatus[i] != StepStatus::COMPLETED) {
+                continue;
+            }
+            const auto& stepResult = execution->results[i];
+            result.outputs[steps[i].stepId] = stepResult.resultData;
+            for (const auto& [key, value] : stepResult.outputs) {
+                result.outputs[steps[i].stepId + "." + key] = value;
+            }
+        }
+
+        result.success = execution->status == "completed";
+        result.errorMessage = execution->errorMessage;
+        auto end = execution->finished ? execution->endTime : std::chrono::steady_clock::now();
+        result.executionTime =
+            std::chrono::duration_cast<std::chrono::milliseconds>(end - execution->startTime);
+        return result;
+    }
+
+    bool cancelExecution(const std::string& executionId) {
+        auto execution = findExecution(executionId);
+        if (!execution) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            if (execution->finished || execution->cancelled) {
+                return false;
+            }
+            execution->cancelled = true;
+        }
+        // Outside the lock: callbacks registered by runners run on this thread
+        execution->cancellation.cancel("execution cancelled");
+        return true;
+    }
+
+    bool waitForExecution(const std::string& executionId, std::chrono::milliseconds timeout) const {
+        auto execution = findExecution(executionId);
+        if (!execution) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(execution->mutex);
+        return execution->finishedCv.wait_for(lock, timeout, [&]() { return execution->finished; });
+    }
+
+    void setResultCache(std::shared_ptr<StepResultCache> cache) {
+        std::atomic_store(&resultCache_, std::move(cache));
+    }
+
+    void setAgentPool(std::shared_ptr<AgentPool> pool) {
+        std::atomic_store(&agentPool_, std::move(pool));
+    }
+
+    void setActionVersion(const std::string& agentType, const std::string& action,
+                          const std::string& version) {
+        std::lock_guard<std::mutex> lock(versionsMutex_);
+        if (version.empty()) {
+            actionVersions_.erase(agentType + "/" + action);
+        } else {
+            actionVersions_[agentType + "/" + action] = version;
+        }
+    }
+
+    std::map<std::string, double> getStatistics() const {
+        std::map<std::string, double> stats;
+        stats["executions_started"] = static_cast<double>(executionsStarted_.load());
+        stats["executions_completed"] = static_cast<double>(executionsCompleted_.load());
+        stats["executions_failed"] = static_cast<double>(executionsFailed_.load());
+        stats["executions_cancelled"] = static_cast<double>(executionsCancelled_.load());
+        stats["steps_completed"] = static_cast<double>(stepsCompleted_.load());
+        stats["steps_failed"] = static_cast<double>(stepsFailed_.load());
+        stats["steps_skipped"] = static_cast<double>(stepsSkipped_.load());
+        stats["steps_cancelled"] = static_cast<double>(stepsCancelled_.load());
+        stats["steps_timed_out"] = static_cast<double>(stepsTimedOut_.load());
+        stats["steps_memoized"] = static_cast<double>(stepsMemoized_.load());
+        stats["steps_reused"] = static_cast<double>(stepsReused_.load());
+        stats["speculative_attempts"] = static_cast<double>(speculativeAttempts_.load());
+        stats["speculative_wins"] = static_cast<double>(speculativeWins_.load());
+        stats["checkpoints_written"] = static_cast<double>(checkpointsWritten_.load());
+        stats["checkpoint_errors"] = static_cast<double>(checkpointErrors_.load());
+        stats["pool_threads"] = static_cast<double>(pool_->threadCount());
+        stats["pool_tasks"] = static_cast<double>(pool_->executed());
+        stats["pool_steals"] = static_cast<double>(pool_->steals());
+        return stats;
+    }
+
+private:
+    bool reusable(const Execution& execution, StepIndex index, const std::string& fingerprint,
+                  ExecutionResult& result) const {
+        if (!execution.baseline || execution.baselineIndex[index] < 0) {
+            return false;
+        }
+        const auto& baseline = *execution.baseline;
+        auto previous = static_cast<size_t>(execution.baselineIndex[index]);
+        std::lock_guard<std::mutex> lock(baseline.mutex);
+        if (baseline.stepStatus[previous] != StepStatus::COMPLETED ||
+            baseline.fingerprints[previous] != fingerprint) {
+            return false;
+        }
+        result = baseline.results[previous];
+        return true;
+    }
+
+    // "<agentType>/<action>@<version>", or empty if the action is not memoized
+    std::string versionedAction(const WorkflowStep& step) const {
+        std::string action = step.agentType + "/" + step.action;
+        std::lock_guard<std::mutex> lock(versionsMutex_);
+        auto it = actionVersions_.find(action);
+        if (it == actionVersions_.end()) {
+            return "";
+        }
+        return action + "@" + it->second;
+    }
+
+    std::shared_ptr<Execution> findExecution(const std::string& executionId) const {
+        std::lock_guard<std::mutex> lock(executionsMutex_);
+        auto it = executions_.find(executionId);
+        return it == executions_.end() ? nullptr : it->second;
+    }
+
+    void computeRemainingPath(Execution& execution) const {
+        const auto& plan = *execution.plan;
+        std::vector<double> expected;
+        history_.expectedMicros(*execution.actionSlots, expected);
+
+        execution.remainingPath.assign(plan.stepCount(), 0.0);
+        const auto& order = plan.topologicalOrder();
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            double longest = 0.0;
+            for (StepIndex successor : plan.successors(*it)) {
+                longest = std::max(longest, execution.remainingPath[successor]);
+            }
+            execution.remainingPath[*it] = expected[*it] + longest;
+        }
+    }
+
+    void launch(const std::shared_ptr<Execution>& execution, const std::vector<StepIndex>& steps) {
+        if (steps.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(execution->readyMutex);
+            for (StepIndex step : steps) {
+                execution->ready.push(ReadyStep{execution->remainingPath[step], execution->readySequence++, step});
+            }
+        }
+        readySteps_.fetch_add(steps.size(), std::memory_order_relaxed);
+        // Each pool task runs whichever of the execution's ready steps ranks
+        // highest when it starts. Tasks submitted from a worker stay on its
+        // deque, so successors still tend to run where their inputs were made.
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (!pool_->submit([this, execution]() { runNextReady(execution); })) {
+                // Pool is stopping; account for the step so the execution still finishes
+                StepIndex next = 0;
+                if (popReady(*execution, next)) {
+                    skipStep(execution, next);
+                }
+            }
+        }
+    }
+
+    bool popReady(Execution& execution, StepIndex& next) {
+        {
+            std::lock_guard<std::mutex> lock(execution.readyMutex);
+            if (execution.ready.empty()) {
+                return false;
+            }
+            next = execution.ready.top().index;
+            execution.ready.pop();
+        }
+        readySteps_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void runNextReady(const std::shared_ptr<Execution>& execution) {
+        StepIndex next = 0;
+        if (popReady(*execution, next)) {
+            runStep(execution, next);
+        }
+    }
+
+    void runStep(const std::shared_ptr<Execution>& execution, StepIndex index) {
+        bool skip = false;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            skip = execution->cancelled || execution->failed;
+            if (!skip) {
+                execution->stepStatus[index] = StepStatus::RUNNING;
+            }
+        }
+        if (skip) {
+            skipStep(execution, index);
+            return;
+        }
+
+        const auto& plan = *execution->plan;
+        const auto& step = plan.step(index);
+        emit(execution, step.stepId, "step_started", "");
+
+        StepInvocation invocation;
+        invocation.executionId = execution->id;
+        invocation.step = &step;
+        invocation.context = &execution->context;
+        invocation.globalParams = &plan.workflow().globalParams;
+        invocation.parameters = resolveParameters(step.parameters, execution->context.variables,
+                                                  plan.workflow().globalParams);
+        // Dependency results were written under the mutex before this step became ready
+        auto dependencies = plan.dependencies(index);
+        invocation.inputs.reserve(dependencies.size());
+        for (StepIndex dependency : dependencies) {
+            invocation.inputs.push_back(&execution->results[dependency]);
+        }
+
+        // Everything the step's result may depend on, including the action's
+        // version if one is set; an unchanged fingerprint lets a re-execution
+        // keep the previous result
+        auto actionId = versionedAction(step);
+        const auto& fingerprint = execution->fingerprints[index] =
+            StepResultCache::makeKey(actionId.empty() ? step.agentType + "/" + step.action : actionId,
+                                     invocation.parameters, invocation.inputs);
+        ExecutionResult previous{};
+        if (reusable(*execution, index, fingerprint, previous)) {
+            stepsReused_++;
+            emit(execution, step.stepId, "step_completed", previous.resultData);
+            completeStep(execution, index, std::move(previous));
+            return;
+        }
+
+        std::string cacheKey;
+        auto cache = std::atomic_load(&resultCache_);
+        if (cache) {
+            if (!actionId.empty()) {
+                cacheKey = fingerprint;
+                ExecutionResult cached{};
+                if (cache->lookup(cacheKey, cached)) {
+                    stepsMemoized_++;
+                    emit(execution, step.stepId, "step_completed", cached.resultData);
+                    completeStep(execution, index, std::move(cached));
+                    return;
+                }
+            }
+        }
+
+        auto running = std::make_shared<RunningStep>();
+        running->execution = execution;
+        running->index = index;
+        running->invocation = std::move(invocation);
+        running->cache = std::move(cache);
+        running->cacheKey = std::move(cacheKey);
+        if (step.timeout.count() > 0) {
+            auto deadline = std::chrono::steady_clock::now() + step.timeout;
+            running->cancellation = execution->cancellation.child(deadline);
+            scheduleTimer(running, deadline, TimerKind::TIMEOUT);
+        } else {
+            running->cancellation = execution->cancellation.child();
+        }
+
+        std::string agentId;
+        if (auto pool = std::atomic_load(&agentPool_)) {
+            agentId = pool->acquire(step.agentType, fingerprint);
+            if (!agentId.empty()) {
+                running->agentPool = std::move(pool);
+                running->agents.push_back(agentId);
+            }
+        }
+        armSpeculation(running);
+        runAttempt(running, 0, agentId);
+    }
+
+    void runAttempt(const std::shared_ptr<RunningStep>& running, int attempt, const std::string& agentId) {
+        StepInvocation invocation = running->invocation;
+        invocation.attempt = attempt;
+        invocation.agentId = agentId;
+        invocation.cancellation = running->cancellation;
+
+        ExecutionResult result{};
+        auto started = std::chrono::steady_clock::now();
+        try {
+            result = runner_(invocation);
+        } catch (const std::exception& e) {
+            result = ExecutionResult{};
+            result.success = false;
+            result.errorMessage = e.what();
+        } catch (...) {
+            result = ExecutionResult{};
+            result.success = false;
+            result.errorMessage = "Unknown exception in step runner";
+        }
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        result.executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+        if (!agentId.empty()) {
+            running->agentPool->release(agentId);
+        }
+
+        {
+            // First success wins; a failure counts only once no other attempt is left
+            std::lock_guard<std::mutex> lock(running->mutex);
+            if (running->done) {
+                return;
+            }
+            if (!result.success && running->running > 1) {
+                running->running--;
+                return;
+            }
+            running->done = true;
+        }
+        // Tells attempts still running to stop
+        running->cancellation.cancel("step finished");
+
+        const auto& execution = running->execution;
+        auto index = running->index;
+        if (!result.success && execution->cancellation.isCancelled()) {
+            cancelStep(execution, index);
+            return;
+        }
+        if (result.success) {
+            if (attempt > 0) {
+                speculativeWins_++;
+            }
+            history_.record((*execution->actionSlots)[index],
+                            std::chrono::duration<double, std::micro>(elapsed).count());
+            if (!running->cacheKey.empty()) {
+                running->cache->store(running->cacheKey, result);
+            }
+        }
+
+        bool success = result.success;
+        emit(execution, execution->plan->step(index).stepId, success ? "step_completed" : "step_failed",
+             success ? result.resultData : result.errorMessage);
+        completeStep(execution, index, std::move(result));
+    }
+
+    // Schedule a straggler check for a step that is about to run
+    void armSpeculation(const std::shared_ptr<RunningStep>& running) {
+        auto options = std::atomic_load(&speculationOptions_);
+        if (!options->enabled || options->maxSpeculativeAttempts < 1) {
+            return;
+        }
+        double thresholdMicros = 0.0;
+        auto slot = (*running->execution->actionSlots)[running->index];
+        if (!history_.percentileMicros(slot, options->percentile, options->minSamples, thresholdMicros)) {
+            return;
+        }
+
+        auto delay = std::max<std::chrono::steady_clock::duration>(
+            options->minDelay,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(thresholdMicros * options->multiplier)));
+        scheduleTimer(running, std::chrono::steady_clock::now() + delay, TimerKind::SPECULATE);
+    }
+
+    void scheduleTimer(const std::shared_ptr<RunningStep>& running,
+                       std::chrono::steady_clock::time_point deadline, TimerKind kind) {
+        {
+            std::lock_guard<std::mutex> lock(timerMutex_);
+            stepTimers_.emplace(deadline, StepTimer{running, kind});
+        }
+        timerCv_.notify_one();
+    }
+
+    void timerLoop() {
+        std::unique_lock<std::mutex> lock(timerMutex_);
+        while (!stopTimers_) {
+            if (stepTimers_.empty()) {
+                timerCv_.wait(lock);
+                continue;
+            }
+            auto deadline = stepTimers_.begin()->first;
+            if (std::chrono::steady_clock::now() < deadline) {
+                timerCv_.wait_until(lock, deadline);
+                continue;
+            }
+
+            auto running = stepTimers_.begin()->second.running.lock();
+            auto kind = stepTimers_.begin()->second.kind;
+            stepTimers_.erase(stepTimers_.begin());
+            if (running) {
+                lock.unlock();
+                if (kind == TimerKind::TIMEOUT) {
+                    expire(running);
+                } else {
+                    speculate(running);
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    // Fail a step that is still running at its timeout; attempts that return
+    // later are ignored
+    void expire(const std::shared_ptr<RunningStep>& running) {
+        {
+            std::lock_guard<std::mutex> lock(running->mutex);
+            if (running->done) {
+                return;
+            }
+            running->done = true;
+        }
+        running->cancellation.cancel("step timed out");
+
+        const auto& execution = running->execution;
+        auto index = running->index;
+        if (execution->cancellation.isCancelled()) {
+            cancelStep(execution, index);
+            return;
+        }
+
+        const auto& step = execution->plan->step(index);
+        ExecutionResult result{};
+        result.success = false;
+        result.errorMessage = "Timed out after " + std::to_string(step.timeout.count()) + " ms";
+        result.executionTime = step.timeout;
+        stepsTimedOut_++;
+        emit(execution, step.stepId, "step_failed", result.errorMessage);
+        completeStep(execution, index, std::move(result));
+    }
+
+    void speculate(const std::shared_ptr<RunningStep>& running) {
+        auto options = std::atomic_load(&speculationOptions_);
+        if (readySteps_.load(std::memory_order_relaxed) > 0) {
+            // Real work is waiting for a thread; look again a little later
+            scheduleTimer(running, std::chrono::steady_clock::now() + options->minDelay, TimerKind::SPECULATE);
+            return;
+        }
+
+        const auto& execution = running->execution;
+        const auto& step = execution->plan->step(running->index);
+        int attempt = 0;
+        std::string agentId;
+        {
+            std::lock_guard<std::mutex> lock(running->mutex);
+            if (running->done || running->cancellation.isCancelled() ||
+                running->attempts > options->maxSpeculativeAttempts) {
+                return;
+            }
+            if (running->agentPool) {
+                // A duplicate on an agent that already runs the step would not help
+                agentId = running->agentPool->acquire(step.agentType, execution->fingerprints[running->index],
+                                                      running->agents);
+                if (agentId.empty()) {
+                    return;
+                }
+                running->agents.push_back(agentId);
+            }
+            attempt = running->attempts++;
+            running->running++;
+        }
+
+        emit(execution, step.stepId, "step_speculated", std::to_string(attempt));
+        if (!pool_->submit([this, running, attempt, agentId]() { runAttempt(running, attempt, agentId); })) {
+            if (!agentId.empty()) {
+                running->agentPool->release(agentId);
+            }
+            std::lock_guard<std::mutex> lock(running->mutex);
+            running->running--;
+            return;
+        }
+        speculativeAttempts_++;
+
+        if (attempt < options->maxSpeculativeAttempts) {
+            armSpeculation(running);
+        }
+    }
+
+    void skipStep(const std::shared_ptr<Execution>& execution, StepIndex index) {
+        stepsSkipped_++;
+        emit(execution, execution->plan->step(index).stepId, "step_skipped", "");
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->stepStatus[index] = StepStatus::SKIPPED;
+            done = --execution->inFlight == 0;
+        }
+        if (done) {
+            finish(execution);
+        }
+    }
+
+    // A running step that gave up because its execution was cancelled
+    void cancelStep(const std::shared_ptr<Execution>& execution, StepIndex index) {
+        stepsCancelled_++;
+        emit(execution, execution->plan->step(index).stepId, "step_cancelled", "");
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->stepStatus[index] = StepStatus::CANCELLED;
+            done = --execution->inFlight == 0;
+        }
+        if (done) {
+            finish(execution);
+        } else {
+            checkpoint(execution, false);
+        }
+    }
+
+    void completeStep(const std::shared_ptr<Execution>& execution, StepIndex index, ExecutionResult result) {
+        std::vector<StepIndex> ready;
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            bool success = result.success;
+            if (success) {
+                execution->stepStatus[index] = StepStatus::COMPLETED;
+                stepsCompleted_++;
+            } else {
+                execution->stepStatus[index] = StepStatus::FAILED;
+                stepsFailed_++;
+                if (!execution->failed) {
+                    execution->failed = true;
+                    execution->errorMessage =
+                        execution->plan->step(index).stepId + ": " + result.errorMessage;
+                }
+            }
+            execution->results[index] = std::move(result);
+
+            if (success && !execution->cancelled && !execution->failed) {
+                for (StepIndex successor : execution->plan->successors(index)) {
+                    if (--execution->remaining[successor] == 0) {
+                        ready.push_back(successor);
+                    }
+                }
+            }
+            execution->inFlight += ready.size();
+            done = --execution->inFlight == 0;
+        }
+
+        if (done) {
+            finish(execution);
+        } else {
+            launch(execution, ready);
+            checkpoint(execution, false);
+        }
+    }
+
+    // Save the execution's completed steps if checkpointing is on and, unless
+    // forced, the interval has passed since the last save
+    void checkpoint(const std::shared_ptr<Execution>& execution, bool force) {
+        auto options = std::atomic_load(&checkpointOptions_);
+        if (!options || options->directory.empty()) {
+            return;
+        }
+
+        ExecutionCheckpoint snapshot;
+        uint64_t sequence = 0;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            auto now = std::chrono::steady_clock::now();
+            if (!force && now - execution->lastCheckpoint < options->interval) {
+                return;
+            }
+            execution->lastCheckpoint = now;
+            sequence = ++execution->checkpointSequence;
+
+            snapshot.executionId = execution->id;
+            snapshot.workflowId = execution->plan->workflow().workflowId;
+            snapshot.context = execution->context;
+            for (size_t i = 0; i < execution->stepStatus.size(); ++i) {
+                if (execution->stepStatus[i] == StepStatus::COMPLETED) {
+                    snapshot.completedSteps.push_back(
+                        {execution->plan->step(static_cast<StepIndex>(i)).stepId,
+                         execution->fingerprints[i], execution->results[i]});
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(execution->checkpointMutex);
+        if (sequence < execution->writtenSequence) {
+            return;
+        }
+        auto path = checkpointPath(*options, execution->id);
+        auto tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            auto bytes = ResultCodec::encodeCheckpoint(snapshot);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!out) {
+                checkpointErrors_++;
+                return;
+            }
+        }
+        // Rename so that a crash mid-write leaves the previous checkpoint intact
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        if (ec) {
+            checkpointErrors_++;
+            return;
+        }
+        execution->writtenSequence = sequence;
+        checkpointsWritten_++;
+    }
+
+    // Remove the checkpoints of a completed execution and of the run it resumed
+    void dropCheckpoints(const std::shared_ptr<Execution>& execution) {
+        auto options = std::atomic_load(&checkpointOptions_);
+        if (!options || options->directory.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(execution->checkpointMutex);
+        // Later snapshots of this execution must not recreate the file
+        execution->writtenSequence = std::numeric_limits<uint64_t>::max();
+        std::error_code ec;
+        fs::remove(checkpointPath(*options, execution->id), ec);
+        if (!execution->resumedFrom.empty()) {
+            fs::remove(checkpointPath(*options, execution->resumedFrom), ec);
+        }
+    }
+
+    static std::string checkpointPath(const CheckpointOptions& options, const std::string& executionId) {
+        return (fs::path(options.directory) / (executionId + kCheckpointExtension)).string();
+    }
+
+    static std::string generateInstanceTag() {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> dis(0, 15);
+
+        std::string tag;
+        for (int i = 0; i < 8; ++i) {
+            int val = dis(gen);
+            tag += static_cast<char>(val < 10 ? '0' + val : 'a' + val - 10);
+        }
+        return tag;
+    }
+
+    void finish(const std::shared_ptr<Execution>& execution) {
+        std::string event;
+        std::string data;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->endTime = std::chrono::steady_clock::now();
+            if (execution->failed) {
+                execution->status = "failed";
+                event = "workflow_failed";
+                data = execution->errorMessage;
+                executionsFailed_++;
+            } else if (execution->cancelled) {
+                execution->status = "cancelled";
+                event = "workflow_cancelled";
+                executionsCancelled_++;
+            } else {
+                execution->status = "completed";
+                event = "workflow_completed";
+                executionsCompleted_++;
+            }
+            // No step is left to reuse from it; don't keep the earlier run alive
+            execution->baseline.reset();
+            execution->baselineIndex.clear();
+        }
+
+        if (event == "workflow_completed") {
+            dropCheckpoints(execution);
+        } else {
+            checkpoint(execution, true);
+        }
+
+        emit(execution, "", event, data);
+
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->finished = true;
+        }
+        execution->finishedCv.notify_all();
+        retire(execution->id);
+    }
+
+    void retire(const std::string& executionId) {
+        std::lock_guard<std::mutex> lock(executionsMutex_);
+        finishedOrder_.push_back(executionId);
+        while (finishedOrder_.size() > kMaxRetainedExecutions) {
+            executions_.erase(finishedOrder_.front());
+            finishedOrder_.pop_front();
+        }
+    }
+
+    void emit(const std::shared_ptr<Execution>& execution, const std::string& stepId,
+              const std::string& event, const std::string& data) {
+        if (!execution->callback) {
+            return;
+        }
+        try {
+            execution->callback(execution->plan->workflow().workflowId, stepId, event, data);
+        } catch (...) {
+            // A throwing observer must not stall the execution
+        }
+    }
+
+    StepRunner runner_;
+    std::unique_ptr<WorkStealingPool> pool_;
+
+    std::mutex plansMutex_;
+    std::unordered_map<std::string, Definition> plans_;
+    StepHistory history_;
+
+    std::shared_ptr<StepResultCache> resultCache_;
+    std::shared_ptr<AgentPool> agentPool_;
+    mutable std::mutex versionsMutex_;
+    std::unordered_map<std::string, std::string> actionVersions_;
+
+    // Ready steps queued across all executions; speculation waits while any are
+    std::atomic<size_t> readySteps_{0};
+
+    mutable std::mutex executionsMutex_;
+    std::unordered_map<std::string, std::shared_ptr<Execution>> executions_;
+    std::deque<std::string> finishedOrder_;
+    std::string instanceTag_;
+    std::atomic<uint64_t> executionCounter_{0};
+
+    std::shared_ptr<const CheckpointOptions> checkpointOptions_;
+
+    std::shared_ptr<const SpeculationOptions> speculationOptions_;
+
+    // Straggler checks and step timeouts of running steps, keyed by when they fire
+    std::mutex timerMutex_;
+    std::condition_variable timerCv_;
+    std::multimap<std::chrono::steady_clock::time_point, StepTimer> stepTimers_;
+    bool stopTimers_ = false;
+    std::thread timerThread_;
+
+    std::atomic<uint64_t> executionsStarted_{0};
+    std::atomic<uint64_t> executionsCompleted_{0};
+    std::atomic<uint64_t> executionsFailed_{0};
+    std::atomic<uint64_t> executionsCancelled_{0};
+    std::atomic<uint64_t> stepsCompleted_{0};
+    std::atomic<uint64_t> stepsFailed_{0};
+    std::atomic<uint64_t> stepsSkipped_{0};
+    std::atomic<uint64_t> stepsCancelled_{0};
+    std::atomic<uint64_t> stepsTimedOut_{0};
+    std::atomic<uint64_t> stepsMemoized_{0};
+    std::atomic<uint64_t> stepsReused_{0};
+    std::atomic<uint64_t> speculativeAttempts_{0};
+    std::atomic<uint64_t> speculativeWins_{0};
+    std::atomic<uint64_t> checkpointsWritten_{0};
+    std::atomic<uint64_t> checkpointErrors_{0};
+};
+
+WorkflowExecutor::WorkflowExecutor(StepRunner runner, size_t threadCount)
+    : pImpl_(std::make_unique<Impl>(std::move(runner), threadCount)) {}
+
+WorkflowExecutor::~WorkflowExecutor() = default;
+
+bool WorkflowExecutor::defineWorkflow(const Workflow& workflow) {
+    return pImpl_->defineWorkflow(workflow);
+}
+
+std::string WorkflowExecutor::executeWorkflow(const std::string& workflowId,
+                                              const ExecutionContext& context,
+                                              WorkflowCallback callback) {
+    return pImpl_->executeWorkflow(workflowId, context, std::move(callback));
+}
+
+std::string WorkflowExecutor::reexecuteWorkflow(const std::string& executionId,
+                                                const ExecutionContext& context,
+                                                WorkflowCallback callback) {
+    return pImpl_->reexecuteWorkflow(executionId, context, std::move(callback));
+}
+
+void WorkflowExecutor::setSpeculationOptions(const SpeculationOptions& options) {
+    pImpl_->setSpeculationOptions(options);
+}
+
+void WorkflowExecutor::setCheckpointOptions(const CheckpointOptions& options) {
+    pImpl_->setCheckpointOptions(options);
+}
+
+std::string WorkflowExecutor::resumeExecution(const std::string& executionId, WorkflowCallback callback) {
+    return pImpl_->resumeExecution(executionId, std::move(callback));
+}
+
+std::vector<std::string> WorkflowExecutor::listCheckpoints() const {
+    return pImpl_->listCheckpoints();
+}
+
+std::string WorkflowExecutor::getExecutionStatus(const std::string& executionId) const {
+    return pImpl_->getExecutionStatus(executionId);
+}
+
+ExecutionResult WorkflowExecutor::getExecutionResults(const std::string& executionId) const {
+    return pImpl_->getExecutionResults(executionId);
+}
+
+bool WorkflowExecutor::cancelExecution(const std::string& executionId) {
+    return pImpl_->cancelExecution(executionId);
+}
+
+bool WorkflowExecutor::waitForExecution(const std::string& executionId,
+                                        std::chrono::milliseconds timeout) const {
+    return pImpl_->waitForExecution(executionId, timeout);
+}
+
+void WorkflowExecutor::setResultCache(std::shared_ptr<StepResultCache> cache) {
+    pImpl_->setResultCache(std::move(cache));
+}
+
+void WorkflowExecutor::setAgentPool(std::shared_ptr<AgentPool> pool) {
+    pImpl_->setAgentPool(std::move(pool));
+}
+
+void WorkflowExecutor::setActionVersion(const std::string& agentType, const std::string& action,
+                                        const std::string& version) {
+    pImpl_->setActionVersion(agentType, action, version);
+}
+
+std::map<std::string, double> WorkflowExecutor::getStatistics() const {
+    return pImpl_->getStatistics();
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
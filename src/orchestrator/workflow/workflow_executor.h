@@ -0,0 +1,302 @@
+#pragma once
+
+#include "orchestrator/cancellation_token.h"
+#include "orchestrator_interface.h"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+class AgentPool;
+class StepResultCache;
+
+/**
+ * @brief DAG executor for workflows
+ *
+ * Runs the steps of a defined workflow on a work-stealing pool. A step is
+ * launched as soon as all of its dependencies have completed, so independent
+ * branches run concurrently. When more steps are ready than there are pool
+ * threads, the step with the longest expected remaining path runs first,
+ * estimated from the historical durations of each agentType/action. The
+ * first failed step stops further launches; steps already running finish
+ * and the execution then reports failure. With a result cache set, steps of
+ * versioned actions are memoized and skipped when their inputs repeat.
+ *
+ * With speculation enabled, a step that runs much longer than its action
+ * usually takes gets a duplicate attempt while the pool has nothing else to
+ * run; the first successful attempt wins and the others are told to stop.
+ *
+ * With an agent pool set, every attempt of a step is assigned one of the
+ * registered agents of its agentType by that type's selection strategy,
+ * and speculative duplicates never reuse an agent of an earlier attempt.
+ *
+ * Each step gets a cancellation token that fires when its execution is
+ * cancelled or its WorkflowStep::timeout passes; a step that outlives its
+ * timeout fails without waiting for the runner to return.
+ *
+ * With checkpointing enabled, the completed steps of each running execution
+ * are saved to disk periodically, and an execution that was cancelled or
+ * lost in a crash can be resumed without recomputing them.
+ *
+ * Steps see variables and global parameters through ${name} references in
+ * their parameters. Memoization and re-execution assume that a step's result
+ * depends only on its action, resolved parameters and inputs.
+ * The workflow methods mirror those of AgentCoordinator, so an implementation
+ * of that interface can delegate to them; none exists in this tree yet.
+ */
+class WorkflowExecutor {
+public:
+    /**
+     * @brief Everything a step runner gets for one step
+     */
+    struct StepInvocation {
+        std::string executionId;
+        const integration::WorkflowStep* step = nullptr;
+        const integration::ExecutionContext* context = nullptr;
+        const std::map<std::string, std::string>* globalParams = nullptr;
+        // step->parameters with each ${name} replaced by the context variable
+        // or, failing that, the global parameter of that name
+        std::map<std::string, std::string> parameters;
+        // Results of step->dependencies, in the same order
+        std::vector<const integration::ExecutionResult*> inputs;
+        // 0 for the first run of the step, 1 and up for speculative duplicates
+        int attempt = 0;
+        // Agent chosen from the agent pool; empty without a pool or without
+        // registered agents of the step's agentType
+        std::string agentId;
+        // Cancelled when the execution is cancelled, the step's timeout passes
+        // (its deadline) or another attempt has produced the result; pass it
+        // on to resource waits, RPCs and simulations so they stop early
+        CancellationToken cancellation;
+    };
+
+    /**
+     * @brief Runs one step; called on a pool thread
+     *
+     * Exceptions are caught and reported as a failed step.
+     */
+    using StepRunner = std::function<integration::ExecutionResult(const StepInvocation&)>;
+
+    /**
+     * @brief Straggler speculation configuration
+     */
+    struct SpeculationOptions {
+        bool enabled = false;
+        double percentile = 0.95;                        // Percentile of the action's recent durations...
+        double multiplier = 1.5;                         // ...times this is the straggler threshold
+        size_t minSamples = 10;                          // History needed before an action is speculated
+        std::chrono::milliseconds minDelay{100};         // Never speculate earlier than this
+        int maxSpeculativeAttempts = 1;                  // Duplicates per step
+    };
+
+    /**
+     * @brief Checkpoint configuration
+     */
+    struct CheckpointOptions {
+        std::string directory;                         // Empty disables checkpointing
+        std::chrono::milliseconds interval{5000};      // Minimum time between saves of one execution
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param runner Step runner
+     * @param threadCount Number of pool threads (0 = hardware concurrency)
+     */
+    explicit WorkflowExecutor(StepRunner runner, size_t threadCount = 0);
+
+    /**
+     * @brief Destructor; cancels running executions and waits for their steps
+     */
+    ~WorkflowExecutor();
+
+    /**
+     * @brief Define or replace a workflow
+     *
+     * Rejects workflows with duplicate step IDs, unknown dependencies or cycles.
+     *
+     * @param workflow Workflow definition
+     * @return bool True if the workflow was accepted
+     */
+    bool defineWorkflow(const integration::Workflow& workflow);
+
+    /**
+     * @brief Start an execution of a defined workflow
+     *
+     * Events passed to the callback are "step_started", "step_speculated",
+     * "step_completed", "step_failed", "step_skipped", "step_cancelled",
+     * "workflow_completed", "workflow_failed" and "workflow_cancelled".
+     * Callbacks run on pool or timer threads.
+     *
+     * @param workflowId Workflow identifier
+     * @param context Execution context
+     * @param callback Progress callback
+     * @return std::string Execution ID, or empty if the workflow is unknown
+     */
+    std::string executeWorkflow(const std::string& workflowId,
+                                const integration::ExecutionContext& context,
+                                integration::WorkflowCallback callback = nullptr);
+
+    /**
+     * @brief Run a finished execution again, recomputing only what changed
+     *
+     * Uses the workflow's current definition and the given context. A step
+     * keeps its previous result when its action, resolved parameters and input
+     * results are unchanged, so only steps that read a changed variable or
+     * global parameter, and the steps whose inputs they change, run again.
+     *
+     * @param executionId Finished execution to start from
+     * @param context Execution context, typically with edited variables
+     * @param callback Progress callback
+     * @return std::string New execution ID, or empty if the execution is unknown or still running
+     */
+    std::string reexecuteWorkflow(const std::string& executionId,
+                                  const integration::ExecutionContext& context,
+                                  integration::WorkflowCallback callback = nullptr);
+
+    /**
+     * @brief Configure speculative re-execution of straggler steps
+     *
+     * A step is a straggler once it has run longer than the configured
+     * percentile of its agentType/action's recent durations times the
+     * multiplier. A duplicate is then started with StepInvocation::attempt
+     * incremented, if no other ready step is waiting for a pool thread.
+     * Steps are reported with the "step_speculated" event.
+     *
+     * @param options Speculation configuration
+     */
+    void setSpeculationOptions(const SpeculationOptions& options);
+
+    /**
+     * @brief Enable or disable checkpointing
+     *
+     * A running execution is saved to <directory>/<executionId>.ckpt when a
+     * step completes and the interval has passed since its last save, and
+     * again when it fails or is cancelled. The file is removed once the
+     * execution completes.
+     *
+     * @param options Checkpoint configuration
+     */
+    void setCheckpointOptions(const CheckpointOptions& options);
+
+    /**
+     * @brief Resume an execution from its last checkpoint
+     *
+     * The workflow must be defined. Steps recorded in the checkpoint whose
+     * action, resolved parameters and inputs are unchanged keep their saved
+     * results; all other steps run. The old checkpoint is removed when the
+     * resumed execution completes.
+     *
+     * @param executionId Execution identifier as saved in the checkpoint
+     * @param callback Progress callback
+     * @return std::string New execution ID, or empty if no usable checkpoint exists
+     */
+    std::string resumeExecution(const std::string& executionId,
+                                integration::WorkflowCallback callback = nullptr);
+
+    /**
+     * @brief List the executions that have a checkpoint on disk
+     *
+     * @return std::vector<std::string> Execution IDs
+     */
+    std::vector<std::string> listCheckpoints() const;
+
+    /**
+     * @brief Get the status of an execution
+     *
+     * @param executionId Execution identifier
+     * @return std::string "running", "completed", "failed", "cancelled" or "unknown"
+     */
+    std::string getExecutionStatus(const std::string& executionId) const;
+
+    /**
+     * @brief Get the results of an execution
+     *
+     * Outputs hold each completed step's resultData under its step ID and
+     * each of its outputs under "<stepId>.<key>".
+     *
+     * @param executionId Execution identifier
+     * @return integration::ExecutionResult Results so far
+     */
+    integration::ExecutionResult getExecutionResults(const std::string& executionId) const;
+
+    /**
+     * @brief Cancel an execution
+     *
+     * Steps that have not started are skipped. Running steps see their
+     * cancellation token fire; those that then return a failure are reported
+     * as "step_cancelled", and those that still succeed keep their results.
+     *
+     * @param executionId Execution identifier
+     * @return bool True if the execution was running
+     */
+    bool cancelExecution(const std::string& executionId);
+
+    /**
+     * @brief Wait for an execution to finish
+     *
+     * @param executionId Execution identifier
+     * @param timeout Maximum time to wait
+     * @return bool True if the execution finished within the timeout
+     */
+    bool waitForExecution(const std::string& executionId, std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief Set the cache for memoized step results
+     *
+     * Only steps whose action has a version set are looked up and stored.
+     * Keys cover the versioned action, resolved parameters and input results.
+     *
+     * @param cache Result cache, or nullptr to disable memoization
+     */
+    void setResultCache(std::shared_ptr<StepResultCache> cache);
+
+    /**
+     * @brief Set the pool that assigns agents to steps
+     *
+     * The pool's strategy for a step's agentType picks among its registered
+     * agents, with the step's fingerprint as affinity key so that repeated
+     * work lands where its cached state is. Each attempt counts as in flight
+     * on its agent until the runner returns. A step is only speculated while
+     * an agent without an attempt of it is left.
+     *
+     * @param pool Agent pool, or nullptr to leave agent choice to the runner
+     */
+    void setAgentPool(std::shared_ptr<AgentPool> pool);
+
+    /**
+     * @brief Mark an action as deterministic and set its version
+     *
+     * Steps of the action are memoized in the result cache. The version is part
+     * of the cache key and of the step fingerprint, so changing it invalidates
+     * all earlier results, including those reexecuteWorkflow() and
+     * resumeExecution() would otherwise keep.
+     *
+     * @param agentType Agent type of the steps
+     * @param action Step action
+     * @param version Version of the action's implementation; empty stops memoizing it
+     */
+    void setActionVersion(const std::string& agentType, const std::string& action,
+                          const std::string& version);
+
+    /**
+     * @brief Get executor statistics
+     *
+     * @return std::map<std::string, double> Execution, step and pool counters
+     */
+    std::map<std::string, double> getStatistics() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
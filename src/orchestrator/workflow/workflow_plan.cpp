@@ -0,0 +1,108 @@
+#include "orchestrator/workflow/workflow_plan.h"
+#include <limits>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+std::shared_ptr<const WorkflowPlan> WorkflowPlan::compile(const integration::Workflow& workflow,
+                                                          std::string& error) {
+    const auto& steps = workflow.steps;
+    if (steps.size() >= std::numeric_limits<StepIndex>::max()) {
+        error = "Too many steps";
+        return nullptr;
+    }
+
+    std::shared_ptr<WorkflowPlan> plan(new WorkflowPlan());
+    plan->stepIndex_.reserve(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (steps[i].stepId.empty()) {
+            error = "Step " + std::to_string(i) + " has no stepId";
+            return nullptr;
+        }
+        if (!plan->stepIndex_.emplace(steps[i].stepId, static_cast<StepIndex>(i)).second) {
+            error = "Duplicate stepId: " + steps[i].stepId;
+            return nullptr;
+        }
+    }
+
+    // Dependencies in CSR form, counting successors on the way
+    const StepIndex n = static_cast<StepIndex>(steps.size());
+    std::vector<StepIndex> successorCount(n, 0);
+    plan->dependencyOffsets_.reserve(n + 1);
+    plan->dependencyOffsets_.push_back(0);
+    plan->inDegree_.resize(n);
+    for (StepIndex i = 0; i < n; ++i) {
+        auto first = plan->dependencies_.size();
+        for (const auto& dependency : steps[i].dependencies) {
+            auto it = plan->stepIndex_.find(dependency);
+            if (it == plan->stepIndex_.end()) {
+                error = "Step " + steps[i].stepId + " depends on unknown step " + dependency;
+                return nullptr;
+            }
+            for (auto j = first; j < plan->dependencies_.size(); ++j) {
+                if (plan->dependencies_[j] == it->second) {
+                    error = "Step " + steps[i].stepId + " lists " + dependency + " twice";
+                    return nullptr;
+                }
+            }
+            plan->dependencies_.push_back(it->second);
+            successorCount[it->second]++;
+        }
+        plan->inDegree_[i] = static_cast<StepIndex>(plan->dependencies_.size() - first);
+        plan->dependencyOffsets_.push_back(static_cast<StepIndex>(plan->dependencies_.size()));
+        if (plan->inDegree_[i] == 0) {
+            plan->roots_.push_back(i);
+        }
+    }
+
+    // Transpose into successor CSR
+    plan->successorOffsets_.assign(n + 1, 0);
+    for (StepIndex i = 0; i < n; ++i) {
+        plan->successorOffsets_[i + 1] = plan->successorOffsets_[i] + successorCount[i];
+    }
+    plan->successors_.resize(plan->dependencies_.size());
+    std::vector<StepIndex> cursor(plan->successorOffsets_.begin(), plan->successorOffsets_.end() - 1);
+    for (StepIndex i = 0; i < n; ++i) {
+        for (auto dependency : plan->dependencies(i)) {
+            plan->successors_[cursor[dependency]++] = i;
+        }
+    }
+
+    // Kahn's algorithm; a cycle leaves steps that never reach in-degree zero
+    std::vector<StepIndex> remaining = plan->inDegree_;
+    plan->order_ = plan->roots_;
+    plan->order_.reserve(n);
+    for (size_t head = 0; head < plan->order_.size(); ++head) {
+        for (auto successor : plan->successors(plan->order_[head])) {
+            if (--remaining[successor] == 0) {
+                plan->order_.push_back(successor);
+            }
+        }
+    }
+    if (plan->order_.size() != n) {
+        for (StepIndex i = 0; i < n; ++i) {
+            if (remaining[i] != 0) {
+                error = "Dependency cycle through step " + steps[i].stepId;
+                break;
+            }
+        }
+        return nullptr;
+    }
+
+    plan->workflow_ = workflow;
+    return plan;
+}
+
+bool WorkflowPlan::findStep(const std::string& stepId, StepIndex& index) const {
+    auto it = stepIndex_.find(stepId);
+    if (it == stepIndex_.end()) {
+        return false;
+    }
+    index = it->second;
+    return true;
+}
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "orchestrator_interface.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dist_prompt {
+namespace orchestrator {
+namespace workflow {
+
+/**
+ * @brief Immutable, index-based form of a workflow
+ *
+ * Compiled once when a workflow is defined. Step IDs are interned to their
+ * position in Workflow::steps, and dependency edges are stored in CSR form:
+ * the successors of step i are successors_[successorOffsets_[i] ..
+ * successorOffsets_[i + 1]), and likewise for dependencies. Launching an
+ * execution copies the in-degree array and walks these ranges without any
+ * string lookups.
+ */
+class WorkflowPlan {
+public:
+    using StepIndex = uint32_t;
+
+    /**
+     * @brief Contiguous run of step indices inside a CSR array
+     */
+    struct IndexRange {
+        const StepIndex* first;
+        const StepIndex* last;
+
+        const StepIndex* begin() const { return first; }
+        const StepIndex* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    /**
+     * @brief Compile a workflow
+     *
+     * Rejects empty or duplicate step IDs, unknown or repeated dependencies
+     * and cycles.
+     *
+     * @param workflow Workflow definition
+     * @param error Set to the reason when compilation fails
+     * @return std::shared_ptr<const WorkflowPlan> Plan, or nullptr on error
+     */
+    static std::shared_ptr<const WorkflowPlan> compile(const integration::Workflow& workflow,
+                                                       std::string& error);
+
+    /**
+     * @brief Get the source workflow
+     *
+     * @return const integration::Workflow& Workflow as defined
+     */
+    const integration::Workflow& workflow() const { return workflow_; }
+
+    /**
+     * @brief Get the number of steps
+     *
+     * @return size_t Step count
+     */
+    size_t stepCount() const { return workflow_.steps.size(); }
+
+    /**
+     * @brief Get a step by index
+     *
+     * @param index Step index
+     * @return const integration::WorkflowStep& Step definition
+     */
+    const integration::WorkflowStep& step(StepIndex index) const { return workflow_.steps[index]; }
+
+    /**
+     * @brief Look up the index of a step ID
+     *
+     * @param stepId Step identifier
+     * @param index Set to the step index when found
+     * @return bool True if the step exists
+     */
+    bool findStep(const std::string& stepId, StepIndex& index) const;
+
+    /**
+     * @brief Get the steps that depend on a step
+     *
+     * @param index Step index
+     * @return IndexRange Successor indices
+     */
+    IndexRange successors(StepIndex index) const {
+        return {successors_.data() + successorOffsets_[index],
+                successors_.data() + successorOffsets_[index + 1]};
+    }
+
+    /**
+     * @brief Get the dependencies of a step, in declaration order
+     *
+     * @param index Step index
+     * @return IndexRange Dependency indices
+     */
+    IndexRange dependencies(StepIndex index) const {
+        return {dependencies_.data() + dependencyOffsets_[index],
+                dependencies_.data() + dependencyOffsets_[index + 1]};
+    }
+
+    /**
+     * @brief Get the number of dependencies of each step
+     *
+     * @return const std::vector<StepIndex>& In-degree per step
+     */
+    const std::vector<StepIndex>& inDegrees() const { return inDegree_; }
+
+    /**
+     * @brief Get the steps without dependencies
+     *
+     * @return const std::vector<StepIndex>& Root step indices
+     */
+    const std::vector<StepIndex>& roots() const { return roots_; }
+
+    /**
+     * @brief Get the steps in a topological order
+     *
+     * @return const std::vector<StepIndex>& Every step after all of its dependencies
+     */
+    const std::vector<StepIndex>& topologicalOrder() const { return order_; }
+
+private:
+    WorkflowPlan() = default;
+
+    integration::Workflow workflow_;
+    std::unordered_map<std::string, StepIndex> stepIndex_;
+
+    std::vector<StepIndex> successorOffsets_;
+    std::vector<StepIndex> successors_;
+    std::vector<StepIndex> dependencyOffsets_;
+    std::vector<StepIndex> dependencies_;
+
+    std::vector<StepIndex> inDegree_;
+    std::vector<StepIndex> roots_;
+    std::vector<StepIndex> order_;
+};
+
+} // namespace workflow
+} // namespace orchestrator
+} // namespace dist_prompt
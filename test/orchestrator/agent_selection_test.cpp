@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/workflow/agent_pool.h"
+#include "orchestrator/workflow/agent_selection.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::workflow;
+
+namespace {
+
+std::vector<AgentLoad> makeLoads(std::vector<size_t> inFlight) {
+    std::vector<AgentLoad> loads;
+    for (size_t i = 0; i < inFlight.size(); ++i) {
+        AgentLoad load;
+        load.agentId = "a" + std::to_string(i);
+        load.inFlight = inFlight[i];
+        loads.push_back(load);
+    }
+    return loads;
+}
+
+void addAgents(AgentPool& pool, const std::string& agentType, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(pool.addAgent("a" + std::to_string(i), agentType));
+    }
+}
+
+std::string route(AgentPool& pool, const std::string& key) {
+    auto agentId = pool.acquire("agent", key);
+    pool.release(agentId);
+    return agentId;
+}
+
+} // namespace
+
+TEST(AgentSelectionTest, PowerOfTwoChoicesPrefersLessLoadedAgent) {
+    PowerOfTwoChoicesStrategy strategy;
+    EXPECT_EQ(strategy.select(makeLoads({3}), ""), 0u);
+
+    // With two candidates both are always sampled, so the idle one wins
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(strategy.select(makeLoads({5, 0}), ""), 1u);
+    }
+}
+
+TEST(AgentSelectionTest, PowerOfTwoChoicesKeepsPoolBalanced) {
+    AgentPool pool;
+    addAgents(pool, "agent", 8);
+
+    std::vector<std::string> held;
+    for (int i = 0; i < 40; ++i) {
+        held.push_back(pool.acquire("agent", ""));
+        ASSERT_FALSE(held.back().empty());
+    }
+
+    auto stats = pool.getStatistics();
+    EXPECT_EQ(stats["steps_in_flight"], 40.0);
+    EXPECT_LE(stats["max_agent_in_flight"], 10.0);
+
+    for (const auto& agentId : held) {
+        pool.release(agentId);
+    }
+    EXPECT_EQ(pool.getStatistics()["steps_in_flight"], 0.0);
+}
+
+TEST(AgentSelectionTest, LeastLoadedUsesWeightedScore) {
+    LeastLoadedStrategy strategy;
+    auto loads = makeLoads({0, 0, 1});
+    loads[0].cpuUsage = 0.9;
+    loads[1].cpuUsage = 0.1;
+    EXPECT_EQ(strategy.select(loads, ""), 1u);
+
+    LeastLoadedStrategy::Weights cpuOnly;
+    cpuOnly.inFlight = 0.0;
+    cpuOnly.memoryUsage = 0.0;
+    LeastLoadedStrategy cpuStrategy(cpuOnly);
+    loads[2].cpuUsage = 0.0;
+    EXPECT_EQ(cpuStrategy.select(loads, ""), 2u);
+}
+
+TEST(AgentSelectionTest, LeastLoadedRotatesTies) {
+    LeastLoadedStrategy strategy;
+    auto loads = makeLoads({0, 0, 4});
+
+    std::map<size_t, int> picks;
+    for (int i = 0; i < 10; ++i) {
+        picks[strategy.select(loads, "")]++;
+    }
+    EXPECT_GT(picks[0], 0);
+    EXPECT_GT(picks[1], 0);
+    EXPECT_EQ(picks.count(2), 0u);
+}
+
+TEST(AgentSelectionTest, ConsistentHashIsStablePerKey) {
+    AgentPool pool(std::make_shared<ConsistentHashStrategy>());
+    addAgents(pool, "agent", 5);
+
+    std::map<std::string, int> spread;
+    for (int k = 0; k < 200; ++k) {
+        auto key = "key" + std::to_string(k);
+        auto first = route(pool, key);
+        EXPECT_EQ(route(pool, key), first) << key;
+        spread[first]++;
+    }
+    EXPECT_EQ(spread.size(), 5u);
+}
+
+TEST(AgentSelectionTest, ConsistentHashMovesOnlyRemovedAgentKeys) {
+    AgentPool pool(std::make_shared<ConsistentHashStrategy>());
+    addAgents(pool, "agent", 5);
+
+    std::map<std::string, std::string> before;
+    for (int k = 0; k < 200; ++k) {
+        auto key = "key" + std::to_string(k);
+        before[key] = route(pool, key);
+    }
+
+    ASSERT_TRUE(pool.removeAgent("a2"));
+    int moved = 0;
+    for (const auto& entry : before) {
+        auto after = route(pool, entry.first);
+        EXPECT_NE(after, "a2");
+        if (entry.second == "a2") {
+            ++moved;
+        } else {
+            EXPECT_EQ(after, entry.second) << entry.first;
+        }
+    }
+    EXPECT_GT(moved, 0);
+}
+
+TEST(AgentSelectionTest, ConsistentHashPassesOverOverloadedAgent) {
+    ConsistentHashStrategy strategy;
+    auto loads = makeLoads({0, 0, 0, 0});
+    auto preferred = strategy.select(loads, "hot");
+
+    // Push the preferred agent above loadFactor times the average in flight
+    loads[preferred].inFlight = 8;
+    for (size_t i = 0; i < loads.size(); ++i) {
+        if (i != preferred) {
+            loads[i].inFlight = 1;
+        }
+    }
+    EXPECT_NE(strategy.select(loads, "hot"), preferred);
+
+    AgentPool pool(std::make_shared<ConsistentHashStrategy>());
+    addAgents(pool, "agent", 4);
+    std::map<std::string, int> hot;
+    for (int i = 0; i < 20; ++i) {
+        hot[pool.acquire("agent", "hot")]++;
+    }
+    EXPECT_GT(hot.size(), 1u);
+}
+
+TEST(AgentSelectionTest, PoolHonoursExclusionsAndReportsExhaustion) {
+    AgentPool pool;
+    ASSERT_TRUE(pool.addAgent("p1", "pattern"));
+    ASSERT_TRUE(pool.addAgent("p2", "pattern"));
+    EXPECT_FALSE(pool.addAgent("p1", "pattern"));
+    EXPECT_TRUE(pool.hasAgents("pattern"));
+    EXPECT_FALSE(pool.hasAgents("other"));
+
+    EXPECT_EQ(pool.acquire("pattern", "", {"p1"}), "p2");
+    EXPECT_EQ(pool.acquire("pattern", "", {"p1", "p2"}), "");
+    EXPECT_EQ(pool.acquire("other", ""), "");
+
+    auto stats = pool.getStatistics();
+    EXPECT_EQ(stats["selections"], 1.0);
+    EXPECT_EQ(stats["selections_exhausted"], 1.0);
+
+    auto loads = pool.getLoads("pattern");
+    ASSERT_EQ(loads.size(), 2u);
+    for (const auto& load : loads) {
+        EXPECT_EQ(load.inFlight, load.agentId == "p2" ? 1u : 0u);
+    }
+
+    pool.release("p2");
+    EXPECT_TRUE(pool.removeAgent("p1"));
+    EXPECT_FALSE(pool.removeAgent("p1"));
+    EXPECT_EQ(pool.acquire("pattern", ""), "p2");
+}
+
+TEST(AgentSelectionTest, PoolAppliesPerTypeStrategyAndMetrics) {
+    AgentPool pool;
+    ASSERT_TRUE(pool.addAgent("light", "scorer"));
+    ASSERT_TRUE(pool.addAgent("heavy", "scorer"));
+    pool.setStrategy("scorer", std::make_shared<LeastLoadedStrategy>());
+    pool.updateMetrics("heavy", 0.95, 0.9);
+    pool.updateMetrics("light", 0.05, 0.1);
+
+    for (int i = 0; i < 3; ++i) {
+        auto agentId = pool.acquire("scorer", "");
+        EXPECT_EQ(agentId, "light");
+        pool.release(agentId);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/resources/clock.h"
+#include "orchestrator/resources/load_simulator.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace dist_prompt::orchestrator::resources;
+using namespace std::chrono;
+
+TEST(VirtualClockTest, MovesOnlyWhenAdvanced) {
+    VirtualClock clock;
+    auto start = clock.now();
+    std::this_thread::sleep_for(milliseconds(5));
+    EXPECT_EQ(clock.now(), start);
+
+    clock.advance(seconds(3));
+    EXPECT_EQ(clock.now() - start, seconds(3));
+
+    clock.advance(-seconds(1));
+    EXPECT_EQ(clock.now() - start, seconds(3));
+
+    clock.advanceTo(start + seconds(1));
+    EXPECT_EQ(clock.now() - start, seconds(3));
+
+    clock.advanceTo(start + seconds(10));
+    EXPECT_EQ(clock.now() - start, seconds(10));
+}
+
+TEST(VirtualClockTest, SleeperWakesWhenDeadlineIsReached) {
+    auto clock = std::make_shared<VirtualClock>();
+    auto deadline = clock->now() + seconds(60);
+    std::atomic<bool> woke{false};
+    std::thread sleeper([&]() {
+        clock->sleepUntil(deadline, []() { return false; });
+        woke = true;
+    });
+
+    clock->advance(seconds(30));
+    std::this_thread::sleep_for(milliseconds(20));
+    EXPECT_FALSE(woke.load());
+
+    clock->advance(seconds(30));
+    sleeper.join();
+    EXPECT_TRUE(woke.load());
+}
+
+TEST(VirtualClockTest, InterruptedSleepEndsBeforeDeadline) {
+    VirtualClock clock;
+    std::atomic<bool> stop{false};
+    std::thread sleeper([&]() {
+        clock.sleepUntil(clock.now() + hours(1), [&]() { return stop.load(); });
+    });
+
+    stop = true;
+    clock.wakeAll();
+    sleeper.join();
+    EXPECT_LT(clock.now() - VirtualClock::TimePoint(), hours(1));
+}
+
+TEST(LoadSimulatorTest, SyntheticTraceIsSortedAndReproducible) {
+    ResourceLoadSimulator::SyntheticTraceConfig config;
+    config.duration = milliseconds(2000);
+    config.requestsPerSecond = 500.0;
+
+    auto first = ResourceLoadSimulator::generateSyntheticTrace(config);
+    auto second = ResourceLoadSimulator::generateSyntheticTrace(config);
+    ASSERT_FALSE(first.empty());
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i].offset, second[i].offset);
+        EXPECT_EQ(first[i].agentId, second[i].agentId);
+        EXPECT_GE(first[i].tokensRequested, config.minTokens);
+        EXPECT_LE(first[i].tokensRequested, config.maxTokens);
+        if (i > 0) {
+            EXPECT_GE(first[i].offset, first[i - 1].offset);
+        }
+    }
+}
+
+TEST(LoadSimulatorTest, LargerBucketDeniesLess) {
+    ResourceLoadSimulator::SyntheticTraceConfig config;
+    config.duration = milliseconds(5000);
+    config.requestsPerSecond = 400.0;
+    auto trace = ResourceLoadSimulator::generateSyntheticTrace(config);
+
+    ResourceLoadSimulator::Scenario small;
+    small.name = "small";
+    small.resources["cpu"] = {"cpu", 8, 50, 8, milliseconds(100)};
+    ResourceLoadSimulator::Scenario large = small;
+    large.name = "large";
+    large.resources["cpu"] = {"cpu", 200, 2000, 200, milliseconds(100)};
+
+    ResourceLoadSimulator simulator;
+    auto reports = simulator.runAll({small, large}, trace);
+    ASSERT_EQ(reports.size(), 2u);
+    for (const auto& report : reports) {
+        EXPECT_EQ(report.totalRequests, static_cast<long>(trace.size()));
+        EXPECT_EQ(report.grantedRequests + report.deniedRequests, report.totalRequests);
+        EXPECT_GT(report.virtualSeconds, 4.0);
+    }
+    EXPECT_EQ(reports[0].scenarioName, "small");
+    EXPECT_GT(reports[0].denialRate, reports[1].denialRate);
+    EXPECT_GT(reports[1].throughput, reports[0].throughput);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/communication/deduplication_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::communication;
+using namespace std::chrono;
+
+using AgentResponse = DeduplicationCache::AgentResponse;
+using Protocol = GrpcCommunicationProtocol;
+
+namespace {
+
+AgentResponse makeResponse(bool success, const std::string& data) {
+    AgentResponse response{};
+    response.success = success;
+    response.responseData = data;
+    return response;
+}
+
+// Records every response delivered to the callbacks it hands out
+struct Recorder {
+    DeduplicationCache::ResponseCallback callback() {
+        return [this](AgentResponse&& response) { responses.push_back(std::move(response)); };
+    }
+
+    std::vector<AgentResponse> responses;
+};
+
+} // namespace
+
+TEST(DeduplicationCacheTest, FirstArrivalRunsAndDuplicatesWaitForItsResponse) {
+    DeduplicationCache cache(milliseconds(1000), 16);
+    Recorder recorder;
+
+    auto first = recorder.callback();
+    EXPECT_TRUE(cache.begin("a/1", first));
+
+    auto second = recorder.callback();
+    auto third = recorder.callback();
+    EXPECT_FALSE(cache.begin("a/1", second));
+    EXPECT_FALSE(cache.begin("a/1", third));
+    EXPECT_TRUE(recorder.responses.empty());
+
+    cache.complete("a/1", makeResponse(true, "result"));
+    ASSERT_EQ(recorder.responses.size(), 2u);
+    EXPECT_EQ(recorder.responses[0].responseData, "result");
+    EXPECT_EQ(recorder.responses[1].responseData, "result");
+    EXPECT_EQ(cache.duplicates(), 2u);
+}
+
+TEST(DeduplicationCacheTest, CompletedResponseIsReplayedWithinTheWindow) {
+    DeduplicationCache cache(milliseconds(50), 16);
+    Recorder recorder;
+
+    auto first = recorder.callback();
+    ASSERT_TRUE(cache.begin("a/1", first));
+    cache.complete("a/1", makeResponse(true, "stored"));
+
+    auto repeat = recorder.callback();
+    EXPECT_FALSE(cache.begin("a/1", repeat));
+    ASSERT_EQ(recorder.responses.size(), 1u);
+    EXPECT_EQ(recorder.responses[0].responseData, "stored");
+
+    // Other keys are independent
+    auto other = recorder.callback();
+    EXPECT_TRUE(cache.begin("b/1", other));
+
+    std::this_thread::sleep_for(milliseconds(60));
+    auto late = recorder.callback();
+    EXPECT_TRUE(cache.begin("a/1", late));
+}
+
+TEST(DeduplicationCacheTest, OldestCompletedEntriesAreEvictedWhenFull) {
+    DeduplicationCache cache(milliseconds(60000), 2);
+    Recorder recorder;
+    for (const char* key : {"k1", "k2", "k3"}) {
+        auto done = recorder.callback();
+        ASSERT_TRUE(cache.begin(key, done));
+        cache.complete(key, makeResponse(true, key));
+    }
+
+    auto k1 = recorder.callback();
+    EXPECT_TRUE(cache.begin("k1", k1));
+    auto k3 = recorder.callback();
+    EXPECT_FALSE(cache.begin("k3", k3));
+    ASSERT_EQ(recorder.responses.size(), 1u);
+    EXPECT_EQ(recorder.responses[0].responseData, "k3");
+}
+
+TEST(DeduplicationCacheTest, AbandonedKeyAnswersWaitersAndRunsAgain) {
+    DeduplicationCache cache(milliseconds(60000), 16);
+    Recorder recorder;
+
+    auto first = recorder.callback();
+    ASSERT_TRUE(cache.begin("a/1", first));
+    auto waiter = recorder.callback();
+    ASSERT_FALSE(cache.begin("a/1", waiter));
+
+    cache.abandon("a/1", makeResponse(false, "saturated"));
+    ASSERT_EQ(recorder.responses.size(), 1u);
+    EXPECT_FALSE(recorder.responses[0].success);
+
+    auto retry = recorder.callback();
+    EXPECT_TRUE(cache.begin("a/1", retry));
+
+    // Abandoning a completed key leaves its response in place
+    cache.complete("a/1", makeResponse(true, "ran"));
+    cache.abandon("a/1", makeResponse(false, "late"));
+    auto repeat = recorder.callback();
+    EXPECT_FALSE(cache.begin("a/1", repeat));
+    EXPECT_EQ(recorder.responses.back().responseData, "ran");
+}
+
+TEST(DeduplicationCacheTest, ReceiverDoesNotReplayDispatchFailures) {
+    Protocol server;
+    ASSERT_TRUE(server.initializeServer("127.0.0.1:53500", "", ""));
+    Protocol::DeduplicationOptions options;
+    options.enabled = true;
+    server.setDeduplicationOptions(options);
+    ASSERT_TRUE(server.startServer());
+
+    Protocol client;
+    client.setInProcessDelivery(false);
+    ASSERT_TRUE(client.initializeClient("127.0.0.1:53500", "", "", ""));
+
+    Protocol::AgentMessage message{};
+    message.senderId = "client";
+    message.messageType = "late";
+    message.correlationId = "request-1";
+    EXPECT_FALSE(client.sendMessage(message).success);
+
+    std::atomic<int> runs{0};
+    server.registerMessageHandler("late", [&](const Protocol::AgentMessage&) {
+        runs++;
+        return makeResponse(true, "ran");
+    });
+    auto retried = client.sendMessage(message);
+    EXPECT_TRUE(retried.success);
+    EXPECT_EQ(retried.responseData, "ran");
+
+    auto repeated = client.sendMessage(message);
+    EXPECT_EQ(repeated.responseData, "ran");
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(server.getHedgingStats().duplicatesSuppressed, 1u);
+    server.stopServer();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,550 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/communication/handler_executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt::orchestrator;
+using namespace dist_prompt::orchestrator::communication;
+using namespace std::chrono;
+
+using Protocol = GrpcCommunicationProtocol;
+
+namespace {
+
+// Holds handlers until opened, so calls stay in flight as long as a test needs
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// Responses of async sends, keyed by correlationId
+class Responses {
+public:
+    std::function<void(const Protocol::AgentResponse&)> callback(const std::string& correlationId) {
+        return [this, correlationId](const Protocol::AgentResponse& response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            responses_[correlationId] = response;
+            cv_.notify_all();
+        };
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return responses_.size();
+    }
+
+    std::map<std::string, Protocol::AgentResponse> waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, seconds(10), [&]() { return responses_.size() >= count; });
+        return responses_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, Protocol::AgentResponse> responses_;
+};
+
+Protocol::AgentMessage makeMessage(const std::string& type, const std::string& payload,
+                                   const std::string& correlationId = "") {
+    Protocol::AgentMessage message{};
+    message.senderId = "client";
+    message.receiverId = "server";
+    message.messageType = type;
+    message.payload = payload;
+    message.correlationId = correlationId;
+    return message;
+}
+
+Protocol::AgentResponse reply(const Protocol::AgentMessage& message, bool success,
+                              const std::string& data) {
+    Protocol::AgentResponse response{};
+    response.success = success;
+    response.correlationId = message.correlationId;
+    if (success) {
+        response.responseData = data;
+    } else {
+        response.errorMessage = data;
+    }
+    return response;
+}
+
+// Starts a server on a port picked by the OS with echo, fail and held handlers;
+// held ones wait on their own executor so the polling threads stay free
+void startServer(Protocol& server, Gate& gate, std::atomic<int>& handled) {
+    ASSERT_TRUE(server.initializeServer("127.0.0.1:0", "", ""));
+    server.registerMessageHandler("echo", [&handled](const Protocol::AgentMessage& message) {
+        handled++;
+        return reply(message, true, message.payload);
+    });
+    server.registerMessageHandler("fail", [&handled](const Protocol::AgentMessage& message) {
+        handled++;
+        return reply(message, false, "refused " + message.payload);
+    });
+    server.registerMessageHandler("held", [&gate, &handled](const Protocol::AgentMessage& message) {
+        handled++;
+        gate.wait();
+        return reply(message, true, message.payload);
+    }, std::make_shared<HandlerExecutor>("held", 8));
+    ASSERT_TRUE(server.startServer());
+}
+
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    auto deadline = steady_clock::now() + seconds(10);
+    while (!predicate()) {
+        if (steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    return true;
+}
+
+} // namespace
+
+class GrpcProtocolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        startServer(server_, gate_, handled_);
+        address_ = server_.getServerAddress();
+    }
+
+    void TearDown() override {
+        gate_.open();
+        server_.stopServer();
+    }
+
+    // Connects the client over the network unless inProcess is set
+    void connect(bool inProcess = false) {
+        client_.setInProcessDelivery(inProcess);
+        ASSERT_TRUE(client_.initializeClient(address_, "", "", ""));
+    }
+
+    Gate gate_;
+    std::atomic<int> handled_{0};
+    std::string address_;
+    Protocol server_;
+    Protocol client_;
+};
+
+TEST_F(GrpcProtocolTest, ServerReportsThePickedPort) {
+    EXPECT_EQ(address_.compare(0, 10, "127.0.0.1:"), 0);
+    EXPECT_NE(address_, "127.0.0.1:0");
+    EXPECT_TRUE(server_.isServerRunning());
+
+    Protocol unstarted;
+    EXPECT_EQ(unstarted.getServerAddress(), "");
+}
+
+TEST_F(GrpcProtocolTest, UnaryCallsReturnHandlerResponsesAndErrors) {
+    connect();
+
+    auto echoed = client_.sendMessage(makeMessage("echo", "hello", "c1"));
+    EXPECT_TRUE(echoed.success);
+    EXPECT_EQ(echoed.responseData, "hello");
+    EXPECT_EQ(echoed.correlationId, "c1");
+
+    auto failed = client_.sendMessage(makeMessage("fail", "this"));
+    EXPECT_FALSE(failed.success);
+    EXPECT_EQ(failed.errorMessage, "refused this");
+
+    auto unknown = client_.sendMessage(makeMessage("missing", ""));
+    EXPECT_FALSE(unknown.success);
+    EXPECT_NE(unknown.errorMessage.find("No handler registered"), std::string::npos);
+    EXPECT_EQ(handled_.load(), 2);
+
+    auto pool = client_.getChannelPoolStats();
+    EXPECT_EQ(pool.endpoints, 1u);
+    EXPECT_EQ(pool.channelsOpened, 1u);
+    EXPECT_EQ(pool.activeCalls, 0u);
+    EXPECT_EQ(client_.getActiveConnectionCount(), 1);
+}
+
+TEST_F(GrpcProtocolTest, UnreachablePeerFailsWithinTheConnectionTimeout) {
+    Protocol peer;
+    Gate unused;
+    std::atomic<int> count{0};
+    startServer(peer, unused, count);
+    auto deadAddress = peer.getServerAddress();
+    peer.stopServer();
+
+    client_.setInProcessDelivery(false);
+    client_.setConnectionTimeout(200);
+    ASSERT_TRUE(client_.initializeClient(deadAddress, "", "", ""));
+    auto response = client_.sendMessage(makeMessage("echo", "lost"));
+    EXPECT_FALSE(response.success);
+    EXPECT_FALSE(response.errorMessage.empty());
+}
+
+TEST_F(GrpcProtocolTest, StreamedSendsAreMatchedByCorrelationId) {
+    client_.setStreamingEnabled(true);
+    connect();
+
+    Responses responses;
+    for (int i = 0; i < 20; ++i) {
+        auto id = "s" + std::to_string(i);
+        ASSERT_TRUE(client_.sendMessageAsync(makeMessage("echo", "payload-" + id, id),
+                                             responses.callback(id)));
+    }
+    auto received = responses.waitFor(20);
+    ASSERT_EQ(received.size(), 20u);
+    for (const auto& entry : received) {
+        EXPECT_TRUE(entry.second.success) << entry.first;
+        EXPECT_EQ(entry.second.responseData, "payload-" + entry.first);
+    }
+
+    // An empty correlationId is filled in so the response can still be matched
+    auto response = client_.sendMessage(makeMessage("echo", "unlabelled"));
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.responseData, "unlabelled");
+
+    auto failed = client_.sendMessage(makeMessage("fail", "streamed"));
+    EXPECT_FALSE(failed.success);
+    EXPECT_EQ(failed.errorMessage, "refused streamed");
+    EXPECT_EQ(client_.getChannelPoolStats().channelsOpened, 1u);
+}
+
+TEST_F(GrpcProtocolTest, BatchedSendsEachGetTheirOwnResponse) {
+    Protocol::BatchingOptions batching;
+    batching.enabled = true;
+    batching.maxBatchMessages = 8;
+    batching.flushDelay = milliseconds(1);
+    client_.setBatchingOptions(batching);
+    connect();
+
+    Responses responses;
+    for (int i = 0; i < 50; ++i) {
+        auto id = "b" + std::to_string(i);
+        auto type = i % 10 == 0 ? "fail" : "echo";
+        ASSERT_TRUE(client_.sendMessageAsync(makeMessage(type, id, id), responses.callback(id)));
+    }
+    auto received = responses.waitFor(50);
+    ASSERT_EQ(received.size(), 50u);
+    for (const auto& entry : received) {
+        bool failing = std::stoi(entry.first.substr(1)) % 10 == 0;
+        EXPECT_EQ(entry.second.success, !failing) << entry.first;
+        EXPECT_EQ(entry.second.correlationId, entry.first);
+        if (!failing) {
+            EXPECT_EQ(entry.second.responseData, entry.first);
+        }
+    }
+    EXPECT_EQ(handled_.load(), 50);
+}
+
+TEST_F(GrpcProtocolTest, InProcessDeliveryBypassesTheNetwork) {
+    connect(true);
+
+    auto response = client_.sendMessage(makeMessage("echo", "local", "l1"));
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.responseData, "local");
+    EXPECT_EQ(response.correlationId, "l1");
+
+    Responses responses;
+    ASSERT_TRUE(client_.sendMessageAsync(makeMessage("fail", "moved", "l2"), responses.callback("l2")));
+    auto received = responses.waitFor(1);
+    ASSERT_EQ(received.count("l2"), 1u);
+    EXPECT_FALSE(received["l2"].success);
+    EXPECT_EQ(received["l2"].errorMessage, "refused moved");
+
+    EXPECT_EQ(handled_.load(), 2);
+    EXPECT_EQ(client_.getChannelPoolStats().channelsOpened, 0u);
+}
+
+TEST_F(GrpcProtocolTest, InternedTypesAreStableAndTakePrecedence) {
+    auto echo = Protocol::internMessageType("echo");
+    EXPECT_NE(echo, Protocol::kUnknownMessageType);
+    EXPECT_EQ(Protocol::internMessageType("echo"), echo);
+    EXPECT_NE(Protocol::internMessageType("fail"), echo);
+    EXPECT_EQ(Protocol::internMessageType(""), Protocol::kUnknownMessageType);
+    connect(true);
+
+    auto byId = makeMessage("", "by id");
+    byId.messageTypeId = echo;
+    auto response = client_.sendMessage(byId);
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.responseData, "by id");
+
+    // Within the process the ID wins over a conflicting string
+    auto conflicting = makeMessage("fail", "id wins");
+    conflicting.messageTypeId = echo;
+    EXPECT_TRUE(client_.sendMessage(conflicting).success);
+
+    auto unhandled = makeMessage("", "");
+    unhandled.messageTypeId = Protocol::internMessageType("interned-but-unhandled");
+    response = client_.sendMessage(unhandled);
+    EXPECT_FALSE(response.success);
+    EXPECT_NE(response.errorMessage.find("interned-but-unhandled"), std::string::npos);
+}
+
+TEST_F(GrpcProtocolTest, InternedTypeReachesRemoteHandlerByName) {
+    connect();
+
+    auto byId = makeMessage("", "over the wire");
+    byId.messageTypeId = Protocol::internMessageType("echo");
+    auto response = client_.sendMessage(byId);
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.responseData, "over the wire");
+}
+
+TEST_F(GrpcProtocolTest, HandlerExecutorKeepsPollingThreadsFree) {
+    connect();
+
+    Responses responses;
+    for (int i = 0; i < 3; ++i) {
+        auto id = "h" + std::to_string(i);
+        ASSERT_TRUE(client_.sendMessageAsync(makeMessage("held", id, id), responses.callback(id)));
+    }
+    ASSERT_TRUE(eventually([&]() { return handled_.load() == 3; }));
+
+    // Held handlers occupy the executor, not the threads that answer echo
+    auto response = client_.sendMessage(makeMessage("echo", "still answered"));
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(responses.count(), 0u);
+
+    gate_.open();
+    auto received = responses.waitFor(3);
+    ASSERT_EQ(received.size(), 3u);
+    for (const auto& entry : received) {
+        EXPECT_TRUE(entry.second.success) << entry.first;
+    }
+}
+
+TEST_F(GrpcProtocolTest, SaturatedHandlerExecutorRejectsMessages) {
+    Gate narrowGate;
+    std::atomic<int> started{0};
+    server_.registerMessageHandler("narrow", [&](const Protocol::AgentMessage& message) {
+        started++;
+        narrowGate.wait();
+        return reply(message, true, message.payload);
+    }, std::make_shared<HandlerExecutor>("narrow", 1, 1));
+    connect();
+
+    Responses responses;
+    ASSERT_TRUE(client_.sendMessageAsync(makeMessage("narrow", "", "running"), responses.callback("running")));
+    ASSERT_TRUE(eventually([&]() { return started.load() == 1; }));
+
+    // One more fits in the queue; the other is turned away at once
+    ASSERT_TRUE(client_.sendMessageAsync(makeMessage("narrow", "", "a"), responses.callback("a")));
+    ASSERT_TRUE(client_.sendMessageAsync(makeMessage("narrow", "", "b"), responses.callback("b")));
+    auto rejected = responses.waitFor(1);
+    ASSERT_EQ(rejected.size(), 1u);
+    EXPECT_FALSE(rejected.begin()->second.success);
+    EXPECT_EQ(rejected.begin()->second.errorMessage, "Handler executor narrow is saturated");
+
+    narrowGate.open();
+    auto received = responses.waitFor(3);
+    ASSERT_EQ(received.size(), 3u);
+    EXPECT_TRUE(received["running"].success);
+    EXPECT_EQ(started.load(), 2);
+}
+
+TEST_F(GrpcProtocolTest, BroadcastReportsPeersThatMissTheDeadline) {
+    Protocol slow;
+    Gate slowGate;
+    std::atomic<int> slowHandled{0};
+    startServer(slow, slowGate, slowHandled);
+
+    connect();
+    ASSERT_TRUE(client_.initializeClient(slow.getServerAddress(), "", "", ""));
+
+    // The second server answers the same type only once its gate opens
+    slow.registerMessageHandler("echo", [&slowGate](const Protocol::AgentMessage& message) {
+        slowGate.wait();
+        return reply(message, true, message.payload);
+    });
+
+    Protocol::BroadcastOptions options;
+    options.deadline = milliseconds(300);
+    auto start = steady_clock::now();
+    auto result = client_.broadcastMessage(makeMessage("echo", "all"), options);
+    auto elapsed = steady_clock::now() - start;
+
+    ASSERT_EQ(result.peers.size(), 2u);
+    EXPECT_EQ(result.peers[0].address, address_);
+    EXPECT_EQ(result.peers[0].status, Protocol::PeerStatus::OK);
+    EXPECT_EQ(result.peers[0].response.responseData, "all");
+    EXPECT_EQ(result.peers[1].status, Protocol::PeerStatus::TIMED_OUT);
+    EXPECT_EQ(result.succeeded, 1u);
+    EXPECT_EQ(result.timedOut, 1u);
+    EXPECT_FALSE(result.complete);
+    EXPECT_LT(elapsed, seconds(5));
+
+    slowGate.open();
+    slow.stopServer();
+}
+
+TEST_F(GrpcProtocolTest, OnlyIdempotentMessagesAreHedged) {
+    Protocol alternate;
+    Gate alternateGate;
+    std::atomic<int> alternateHandled{0};
+    startServer(alternate, alternateGate, alternateHandled);
+    alternateGate.open();
+
+    connect();
+    ASSERT_TRUE(client_.registerPeer("primary", address_, "worker"));
+    ASSERT_TRUE(client_.registerPeer("alternate", alternate.getServerAddress(), "worker"));
+    Protocol::HedgingOptions hedging;
+    hedging.enabled = true;
+    hedging.maxDelay = milliseconds(20);
+    client_.setHedgingOptions(hedging);
+
+    // The primary holds the request, so an idempotent one is answered by the alternate
+    auto hedged = makeMessage("held", "either", "idempotent");
+    hedged.receiverId = "primary";
+    hedged.idempotent = true;
+    auto response = client_.sendMessage(hedged);
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(alternateHandled.load(), 1);
+    ASSERT_TRUE(eventually([&]() { return handled_.load() == 1; }));
+
+    auto stats = client_.getHedgingStats();
+    EXPECT_EQ(stats.hedgeableRequests, 1u);
+    EXPECT_EQ(stats.hedgesSent, 1u);
+    EXPECT_EQ(stats.hedgeWins, 1u);
+
+    // Anything else waits for its receiver and runs nowhere else
+    auto single = makeMessage("held", "once", "not-idempotent");
+    single.receiverId = "primary";
+    std::thread release([&]() {
+        ASSERT_TRUE(eventually([&]() { return handled_.load() == 2; }));
+        std::this_thread::sleep_for(milliseconds(100));
+        gate_.open();
+    });
+    response = client_.sendMessage(single);
+    release.join();
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.responseData, "once");
+    EXPECT_EQ(handled_.load(), 2);
+    EXPECT_EQ(alternateHandled.load(), 1);
+    EXPECT_EQ(client_.getHedgingStats().hedgesSent, 1u);
+
+    alternate.stopServer();
+}
+
+TEST_F(GrpcProtocolTest, GzipCompressesLargeMessagesOnceNegotiated) {
+    Protocol::CompressionOptions compression;
+    compression.algorithm = Protocol::CompressionAlgorithm::GZIP;
+    compression.minMessageBytes = 1024;
+    server_.setCompressionOptions(compression);
+    client_.setCompressionOptions(compression);
+    connect();
+
+    std::string large(64 * 1024, 'x');
+    for (int i = 0; i < 3; ++i) {
+        auto response = client_.sendMessage(makeMessage("echo", large));
+        ASSERT_TRUE(response.success);
+        EXPECT_EQ(response.responseData, large);
+    }
+    EXPECT_TRUE(client_.sendMessage(makeMessage("echo", "small")).success);
+
+    std::map<std::string, Protocol::CompressionStats> byAddress;
+    for (const auto& entry : client_.getCompressionStats()) {
+        byAddress[entry.address] = entry;
+    }
+    ASSERT_EQ(byAddress.count(address_), 1u);
+    const auto& sent = byAddress[address_];
+    EXPECT_EQ(sent.negotiated, Protocol::CompressionAlgorithm::GZIP);
+    EXPECT_GE(sent.compressedMessages, 2u);
+    EXPECT_GE(sent.uncompressedMessages, 1u);
+    EXPECT_GE(sent.compressedBytes, 2u * large.size());
+
+    uint64_t responsesCompressed = 0;
+    for (const auto& entry : server_.getCompressionStats()) {
+        if (entry.address == address_) {
+            responsesCompressed = entry.compressedMessages;
+        }
+    }
+    EXPECT_GE(responsesCompressed, 2u);
+}
+
+TEST_F(GrpcProtocolTest, CancellationAbandonsTheCall) {
+    connect();
+
+    auto cancelled = CancellationToken::create();
+    cancelled.cancel("not needed");
+    auto early = client_.sendMessage(makeMessage("echo", "never"), cancelled);
+    EXPECT_FALSE(early.success);
+    EXPECT_EQ(early.errorMessage, "Cancelled: not needed");
+    EXPECT_EQ(handled_.load(), 0);
+
+    auto token = CancellationToken::create();
+    std::thread canceller([&]() {
+        ASSERT_TRUE(eventually([&]() { return handled_.load() == 1; }));
+        token.cancel("step abandoned");
+    });
+    auto start = steady_clock::now();
+    auto response = client_.sendMessage(makeMessage("held", "waiting"), token);
+    canceller.join();
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.errorMessage, "Cancelled: step abandoned");
+    EXPECT_LT(steady_clock::now() - start, seconds(5));
+    EXPECT_TRUE(eventually([&]() { return client_.getChannelPoolStats().activeCalls == 0; }));
+
+    // The token's deadline caps the call even if nobody cancels it
+    auto expiring = CancellationToken::create(steady_clock::now() + milliseconds(100));
+    auto timedOut = client_.sendMessage(makeMessage("held", "late"), expiring);
+    EXPECT_FALSE(timedOut.success);
+}
+
+TEST_F(GrpcProtocolTest, ChannelPoolOpensChannelsUnderLoadAndEvictsIdleOnes) {
+    Protocol::ChannelPoolOptions pool;
+    pool.maxStreamsPerChannel = 1;
+    pool.maxChannelsPerEndpoint = 3;
+    pool.idleTimeout = milliseconds(200);
+    client_.setChannelPoolOptions(pool);
+    connect();
+
+    Responses responses;
+    for (int i = 0; i < 4; ++i) {
+        auto id = "p" + std::to_string(i);
+        ASSERT_TRUE(client_.sendMessageAsync(makeMessage("held", id, id), responses.callback(id)));
+    }
+    ASSERT_TRUE(eventually([&]() { return handled_.load() == 4; }));
+
+    // Past the channel cap the least-loaded channel takes a second call
+    auto busy = client_.getChannelPoolStats();
+    EXPECT_EQ(busy.endpoints, 1u);
+    EXPECT_EQ(busy.channels, 3u);
+    EXPECT_EQ(busy.channelsOpened, 3u);
+    EXPECT_EQ(busy.activeCalls, 4u);
+
+    gate_.open();
+    EXPECT_EQ(responses.waitFor(4).size(), 4u);
+    EXPECT_TRUE(eventually([&]() { return client_.getChannelPoolStats().channels == 0; }));
+    EXPECT_EQ(client_.getChannelPoolStats().channelsEvicted, 3u);
+
+    // An evicted endpoint reconnects on the next send
+    EXPECT_TRUE(client_.sendMessage(makeMessage("echo", "again")).success);
+    EXPECT_EQ(client_.getChannelPoolStats().channelsOpened, 4u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/communication/message_codec.h"
+
+#include <string>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::communication;
+
+using AgentMessage = MessageCodec::AgentMessage;
+using AgentResponse = MessageCodec::AgentResponse;
+
+namespace {
+
+AgentMessage makeMessage(std::string payload) {
+    AgentMessage message{};
+    message.senderId = "planner";
+    message.receiverId = "simulator";
+    message.messageType = "simulate";
+    message.payload = std::move(payload);
+    message.timestamp = 1234567890123;
+    message.correlationId = "corr-1";
+    return message;
+}
+
+std::string patterned(size_t size) {
+    std::string bytes(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>(i * 131 + 7);
+    }
+    return bytes;
+}
+
+// Copies the encoded bytes into separately allocated slices of the given size,
+// as a buffer received over several reads would be
+uint8_t formatVersion(const grpc::ByteBuffer& buffer) {
+    grpc::Slice whole;
+    EXPECT_TRUE(buffer.DumpToSingleSlice(&whole).ok());
+    return whole.size() > 0 ? whole.begin()[0] : 0;
+}
+
+std::vector<grpc::Slice> splitBuffer(const grpc::ByteBuffer& buffer, size_t sliceSize) {
+    grpc::Slice whole;
+    EXPECT_TRUE(buffer.DumpToSingleSlice(&whole).ok());
+    std::vector<grpc::Slice> slices;
+    for (size_t offset = 0; offset < whole.size(); offset += sliceSize) {
+        size_t length = std::min(sliceSize, whole.size() - offset);
+        slices.emplace_back(whole.begin() + offset, length);
+    }
+    return slices;
+}
+
+} // namespace
+
+TEST(MessageCodecTest, MessageRoundTrip) {
+    auto message = makeMessage("payload bytes");
+    auto buffer = MessageCodec::encodeMessage(message);
+    EXPECT_EQ(buffer.Length(), MessageCodec::encodedSize(message));
+
+    AgentMessage decoded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(buffer, &decoded));
+    EXPECT_EQ(decoded.senderId, message.senderId);
+    EXPECT_EQ(decoded.receiverId, message.receiverId);
+    EXPECT_EQ(decoded.messageType, message.messageType);
+    EXPECT_EQ(decoded.payload, message.payload);
+    EXPECT_EQ(decoded.timestamp, message.timestamp);
+    EXPECT_EQ(decoded.correlationId, message.correlationId);
+
+    AgentMessage viewed{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(buffer, &viewed, false));
+    EXPECT_TRUE(viewed.payload.empty());
+    EXPECT_EQ(viewed.payloadView.toString(), message.payload);
+}
+
+TEST(MessageCodecTest, ResponseRoundTrip) {
+    AgentResponse response{};
+    response.success = false;
+    response.responseData = std::string("binary\0data", 11);
+    response.errorMessage = "handler failed";
+    response.timestamp = -5;
+    response.correlationId = "corr-2";
+
+    AgentResponse decoded{};
+    ASSERT_TRUE(MessageCodec::decodeResponse(MessageCodec::encodeResponse(response), &decoded));
+    EXPECT_FALSE(decoded.success);
+    EXPECT_EQ(decoded.responseData, response.responseData);
+    EXPECT_EQ(decoded.errorMessage, response.errorMessage);
+    EXPECT_EQ(decoded.timestamp, response.timestamp);
+    EXPECT_EQ(decoded.correlationId, response.correlationId);
+}
+
+TEST(MessageCodecTest, PayloadViewIsSentInsteadOfPayload) {
+    auto message = makeMessage("ignored");
+    message.payloadView = PayloadView::fromString("from the view");
+
+    AgentMessage decoded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(MessageCodec::encodeMessage(message), &decoded));
+    EXPECT_EQ(decoded.payload, "from the view");
+}
+
+TEST(MessageCodecTest, InternedTypeIsSentAsItsString) {
+    auto message = makeMessage("by id");
+    message.messageType.clear();
+    message.messageTypeId = GrpcCommunicationProtocol::internMessageType("simulate");
+    auto buffer = MessageCodec::encodeMessage(message);
+    EXPECT_EQ(buffer.Length(), MessageCodec::encodedSize(message));
+
+    AgentMessage decoded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(buffer, &decoded));
+    EXPECT_EQ(decoded.messageType, "simulate");
+    EXPECT_EQ(decoded.messageTypeId, GrpcCommunicationProtocol::kUnknownMessageType);
+    EXPECT_EQ(decoded.payload, "by id");
+}
+
+TEST(MessageCodecTest, MultiSlicePayloadDecodesToSegmentedViewWithoutCopying) {
+    auto payload = patterned(1 << 20);
+    auto message = makeMessage("");
+    message.payloadView = PayloadView::fromString(payload);
+    auto slices = splitBuffer(MessageCodec::encodeMessage(message), 65536 + 13);
+    grpc::ByteBuffer received(slices.data(), slices.size());
+
+    AgentMessage decoded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(received, &decoded, false));
+    EXPECT_EQ(decoded.correlationId, "corr-1");
+    const auto& view = decoded.payloadView;
+    ASSERT_GT(view.segmentCount(), 1u);
+    EXPECT_FALSE(view.contiguous());
+    EXPECT_EQ(view.size(), payload.size());
+
+    // The payload's last segment is the tail of the last received slice
+    auto last = view.segment(view.segmentCount() - 1);
+    const auto* lastSlice = reinterpret_cast<const char*>(slices.back().begin());
+    EXPECT_EQ(last.data() + last.size(), lastSlice + slices.back().size());
+
+    EXPECT_EQ(view.toString(), payload);
+    EXPECT_EQ(view.subview(100000, 200000).toString(), payload.substr(100000, 200000));
+    EXPECT_EQ(view.view(), payload);
+
+    // Forwarding a segmented view encodes the same bytes
+    AgentMessage forwarded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(MessageCodec::encodeMessage(decoded), &forwarded));
+    EXPECT_EQ(forwarded.payload, payload);
+}
+
+TEST(MessageCodecTest, TruncatedBufferIsRejected) {
+    auto slices = splitBuffer(MessageCodec::encodeMessage(makeMessage(patterned(4096))), 1000);
+    grpc::ByteBuffer truncated(slices.data(), slices.size() - 1);
+    AgentMessage decoded{};
+    EXPECT_FALSE(MessageCodec::decodeMessage(truncated, &decoded));
+
+    grpc::ByteBuffer empty;
+    EXPECT_FALSE(MessageCodec::decodeMessage(empty, &decoded));
+}
+
+TEST(MessageCodecTest, BatchRoundTripKeepsOrder) {
+    std::vector<AgentMessage> messages;
+    for (int i = 0; i < 5; ++i) {
+        messages.push_back(makeMessage("payload-" + std::to_string(i)));
+        messages.back().correlationId = "c" + std::to_string(i);
+    }
+    messages[2].payloadView = PayloadView::fromString(patterned(70000));
+    auto slices = splitBuffer(MessageCodec::encodeMessageBatch(messages), 4099);
+    grpc::ByteBuffer received(slices.data(), slices.size());
+
+    std::vector<AgentMessage> decoded;
+    ASSERT_TRUE(MessageCodec::decodeMessageBatch(received, &decoded));
+    ASSERT_EQ(decoded.size(), messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(decoded[i].correlationId, messages[i].correlationId);
+    }
+    EXPECT_EQ(decoded[0].payload, "payload-0");
+    EXPECT_EQ(decoded[2].payload, patterned(70000));
+
+    std::vector<AgentResponse> responses(3);
+    for (int i = 0; i < 3; ++i) {
+        responses[i].success = i != 1;
+        responses[i].responseData = "r" + std::to_string(i);
+        responses[i].correlationId = "c" + std::to_string(i);
+    }
+    std::vector<AgentResponse> decodedResponses;
+    ASSERT_TRUE(MessageCodec::decodeResponseBatch(MessageCodec::encodeResponseBatch(responses), &decodedResponses));
+    ASSERT_EQ(decodedResponses.size(), 3u);
+    EXPECT_FALSE(decodedResponses[1].success);
+    EXPECT_EQ(decodedResponses[2].responseData, "r2");
+}
+
+TEST(MessageCodecTest, LargePayloadGoesThroughSharedMemoryRing) {
+    auto* ring = SharedMemoryRing::local();
+    if (ring == nullptr) {
+        GTEST_SKIP() << "POSIX shared memory is not available";
+    }
+
+    auto payload = patterned(SharedMemoryRing::kMinPayloadSize * 4);
+    auto message = makeMessage(payload);
+    auto buffer = MessageCodec::encodeMessage(message, ring);
+    EXPECT_EQ(formatVersion(buffer), 2);
+    EXPECT_LT(buffer.Length(), 1024u);
+
+    AgentMessage decoded{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(buffer, &decoded));
+    EXPECT_EQ(decoded.payload, payload);
+    EXPECT_EQ(decoded.correlationId, message.correlationId);
+
+    // The block is released by its first reader
+    AgentMessage again{};
+    EXPECT_FALSE(MessageCodec::decodeMessage(buffer, &again));
+
+    AgentMessage viewed{};
+    ASSERT_TRUE(MessageCodec::decodeMessage(MessageCodec::encodeMessage(message, ring), &viewed, false));
+    EXPECT_EQ(viewed.payloadView.toString(), payload);
+
+    AgentResponse response{};
+    response.success = true;
+    response.responseView = PayloadView::fromString(payload);
+    auto responseBuffer = MessageCodec::encodeResponse(response, ring);
+    EXPECT_EQ(formatVersion(responseBuffer), 2);
+    AgentResponse decodedResponse{};
+    ASSERT_TRUE(MessageCodec::decodeResponse(responseBuffer, &decodedResponse));
+    EXPECT_EQ(decodedResponse.responseData, payload);
+}
+
+TEST(MessageCodecTest, SmallPayloadStaysInlineWithRing) {
+    auto* ring = SharedMemoryRing::local();
+    if (ring == nullptr) {
+        GTEST_SKIP() << "POSIX shared memory is not available";
+    }
+
+    auto message = makeMessage(patterned(SharedMemoryRing::kMinPayloadSize - 1));
+    auto buffer = MessageCodec::encodeMessage(message, ring);
+    EXPECT_EQ(formatVersion(buffer), 1);
+    EXPECT_EQ(buffer.Length(), MessageCodec::encodedSize(message));
+
+    std::vector<AgentMessage> batch{message, makeMessage(patterned(SharedMemoryRing::kMinPayloadSize))};
+    std::vector<AgentMessage> decoded;
+    ASSERT_TRUE(MessageCodec::decodeMessageBatch(MessageCodec::encodeMessageBatch(batch, ring), &decoded));
+    ASSERT_EQ(decoded.size(), 2u);
+    EXPECT_EQ(decoded[0].payload, batch[0].payload);
+    EXPECT_EQ(decoded[1].payload, batch[1].payload);
+}
+
+TEST(MessageCodecTest, UnreadableSharedMemoryReferenceIsRejected) {
+    auto* ring = SharedMemoryRing::local();
+    if (ring == nullptr) {
+        GTEST_SKIP() << "POSIX shared memory is not available";
+    }
+
+    auto buffer = MessageCodec::encodeMessage(makeMessage(patterned(SharedMemoryRing::kMinPayloadSize)), ring);
+    grpc::Slice whole;
+    ASSERT_TRUE(buffer.DumpToSingleSlice(&whole).ok());
+    std::string bytes(reinterpret_cast<const char*>(whole.begin()), whole.size());
+    // The payload reference is last: segment name, offset, length. Point it
+    // past the end of the ring.
+    for (size_t i = bytes.size() - 16; i < bytes.size() - 8; ++i) {
+        bytes[i] = '\xff';
+    }
+    grpc::Slice corrupted(bytes.data(), bytes.size());
+    grpc::ByteBuffer received(&corrupted, 1);
+
+    AgentMessage decoded{};
+    EXPECT_FALSE(MessageCodec::decodeMessage(received, &decoded));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
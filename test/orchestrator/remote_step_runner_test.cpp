@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/communication/grpc_protocol.h"
+#include "orchestrator/communication/handler_executor.h"
+#include "orchestrator/communication/remote_step_runner.h"
+#include "orchestrator/resources/token_bucket_manager.h"
+#include "orchestrator/workflow/result_codec.h"
+#include "orchestrator/workflow/workflow_executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt;
+using namespace dist_prompt::orchestrator::communication;
+using namespace dist_prompt::orchestrator::workflow;
+using namespace std::chrono;
+
+using Protocol = GrpcCommunicationProtocol;
+using orchestrator::resources::TokenBucketResourceManager;
+
+namespace {
+
+// Holds handlers until opened, so steps stay in flight as long as a test needs
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+integration::WorkflowStep makeStep(const std::string& stepId, const std::string& action,
+                                   std::vector<std::string> dependencies = {},
+                                   std::map<std::string, std::string> parameters = {}) {
+    integration::WorkflowStep step{};
+    step.stepId = stepId;
+    step.agentType = "analyzer";
+    step.action = action;
+    step.parameters = std::move(parameters);
+    step.dependencies = std::move(dependencies);
+    return step;
+}
+
+integration::Workflow makeWorkflow(std::vector<integration::WorkflowStep> steps) {
+    integration::Workflow workflow{};
+    workflow.workflowId = "wf";
+    workflow.steps = std::move(steps);
+    return workflow;
+}
+
+integration::ExecutionContext makeContext(std::map<std::string, std::string> variables = {}) {
+    integration::ExecutionContext context{};
+    context.contextId = "ctx";
+    context.variables = std::move(variables);
+    return context;
+}
+
+// Answers a step with "<action>(<parameters>|<input results>)"
+Protocol::AgentResponse runStep(const Protocol::AgentMessage& message) {
+    Protocol::AgentResponse response{};
+    response.correlationId = message.correlationId;
+
+    StepRequest request;
+    if (!ResultCodec::decodeStepRequest(message.payload, request)) {
+        response.success = false;
+        response.errorMessage = "bad step request";
+        return response;
+    }
+
+    std::string data = request.action + "(";
+    for (const auto& parameter : request.parameters) {
+        data += parameter.first + "=" + parameter.second + ";";
+    }
+    data += "|";
+    for (const auto& input : request.inputs) {
+        data += input.resultData + ";";
+    }
+    data += ")";
+
+    integration::ExecutionResult result{};
+    result.success = true;
+    result.resultData = data;
+    result.outputs["step"] = request.executionId + "/" + request.stepId;
+    response.success = true;
+    response.responseData = ResultCodec::encodeResult(result);
+    return response;
+}
+
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    auto deadline = steady_clock::now() + seconds(10);
+    while (!predicate()) {
+        if (steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    return true;
+}
+
+} // namespace
+
+class RemoteStepRunnerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(agent_.initializeServer("127.0.0.1:0", "", ""));
+        agent_.registerMessageHandler("analyze", [this](const Protocol::AgentMessage& message) {
+            handled_++;
+            return runStep(message);
+        });
+        agent_.registerMessageHandler("wait", [this](const Protocol::AgentMessage& message) {
+            handled_++;
+            gate_.wait();
+            return runStep(message);
+        }, std::make_shared<HandlerExecutor>("wait", 4));
+        ASSERT_TRUE(agent_.startServer());
+
+        ASSERT_TRUE(resources_->registerResource({"gpu", 1, 0, 1, milliseconds(1000)}));
+    }
+
+    void TearDown() override {
+        gate_.open();
+        agent_.stopServer();
+    }
+
+    // Connects the orchestrator to the agent over the network under the step's agentType
+    void connect(bool streaming) {
+        orchestrator_->setInProcessDelivery(false);
+        orchestrator_->setStreamingEnabled(streaming);
+        ASSERT_TRUE(orchestrator_->initializeClient(agent_.getServerAddress(), "", "", ""));
+        ASSERT_TRUE(orchestrator_->registerPeer("analyzer", agent_.getServerAddress()));
+    }
+
+    Gate gate_;
+    std::atomic<int> handled_{0};
+    Protocol agent_;
+    std::shared_ptr<Protocol> orchestrator_ = std::make_shared<Protocol>();
+    std::shared_ptr<TokenBucketResourceManager> resources_ = std::make_shared<TokenBucketResourceManager>();
+};
+
+TEST_F(RemoteStepRunnerTest, StepsRunOnTheAgentWithTheirParametersAndInputs) {
+    connect(false);
+    RemoteStepRunner runner(orchestrator_, "orchestrator", resources_);
+    runner.setResourceNeed("analyzer", {"gpu", 1, 0, milliseconds(5000)});
+
+    WorkflowExecutor executor(runner.stepRunner(), 1);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({
+        makeStep("first", "analyze", {}, {{"topic", "${idea}"}}),
+        makeStep("second", "analyze", {"first"}),
+    })));
+
+    auto id = executor.executeWorkflow("wf", makeContext({{"idea", "tides"}}));
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+
+    auto results = executor.getExecutionResults(id);
+    ASSERT_TRUE(results.success) << results.errorMessage;
+    EXPECT_EQ(results.outputs["first"], "analyze(topic=tides;|)");
+    EXPECT_EQ(results.outputs["second"], "analyze(|analyze(topic=tides;|);)");
+    EXPECT_EQ(results.outputs["second.step"], id + "/second");
+    EXPECT_EQ(handled_.load(), 2);
+
+    // Each step held the only token while it ran and gave it back
+    EXPECT_EQ(resources_->getAvailableTokens("gpu"), 1);
+}
+
+TEST_F(RemoteStepRunnerTest, CancellingTheExecutionCancelsStreamedCalls) {
+    connect(true);
+    RemoteStepRunner runner(orchestrator_, "orchestrator");
+
+    auto executor = std::make_unique<WorkflowExecutor>(runner.stepRunner(), 1);
+    ASSERT_TRUE(executor->defineWorkflow(makeWorkflow({makeStep("slow", "wait")})));
+
+    auto start = steady_clock::now();
+    auto id = executor->executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(eventually([&]() { return handled_.load() == 1; }));
+
+    // The agent is still holding the step, so only cancelling the RPC lets the
+    // runner return and the executor's destructor finish
+    EXPECT_TRUE(executor->cancelExecution(id));
+    ASSERT_TRUE(executor->waitForExecution(id, seconds(10)));
+    EXPECT_EQ(executor->getExecutionStatus(id), "cancelled");
+    executor.reset();
+    EXPECT_LT(steady_clock::now() - start, seconds(5));
+    // A send left on the stream would hold its call slot until the agent answered
+    EXPECT_TRUE(eventually([&]() { return orchestrator_->getChannelPoolStats().activeCalls == 0; }));
+}
+
+TEST_F(RemoteStepRunnerTest, StepTimeoutAbandonsTheResourceWait) {
+    connect(false);
+    RemoteStepRunner runner(orchestrator_, "orchestrator", resources_);
+    runner.setResourceNeed("analyzer", {"gpu", 1, 0, milliseconds(5000)});
+    auto held = resources_->requestResources({"other", "gpu", 1, 0, milliseconds(60000)});
+    ASSERT_TRUE(held.success);
+
+    auto executor = std::make_unique<WorkflowExecutor>(runner.stepRunner(), 1);
+    auto step = makeStep("starved", "analyze");
+    step.timeout = milliseconds(80);
+    ASSERT_TRUE(executor->defineWorkflow(makeWorkflow({step})));
+
+    auto start = steady_clock::now();
+    auto id = executor->executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(executor->waitForExecution(id, seconds(10)));
+    // Destroying the executor waits for the runner, so the wait itself was cut short
+    executor.reset();
+    EXPECT_LT(steady_clock::now() - start, seconds(2));
+    EXPECT_EQ(handled_.load(), 0);
+    EXPECT_EQ(resources_->getResourceStats("gpu")["cancelled_waits"], 1.0);
+
+    resources_->releaseResources(held.allocationId);
+    EXPECT_EQ(resources_->getAvailableTokens("gpu"), 1);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/communication/grpc_protocol.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::communication;
+using namespace std::chrono;
+
+using Protocol = GrpcCommunicationProtocol;
+
+namespace {
+
+// Holds handlers until opened, so sends stay in flight as long as a test needs
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// Outcomes of async sends, in completion order
+class Outcomes {
+public:
+    std::function<void(const Protocol::AgentResponse&)> callback(const std::string& label) {
+        return [this, label](const Protocol::AgentResponse& response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.push_back(label + (response.success ? ":ok" : ":failed"));
+            cv_.notify_all();
+        };
+    }
+
+    std::vector<std::string> waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, seconds(10), [&]() { return results_.size() >= count; });
+        return results_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::string> results_;
+};
+
+} // namespace
+
+class SendQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        address_ = "127.0.0.1:" + std::to_string(53400 + nextPort_++);
+        ASSERT_TRUE(server_.initializeServer(address_, "", ""));
+        server_.registerMessageHandler("work", [this](const Protocol::AgentMessage& message) {
+            gate_.wait();
+            Protocol::AgentResponse response{};
+            response.success = true;
+            response.correlationId = message.correlationId;
+            return response;
+        });
+        ASSERT_TRUE(server_.startServer());
+        client_.setInProcessDelivery(false);
+        ASSERT_TRUE(client_.initializeClient(address_, "", "", ""));
+    }
+
+    void TearDown() override {
+        gate_.open();
+        server_.stopServer();
+    }
+
+    void configure(size_t maxInFlight, size_t maxQueued, Protocol::OverflowPolicy overflow,
+                   milliseconds blockTimeout = milliseconds(0)) {
+        Protocol::SendQueueOptions options;
+        options.maxInFlight = maxInFlight;
+        options.maxQueued = maxQueued;
+        options.overflow = overflow;
+        options.blockTimeout = blockTimeout;
+        client_.setSendQueueOptions(options);
+    }
+
+    bool send(const std::string& label) {
+        Protocol::AgentMessage message{};
+        message.senderId = "client";
+        message.receiverId = "server";
+        message.messageType = "work";
+        message.correlationId = label;
+        return client_.sendMessageAsync(message, outcomes_.callback(label));
+    }
+
+    Protocol::SendQueueStats stats() const {
+        auto all = client_.getSendQueueStats();
+        return all.empty() ? Protocol::SendQueueStats{} : all.front();
+    }
+
+    static int nextPort_;
+    std::string address_;
+    Gate gate_;
+    Outcomes outcomes_;
+    Protocol server_;
+    Protocol client_;
+};
+
+int SendQueueTest::nextPort_ = 0;
+
+TEST_F(SendQueueTest, RejectRefusesSendsBeyondTheQueue) {
+    configure(1, 1, Protocol::OverflowPolicy::REJECT);
+    EXPECT_TRUE(send("first"));
+    EXPECT_TRUE(send("queued"));
+    EXPECT_FALSE(send("rejected"));
+
+    auto current = stats();
+    EXPECT_EQ(current.inFlight, 1u);
+    EXPECT_EQ(current.queued, 1u);
+    EXPECT_EQ(current.rejected, 1u);
+
+    gate_.open();
+    auto results = outcomes_.waitFor(2);
+    EXPECT_EQ(results, (std::vector<std::string>{"first:ok", "queued:ok"}));
+}
+
+TEST_F(SendQueueTest, DropOldestFailsTheOldestQueuedSend) {
+    configure(1, 2, Protocol::OverflowPolicy::DROP_OLDEST);
+    EXPECT_TRUE(send("first"));
+    EXPECT_TRUE(send("second"));
+    EXPECT_TRUE(send("third"));
+    EXPECT_TRUE(send("fourth"));
+
+    // The drop is reported at once, before anything completes
+    EXPECT_EQ(outcomes_.waitFor(1), std::vector<std::string>{"second:failed"});
+    EXPECT_EQ(stats().dropped, 1u);
+    EXPECT_EQ(stats().peakQueued, 2u);
+
+    gate_.open();
+    auto results = outcomes_.waitFor(4);
+    EXPECT_EQ(results, (std::vector<std::string>{"second:failed", "first:ok", "third:ok", "fourth:ok"}));
+}
+
+TEST_F(SendQueueTest, DropOldestWithoutQueueRejects) {
+    configure(1, 0, Protocol::OverflowPolicy::DROP_OLDEST);
+    EXPECT_TRUE(send("first"));
+    EXPECT_FALSE(send("second"));
+    EXPECT_EQ(stats().rejected, 1u);
+    EXPECT_EQ(stats().dropped, 0u);
+}
+
+TEST_F(SendQueueTest, BlockWaitsForRoomUntilItsTimeout) {
+    configure(1, 0, Protocol::OverflowPolicy::BLOCK, milliseconds(100));
+    EXPECT_TRUE(send("first"));
+
+    auto start = steady_clock::now();
+    EXPECT_FALSE(send("timed out"));
+    EXPECT_GE(steady_clock::now() - start, milliseconds(90));
+    EXPECT_EQ(stats().blocked, 1u);
+    EXPECT_EQ(stats().rejected, 1u);
+
+    std::thread opener([this]() {
+        std::this_thread::sleep_for(milliseconds(30));
+        gate_.open();
+    });
+    EXPECT_TRUE(send("admitted"));
+    opener.join();
+    EXPECT_EQ(outcomes_.waitFor(2), (std::vector<std::string>{"first:ok", "admitted:ok"}));
+}
+
+TEST_F(SendQueueTest, BlockedSenderSeesRaisedLimits) {
+    configure(1, 0, Protocol::OverflowPolicy::BLOCK);
+    EXPECT_TRUE(send("first"));
+
+    std::thread raise([this]() {
+        std::this_thread::sleep_for(milliseconds(30));
+        configure(2, 0, Protocol::OverflowPolicy::BLOCK);
+    });
+    // The gate stays closed, so only the new limit can let this through
+    EXPECT_TRUE(send("second"));
+    raise.join();
+    EXPECT_EQ(stats().inFlight, 2u);
+    EXPECT_EQ(stats().blocked, 1u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/resources/token_bucket_manager.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::resources;
+using namespace std::chrono;
+
+using Manager = TokenBucketResourceManager;
+
+class TokenBucketManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        clock_ = std::make_shared<VirtualClock>();
+        manager_ = std::make_unique<Manager>(clock_);
+        ASSERT_TRUE(manager_->registerResource({"gpu", 4, 1, 4, milliseconds(1000)}));
+        ASSERT_TRUE(manager_->registerResource({"cpu", 100, 10, 100, milliseconds(1000)}));
+    }
+
+    Manager::ReservationRequest reservation(const std::string& resourceType, int tokens,
+                                            seconds startIn, milliseconds window = milliseconds(1000)) {
+        return {"planner", resourceType, tokens, clock_->now() + startIn, window, milliseconds(60000)};
+    }
+
+    Manager::ResourceRequest request(const std::string& agentId, const std::string& resourceType, int tokens) {
+        return {agentId, resourceType, tokens, 0, milliseconds(60000)};
+    }
+
+    void advance(milliseconds delta) {
+        clock_->advance(delta);
+        manager_->runMaintenance();
+    }
+
+    std::shared_ptr<VirtualClock> clock_;
+    std::unique_ptr<Manager> manager_;
+};
+
+TEST_F(TokenBucketManagerTest, ReservationWithholdsTokensOnceItsWindowOpens) {
+    auto booked = manager_->reserveResources(reservation("gpu", 3, seconds(10)));
+    ASSERT_TRUE(booked.success) << booked.errorMessage;
+
+    // Before the window the tokens are still free for immediate requests
+    EXPECT_EQ(manager_->getAvailableTokens("gpu"), 4);
+    EXPECT_EQ(manager_->getReservedTokens("gpu"), 0);
+
+    advance(seconds(10));
+    EXPECT_EQ(manager_->getReservedTokens("gpu"), 3);
+    EXPECT_EQ(manager_->getAvailableTokens("gpu"), 1);
+    EXPECT_FALSE(manager_->requestResources(request("other", "gpu", 2)).success);
+
+    auto claimed = manager_->claimReservation(booked.reservationId);
+    ASSERT_TRUE(claimed.success) << claimed.errorMessage;
+    EXPECT_EQ(claimed.tokensAllocated, 3);
+    EXPECT_EQ(manager_->getReservedTokens("gpu"), 0);
+    EXPECT_EQ(manager_->getAgentAllocation("planner", "gpu"), 3);
+    EXPECT_FALSE(manager_->claimReservation(booked.reservationId).success);
+}
+
+TEST_F(TokenBucketManagerTest, ActiveClaimLeavesTokensWithheldForOtherReservations) {
+    auto held = manager_->requestResources(request("other", "gpu", 2));
+    ASSERT_TRUE(held.success);
+    auto first = manager_->reserveResources(reservation("gpu", 2, seconds(0)));
+    auto second = manager_->reserveResources(reservation("gpu", 2, seconds(0)));
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+
+    // Both windows are open but only two of their four tokens are in the bucket
+    EXPECT_EQ(manager_->getReservedTokens("gpu"), 4);
+    EXPECT_FALSE(manager_->claimReservation(second.reservationId).success);
+
+    ASSERT_TRUE(manager_->releaseResources(held.allocationId));
+    EXPECT_TRUE(manager_->claimReservation(first.reservationId).success);
+    EXPECT_TRUE(manager_->claimReservation(second.reservationId).success);
+    EXPECT_EQ(manager_->getAvailableTokens("gpu"), 0);
+    EXPECT_EQ(manager_->getReservedTokens("gpu"), 0);
+}
+
+TEST_F(TokenBucketManagerTest, OverlappingReservationsCannotExceedCapacity) {
+    ASSERT_TRUE(manager_->reserveResources(reservation("gpu", 3, seconds(10), milliseconds(5000))).success);
+
+    auto overlapping = manager_->reserveResources(reservation("gpu", 2, seconds(12)));
+    EXPECT_FALSE(overlapping.success);
+    EXPECT_FALSE(overlapping.errorMessage.empty());
+
+    EXPECT_TRUE(manager_->reserveResources(reservation("gpu", 1, seconds(12))).success);
+    EXPECT_TRUE(manager_->reserveResources(reservation("gpu", 4, seconds(20))).success);
+    EXPECT_FALSE(manager_->reserveResources(reservation("disk", 1, seconds(1))).success);
+}
+
+TEST_F(TokenBucketManagerTest, UnclaimedReservationExpiresAfterItsWindow) {
+    auto booked = manager_->reserveResources(reservation("cpu", 50, seconds(0)));
+    ASSERT_TRUE(booked.success);
+    EXPECT_EQ(manager_->getReservedTokens("cpu"), 50);
+
+    advance(milliseconds(2000));
+    EXPECT_EQ(manager_->getReservedTokens("cpu"), 0);
+    EXPECT_EQ(manager_->getResourceStats("cpu")["pending_reservations"], 0.0);
+    EXPECT_FALSE(manager_->claimReservation(booked.reservationId).success);
+    EXPECT_FALSE(manager_->cancelReservation(booked.reservationId));
+    EXPECT_TRUE(manager_->requestResources(request("worker", "cpu", 100)).success);
+}
+
+TEST_F(TokenBucketManagerTest, CancelledReservationReturnsItsTokens) {
+    auto booked = manager_->reserveResources(reservation("cpu", 40, seconds(0)));
+    ASSERT_TRUE(booked.success);
+    EXPECT_EQ(manager_->getAvailableTokens("cpu"), 60);
+
+    EXPECT_TRUE(manager_->cancelReservation(booked.reservationId));
+    EXPECT_FALSE(manager_->cancelReservation(booked.reservationId));
+    EXPECT_EQ(manager_->getReservedTokens("cpu"), 0);
+    EXPECT_EQ(manager_->getAvailableTokens("cpu"), 100);
+}
+
+TEST_F(TokenBucketManagerTest, EarlyClaimDrawsOnTheUnreservedPool) {
+    auto booked = manager_->reserveResources(reservation("gpu", 2, seconds(30)));
+    ASSERT_TRUE(booked.success);
+    auto held = manager_->requestResources(request("other", "gpu", 3));
+    ASSERT_TRUE(held.success);
+
+    // One token left and the window not open yet
+    EXPECT_FALSE(manager_->claimReservation(booked.reservationId).success);
+
+    ASSERT_TRUE(manager_->releaseResources(held.allocationId));
+    auto claimed = manager_->claimReservation(booked.reservationId);
+    ASSERT_TRUE(claimed.success) << claimed.errorMessage;
+    EXPECT_EQ(manager_->getAvailableTokens("gpu"), 2);
+}
+
+TEST_F(TokenBucketManagerTest, ConcurrentChargesNeverExceedTheQuota) {
+    ASSERT_TRUE(manager_->setAgentQuota("capped", "cpu", 7));
+
+    std::atomic<int> granted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 50; ++i) {
+                if (manager_->requestResources(request("capped", "cpu", 1)).success) {
+                    granted++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(granted.load(), 7);
+    EXPECT_EQ(manager_->getAgentAllocation("capped", "cpu"), 7);
+    auto denied = manager_->requestResources(request("capped", "cpu", 1));
+    EXPECT_FALSE(denied.success);
+    EXPECT_EQ(denied.errorMessage, "Agent quota exceeded");
+}
+
+TEST_F(TokenBucketManagerTest, QuotaRefusalLeavesBucketAndLedgerUntouched) {
+    ASSERT_TRUE(manager_->setAgentQuota("capped", "cpu", 5));
+    EXPECT_FALSE(manager_->requestResources(request("capped", "cpu", 6)).success);
+    EXPECT_EQ(manager_->getAgentAllocation("capped", "cpu"), 0);
+    EXPECT_EQ(manager_->getAvailableTokens("cpu"), 100);
+
+    // A charge the bucket cannot cover is refunded to the quota
+    EXPECT_FALSE(manager_->requestResources(request("greedy", "gpu", 5)).success);
+    EXPECT_EQ(manager_->getAgentAllocation("greedy", "gpu"), 0);
+}
+
+TEST_F(TokenBucketManagerTest, ReleaseAndExpiryReturnTokensToTheLedger) {
+    auto first = manager_->requestResources(request("worker", "cpu", 10));
+    auto second = manager_->requestResources({"worker", "cpu", 5, 0, milliseconds(3000)});
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+    EXPECT_EQ(manager_->getAgentAllocation("worker", "cpu"), 15);
+
+    EXPECT_TRUE(manager_->releaseResources(first.allocationId));
+    EXPECT_FALSE(manager_->releaseResources(first.allocationId));
+    EXPECT_EQ(manager_->getAgentAllocation("worker", "cpu"), 5);
+
+    advance(seconds(4));
+    EXPECT_EQ(manager_->getAgentAllocation("worker", "cpu"), 0);
+    EXPECT_FALSE(manager_->releaseResources(second.allocationId));
+}
+
+TEST_F(TokenBucketManagerTest, QuotaSurvivesIdleEntryReclamation) {
+    ASSERT_TRUE(manager_->setAgentQuota("capped", "cpu", 2));
+    for (int i = 0; i < 100; ++i) {
+        auto allocation = manager_->requestResources(request("transient" + std::to_string(i), "cpu", 1));
+        ASSERT_TRUE(allocation.success);
+        ASSERT_TRUE(manager_->releaseResources(allocation.allocationId));
+    }
+    advance(seconds(1));
+
+    EXPECT_EQ(manager_->getAgentAllocation("transient0", "cpu"), 0);
+    EXPECT_FALSE(manager_->requestResources(request("capped", "cpu", 3)).success);
+    EXPECT_TRUE(manager_->requestResources(request("capped", "cpu", 2)).success);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
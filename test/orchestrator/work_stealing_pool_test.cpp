@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/workflow/work_stealing_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dist_prompt::orchestrator::workflow;
+using namespace std::chrono;
+
+namespace {
+
+// Holds tasks until opened, so a worker stays busy as long as a test needs
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// Counts finished tasks and lets the test wait for a number of them
+class Latch {
+public:
+    void countDown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_++;
+        cv_.notify_all();
+    }
+
+    bool waitFor(int count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, seconds(10), [&]() { return count_ >= count; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_ = 0;
+};
+
+} // namespace
+
+TEST(WorkStealingPoolTest, RunsEveryTaskOnItsWorkers) {
+    WorkStealingPool pool(3);
+    EXPECT_EQ(pool.threadCount(), 3u);
+    EXPECT_FALSE(pool.isWorkerThread());
+
+    std::atomic<int> ran{0};
+    std::atomic<int> offWorker{0};
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(pool.submit([&]() {
+            if (!pool.isWorkerThread()) {
+                offWorker++;
+            }
+            ran++;
+        }));
+    }
+    pool.stop();
+
+    EXPECT_EQ(ran.load(), 100);
+    EXPECT_EQ(offWorker.load(), 0);
+    EXPECT_EQ(pool.executed(), 100u);
+}
+
+TEST(WorkStealingPoolTest, WorkerRunsItsOwnTasksNewestFirst) {
+    WorkStealingPool pool(1);
+    std::mutex mutex;
+    std::vector<std::string> order;
+    Latch done;
+
+    ASSERT_TRUE(pool.submit([&]() {
+        for (const char* name : {"a", "b", "c"}) {
+            pool.submit([&, name]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(name);
+                done.countDown();
+            });
+        }
+    }));
+    ASSERT_TRUE(done.waitFor(3));
+
+    EXPECT_EQ(order, (std::vector<std::string>{"c", "b", "a"}));
+    EXPECT_EQ(pool.steals(), 0u);
+}
+
+TEST(WorkStealingPoolTest, IdleWorkerStealsFromABusyOne) {
+    WorkStealingPool pool(2);
+    std::mutex mutex;
+    std::set<std::thread::id> childThreads;
+    std::thread::id parentThread;
+    Latch children;
+    Latch parentDone;
+
+    // The parent keeps its worker busy until the children it queued have run,
+    // so only the other worker can take them, oldest first
+    ASSERT_TRUE(pool.submit([&]() {
+        parentThread = std::this_thread::get_id();
+        for (int i = 0; i < 4; ++i) {
+            pool.submit([&]() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    childThreads.insert(std::this_thread::get_id());
+                }
+                children.countDown();
+            });
+        }
+        children.waitFor(4);
+        parentDone.countDown();
+    }));
+    ASSERT_TRUE(parentDone.waitFor(1));
+
+    EXPECT_EQ(childThreads.size(), 1u);
+    EXPECT_EQ(childThreads.count(parentThread), 0u);
+    EXPECT_EQ(pool.steals(), 4u);
+}
+
+TEST(WorkStealingPoolTest, StopRunsQueuedTasksAndRejectsNewOnes) {
+    WorkStealingPool pool(1);
+    Gate gate;
+    std::atomic<int> ran{0};
+    std::atomic<bool> followUpAccepted{false};
+    std::atomic<bool> followUpRan{false};
+
+    ASSERT_TRUE(pool.submit([&]() { gate.wait(); }));
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(pool.submit([&]() { ran++; }));
+    }
+    ASSERT_TRUE(pool.submit([&]() {
+        followUpAccepted = pool.submit([&]() { followUpRan = true; });
+    }));
+
+    std::thread stopper([&]() { pool.stop(); });
+    auto deadline = steady_clock::now() + seconds(10);
+    int accepted = 0;
+    while (pool.submit([]() {})) {
+        accepted++;
+        ASSERT_LT(steady_clock::now(), deadline);
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+
+    // Tasks queued before stop() still run, including follow-ups queued by workers
+    gate.open();
+    stopper.join();
+    EXPECT_EQ(ran.load(), 5);
+    EXPECT_TRUE(followUpAccepted.load());
+    EXPECT_TRUE(followUpRan.load());
+    EXPECT_EQ(pool.executed(), static_cast<uint64_t>(8 + accepted));
+
+    EXPECT_FALSE(pool.submit([]() {}));
+    pool.stop();
+}
+
+TEST(WorkStealingPoolTest, DestructorDrainsTheQueues) {
+    std::atomic<int> ran{0};
+    {
+        WorkStealingPool pool(2);
+        for (int i = 0; i < 50; ++i) {
+            ASSERT_TRUE(pool.submit([&]() {
+                std::this_thread::sleep_for(microseconds(100));
+                ran++;
+            }));
+        }
+    }
+    EXPECT_EQ(ran.load(), 50);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,697 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/resources/token_bucket_manager.h"
+#include "orchestrator/workflow/step_result_cache.h"
+#include "orchestrator/workflow/workflow_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+using namespace dist_prompt;
+using namespace dist_prompt::orchestrator::workflow;
+using namespace std::chrono;
+
+using Invocation = WorkflowExecutor::StepInvocation;
+
+namespace {
+
+integration::WorkflowStep makeStep(const std::string& stepId, std::vector<std::string> dependencies = {},
+                                   std::map<std::string, std::string> parameters = {}) {
+    integration::WorkflowStep step{};
+    step.stepId = stepId;
+    step.agentType = "agent";
+    step.action = stepId;
+    step.parameters = std::move(parameters);
+    step.dependencies = std::move(dependencies);
+    return step;
+}
+
+integration::Workflow makeWorkflow(std::vector<integration::WorkflowStep> steps) {
+    integration::Workflow workflow{};
+    workflow.workflowId = "wf";
+    workflow.steps = std::move(steps);
+    return workflow;
+}
+
+integration::ExecutionResult succeed(std::string data) {
+    integration::ExecutionResult result{};
+    result.success = true;
+    result.resultData = std::move(data);
+    return result;
+}
+
+integration::ExecutionResult fail(std::string error) {
+    integration::ExecutionResult result{};
+    result.success = false;
+    result.errorMessage = std::move(error);
+    return result;
+}
+
+// Step events of one execution, in the order they were reported
+class EventLog {
+public:
+    integration::WorkflowCallback callback() {
+        return [this](const std::string&, const std::string& stepId, const std::string& event,
+                      const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.emplace_back(stepId, event);
+        };
+    }
+
+    bool saw(const std::string& stepId, const std::string& event) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::find(events_.begin(), events_.end(), std::make_pair(stepId, event)) != events_.end();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, std::string>> events_;
+};
+
+// Step IDs the runner was called for, attempts included
+class RunLog {
+public:
+    void record(const Invocation& invocation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        runs_.push_back(invocation.step->stepId);
+    }
+
+    std::vector<std::string> take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto runs = std::move(runs_);
+        runs_.clear();
+        std::sort(runs.begin(), runs.end());
+        return runs;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> runs_;
+};
+
+integration::ExecutionContext makeContext(std::map<std::string, std::string> variables = {}) {
+    integration::ExecutionContext context{};
+    context.contextId = "ctx";
+    context.variables = std::move(variables);
+    return context;
+}
+
+// Fresh directory under the system temp dir, removed when the test ends
+class ScratchDirectory {
+public:
+    explicit ScratchDirectory(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() /
+                (name + "-" + std::to_string(::getpid()))) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+
+    ~ScratchDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+TEST(WorkflowExecutorTest, FanOutRunsBranchesConcurrentlyAndJoinsInOrder) {
+    const int branches = 4;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int arrived = 0;
+    int concurrent = 0;
+
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        const auto& stepId = invocation.step->stepId;
+        if (stepId.rfind("branch", 0) == 0) {
+            // Each branch waits until all of them are running at once
+            std::unique_lock<std::mutex> lock(mutex);
+            arrived++;
+            cv.notify_all();
+            if (cv.wait_for(lock, seconds(5), [&]() { return arrived == branches; })) {
+                concurrent++;
+            }
+            return succeed(stepId.substr(6) + "<" + invocation.inputs.at(0)->resultData);
+        }
+        std::string joined;
+        for (const auto* input : invocation.inputs) {
+            joined += "[" + input->resultData + "]";
+        }
+        return succeed(stepId + joined);
+    }, branches);
+
+    std::vector<integration::WorkflowStep> steps{makeStep("source")};
+    std::vector<std::string> joinDependencies;
+    for (int i = 0; i < branches; ++i) {
+        steps.push_back(makeStep("branch" + std::to_string(i), {"source"}));
+        joinDependencies.push_back("branch" + std::to_string(i));
+    }
+    std::reverse(joinDependencies.begin(), joinDependencies.end());
+    steps.push_back(makeStep("join", joinDependencies));
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow(steps)));
+
+    EventLog events;
+    auto id = executor.executeWorkflow("wf", makeContext(), events.callback());
+    ASSERT_FALSE(id.empty());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+
+    EXPECT_EQ(concurrent, branches);
+    auto results = executor.getExecutionResults(id);
+    EXPECT_TRUE(results.success) << results.errorMessage;
+    EXPECT_EQ(executor.getExecutionStatus(id), "completed");
+    EXPECT_EQ(results.outputs["join"], "join[3<source][2<source][1<source][0<source]");
+    EXPECT_TRUE(events.saw("join", "step_completed"));
+    EXPECT_TRUE(events.saw("", "workflow_completed"));
+    EXPECT_EQ(executor.getStatistics()["steps_completed"], branches + 2.0);
+}
+
+TEST(WorkflowExecutorTest, ReadyStepWithLongestRemainingPathStartsFirst) {
+    // After a root step, a one-step branch and a three-step chain are ready
+    // together; the branch is listed first, so FIFO order would run it first.
+    // Returns the order in which one execution started its steps once a few
+    // runs with the given action durations have seeded the history.
+    auto startOrder = [](const std::map<std::string, milliseconds>& durations) {
+        std::mutex mutex;
+        std::vector<std::string> started;
+        WorkflowExecutor executor([&](const Invocation& invocation) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                started.push_back(invocation.step->stepId);
+            }
+            std::this_thread::sleep_for(durations.at(invocation.step->action));
+            return succeed("");
+        }, 1);
+        EXPECT_TRUE(executor.defineWorkflow(makeWorkflow({
+            makeStep("root"), makeStep("branch", {"root"}), makeStep("chain1", {"root"}),
+            makeStep("chain2", {"chain1"}), makeStep("chain3", {"chain2"})})));
+
+        for (int i = 0; i < 4; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                started.clear();
+            }
+            auto id = executor.executeWorkflow("wf", makeContext());
+            EXPECT_TRUE(executor.waitForExecution(id, seconds(10)));
+            EXPECT_TRUE(executor.getExecutionResults(id).success);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return started;
+    };
+
+    auto chainFirst = startOrder({{"root", milliseconds(1)}, {"branch", milliseconds(1)},
+                                  {"chain1", milliseconds(8)}, {"chain2", milliseconds(8)},
+                                  {"chain3", milliseconds(8)}});
+    EXPECT_EQ(chainFirst, (std::vector<std::string>{"root", "chain1", "chain2", "chain3", "branch"}));
+
+    // History, not step count, decides: a slow enough branch outranks the chain
+    auto branchFirst = startOrder({{"root", milliseconds(1)}, {"branch", milliseconds(40)},
+                                   {"chain1", milliseconds(2)}, {"chain2", milliseconds(2)},
+                                   {"chain3", milliseconds(2)}});
+    ASSERT_EQ(branchFirst.size(), 5u);
+    EXPECT_EQ(branchFirst[0], "root");
+    EXPECT_EQ(branchFirst[1], "branch");
+}
+
+TEST(WorkflowExecutorTest, FailedStepStopsFurtherLaunches) {
+    RunLog runs;
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        runs.record(invocation);
+        if (invocation.step->stepId == "broken") {
+            return fail("bad input");
+        }
+        return succeed(invocation.step->stepId);
+    }, 2);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({
+        makeStep("first"), makeStep("broken", {"first"}), makeStep("after", {"broken"}),
+    })));
+
+    EventLog events;
+    auto id = executor.executeWorkflow("wf", makeContext(), events.callback());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+
+    EXPECT_EQ(executor.getExecutionStatus(id), "failed");
+    auto results = executor.getExecutionResults(id);
+    EXPECT_FALSE(results.success);
+    EXPECT_EQ(results.errorMessage, "broken: bad input");
+    EXPECT_EQ(results.outputs.count("first"), 1u);
+    EXPECT_EQ(results.outputs.count("after"), 0u);
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"broken", "first"}));
+    EXPECT_TRUE(events.saw("broken", "step_failed"));
+    EXPECT_TRUE(events.saw("", "workflow_failed"));
+}
+
+TEST(WorkflowExecutorTest, RunnerExceptionFailsTheStep) {
+    WorkflowExecutor executor([](const Invocation&) -> integration::ExecutionResult {
+        throw std::runtime_error("simulation crashed");
+    }, 1);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({makeStep("only")})));
+
+    auto id = executor.executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+    EXPECT_EQ(executor.getExecutionResults(id).errorMessage, "only: simulation crashed");
+}
+
+TEST(WorkflowExecutorTest, CancelStopsRunningStepAndSkipsPendingOnes) {
+    std::atomic<bool> started{false};
+    RunLog runs;
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        runs.record(invocation);
+        started = true;
+        while (!invocation.cancellation.isCancelled()) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        return fail("stopped");
+    }, 2);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({makeStep("long"), makeStep("next", {"long"})})));
+
+    EventLog events;
+    auto id = executor.executeWorkflow("wf", makeContext(), events.callback());
+    while (!started) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_TRUE(executor.cancelExecution(id));
+    EXPECT_FALSE(executor.cancelExecution(id));
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+
+    EXPECT_EQ(executor.getExecutionStatus(id), "cancelled");
+    EXPECT_EQ(runs.take(), std::vector<std::string>{"long"});
+    EXPECT_TRUE(events.saw("long", "step_cancelled"));
+    EXPECT_TRUE(events.saw("", "workflow_cancelled"));
+    EXPECT_EQ(executor.getStatistics()["executions_cancelled"], 1.0);
+}
+
+TEST(WorkflowExecutorTest, RejectsInvalidWorkflowsAndUnknownIds) {
+    WorkflowExecutor executor([](const Invocation&) { return succeed(""); }, 1);
+    EXPECT_FALSE(executor.defineWorkflow(makeWorkflow({makeStep("a", {"b"}), makeStep("b", {"a"})})));
+    EXPECT_TRUE(executor.executeWorkflow("wf", makeContext()).empty());
+    EXPECT_EQ(executor.getExecutionStatus("missing"), "unknown");
+    EXPECT_FALSE(executor.getExecutionResults("missing").success);
+    EXPECT_FALSE(executor.cancelExecution("missing"));
+}
+
+TEST(WorkflowExecutorTest, VersionedStepsAreMemoized) {
+    RunLog runs;
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        runs.record(invocation);
+        return succeed(invocation.step->stepId + "(" + invocation.parameters.at("input") + ")");
+    }, 2);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({
+        makeStep("decompose", {}, {{"input", "${idea}"}}),
+        makeStep("notify", {"decompose"}, {{"input", "done"}}),
+    })));
+    ScratchDirectory directory("step-result-cache");
+    StepResultCache::Options options;
+    options.directory = directory.path();
+    executor.setResultCache(std::make_shared<StepResultCache>(options));
+    executor.setActionVersion("agent", "decompose", "1");
+
+    auto run = [&](const std::string& idea) {
+        auto id = executor.executeWorkflow("wf", makeContext({{"idea", idea}}));
+        EXPECT_TRUE(executor.waitForExecution(id, seconds(10)));
+        EXPECT_EQ(executor.getExecutionResults(id).outputs["decompose"], "decompose(" + idea + ")");
+        return runs.take();
+    };
+
+    EXPECT_EQ(run("a"), (std::vector<std::string>{"decompose", "notify"}));
+    // Unversioned actions always run
+    EXPECT_EQ(run("a"), std::vector<std::string>{"notify"});
+    EXPECT_EQ(run("b"), (std::vector<std::string>{"decompose", "notify"}));
+
+    executor.setActionVersion("agent", "decompose", "2");
+    EXPECT_EQ(run("a"), (std::vector<std::string>{"decompose", "notify"}));
+    EXPECT_EQ(executor.getStatistics()["steps_memoized"], 1.0);
+
+    // A new cache over the same directory finds the results on disk
+    executor.setResultCache(std::make_shared<StepResultCache>(options));
+    EXPECT_EQ(run("a"), std::vector<std::string>{"notify"});
+}
+
+TEST(WorkflowExecutorTest, ResultCacheKeyCoversActionParametersAndInputs) {
+    integration::ExecutionResult input = succeed("upstream");
+    std::vector<const integration::ExecutionResult*> inputs{&input};
+    auto key = StepResultCache::makeKey("agent/run@1", {{"k", "v"}}, inputs);
+
+    EXPECT_EQ(key.size(), 32u);
+    EXPECT_EQ(key, StepResultCache::makeKey("agent/run@1", {{"k", "v"}}, inputs));
+    EXPECT_NE(key, StepResultCache::makeKey("agent/run@2", {{"k", "v"}}, inputs));
+    EXPECT_NE(key, StepResultCache::makeKey("agent/run@1", {{"k", "w"}}, inputs));
+    EXPECT_NE(key, StepResultCache::makeKey("agent/run@1", {{"k", "v"}}, {}));
+
+    StepResultCache cache(StepResultCache::Options{});
+    cache.store(key, fail("not stored"));
+    integration::ExecutionResult found{};
+    EXPECT_FALSE(cache.lookup(key, found));
+    cache.store(key, succeed("stored"));
+    ASSERT_TRUE(cache.lookup(key, found));
+    EXPECT_EQ(found.resultData, "stored");
+}
+
+TEST(WorkflowExecutorTest, ReexecutionRunsOnlyWhatChanged) {
+    RunLog runs;
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        runs.record(invocation);
+        const auto& stepId = invocation.step->stepId;
+        if (stepId == "normalize") {
+            // Case-insensitive, so "x" and "X" give the same result
+            return succeed(invocation.parameters.at("mode") == "y" ? "other" : "norm");
+        }
+        std::string data = stepId;
+        for (const auto& [key, value] : invocation.parameters) {
+            data += ";" + key + "=" + value;
+        }
+        for (const auto* input : invocation.inputs) {
+            data += "<" + input->resultData + ">";
+        }
+        return succeed(data);
+    }, 2);
+    auto workflow = makeWorkflow({
+        makeStep("decompose", {}, {{"idea", "${idea}"}}),
+        makeStep("normalize", {}, {{"mode", "${mode}"}}),
+        makeStep("simulate", {"decompose"}, {{"T", "${temp}"}}),
+        makeStep("report", {"simulate", "normalize"}),
+    });
+    workflow.globalParams["temp"] = "300";
+    ASSERT_TRUE(executor.defineWorkflow(workflow));
+
+    auto context = makeContext({{"idea", "a"}, {"mode", "x"}});
+    auto rerun = [&](const std::string& previous) {
+        auto id = previous.empty() ? executor.executeWorkflow("wf", context)
+                                   : executor.reexecuteWorkflow(previous, context);
+        EXPECT_FALSE(id.empty());
+        EXPECT_TRUE(executor.waitForExecution(id, seconds(10)));
+        EXPECT_EQ(executor.getExecutionStatus(id), "completed");
+        return id;
+    };
+
+    auto first = rerun("");
+    EXPECT_EQ(runs.take().size(), 4u);
+
+    auto unchanged = rerun(first);
+    EXPECT_TRUE(runs.take().empty());
+    EXPECT_EQ(executor.getExecutionResults(unchanged).outputs, executor.getExecutionResults(first).outputs);
+
+    context.variables["idea"] = "b";
+    auto idea = rerun(unchanged);
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"decompose", "report", "simulate"}));
+
+    // normalize runs again but its result is the same, so report is kept
+    context.variables["mode"] = "X";
+    auto mode = rerun(idea);
+    EXPECT_EQ(runs.take(), std::vector<std::string>{"normalize"});
+
+    workflow.globalParams["temp"] = "310";
+    ASSERT_TRUE(executor.defineWorkflow(workflow));
+    auto global = rerun(mode);
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"report", "simulate"}));
+    EXPECT_NE(executor.getExecutionResults(global).outputs["report"].find("T=310"), std::string::npos);
+
+    // A new version recomputes the step even though nothing else changed; its
+    // result is the same, so report is kept
+    executor.setActionVersion("agent", "simulate", "2");
+    auto versioned = rerun(global);
+    EXPECT_EQ(runs.take(), std::vector<std::string>{"simulate"});
+    rerun(versioned);
+    EXPECT_TRUE(runs.take().empty());
+
+    EXPECT_TRUE(executor.reexecuteWorkflow("missing", context).empty());
+}
+
+TEST(WorkflowExecutorTest, RunningExecutionCannotBeReexecuted) {
+    std::atomic<bool> release{false};
+    WorkflowExecutor executor([&](const Invocation&) {
+        while (!release) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        return succeed("");
+    }, 1);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({makeStep("only")})));
+
+    auto id = executor.executeWorkflow("wf", makeContext());
+    EXPECT_TRUE(executor.reexecuteWorkflow(id, makeContext()).empty());
+    release = true;
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+    auto again = executor.reexecuteWorkflow(id, makeContext());
+    ASSERT_FALSE(again.empty());
+    EXPECT_TRUE(executor.waitForExecution(again, seconds(10)));
+}
+
+TEST(WorkflowExecutorTest, ResumeReusesCheckpointedSteps) {
+    ScratchDirectory directory("workflow-checkpoints");
+    WorkflowExecutor::CheckpointOptions options;
+    options.directory = directory.path();
+    options.interval = milliseconds(0);
+
+    auto workflow = makeWorkflow({
+        makeStep("s0", {}, {{"T", "${T}"}}),
+        makeStep("s1", {"s0"}, {{"T", "${T}"}}),
+        makeStep("s2", {"s1"}, {{"T", "${T}"}}),
+        makeStep("s3", {"s2"}, {{"T", "${T}"}}),
+    });
+    std::atomic<bool> holdAtS2{true};
+    std::atomic<bool> reachedS2{false};
+    RunLog runs;
+    auto runner = [&](const Invocation& invocation) {
+        runs.record(invocation);
+        if (invocation.step->stepId == "s2" && holdAtS2) {
+            reachedS2 = true;
+            while (!invocation.cancellation.isCancelled()) {
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+            return fail("interrupted");
+        }
+        std::string data = invocation.step->stepId + "@" + invocation.parameters.at("T");
+        for (const auto* input : invocation.inputs) {
+            data += "<" + input->resultData;
+        }
+        return succeed(data);
+    };
+
+    std::string interrupted;
+    {
+        WorkflowExecutor executor(runner, 2);
+        ASSERT_TRUE(executor.defineWorkflow(workflow));
+        executor.setCheckpointOptions(options);
+        interrupted = executor.executeWorkflow("wf", makeContext({{"T", "300"}}));
+        while (!reachedS2) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        ASSERT_TRUE(executor.cancelExecution(interrupted));
+        ASSERT_TRUE(executor.waitForExecution(interrupted, seconds(10)));
+        EXPECT_EQ(executor.listCheckpoints(), std::vector<std::string>{interrupted});
+    }
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"s0", "s1", "s2"}));
+
+    // A fresh executor, as after a restart
+    holdAtS2 = false;
+    WorkflowExecutor executor(runner, 2);
+    ASSERT_TRUE(executor.defineWorkflow(workflow));
+    executor.setCheckpointOptions(options);
+    EXPECT_EQ(executor.listCheckpoints(), std::vector<std::string>{interrupted});
+    EXPECT_TRUE(executor.resumeExecution("missing").empty());
+
+    auto resumed = executor.resumeExecution(interrupted);
+    ASSERT_FALSE(resumed.empty());
+    ASSERT_TRUE(executor.waitForExecution(resumed, seconds(10)));
+    EXPECT_EQ(executor.getExecutionStatus(resumed), "completed");
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"s2", "s3"}));
+    EXPECT_EQ(executor.getExecutionResults(resumed).outputs["s3"], "s3@300<s2@300<s1@300<s0@300");
+    EXPECT_EQ(executor.getStatistics()["steps_reused"], 2.0);
+
+    // Completing the resumed run removes both checkpoints
+    EXPECT_TRUE(executor.listCheckpoints().empty());
+    EXPECT_TRUE(executor.resumeExecution(interrupted).empty());
+}
+
+TEST(WorkflowExecutorTest, ResumeRecomputesStepsChangedSinceTheCheckpoint) {
+    ScratchDirectory directory("workflow-checkpoints-changed");
+    WorkflowExecutor::CheckpointOptions options;
+    options.directory = directory.path();
+    options.interval = milliseconds(0);
+
+    RunLog runs;
+    std::atomic<bool> failLast{true};
+    auto runner = [&](const Invocation& invocation) {
+        runs.record(invocation);
+        if (invocation.step->stepId == "last" && failLast) {
+            return fail("flaky");
+        }
+        return succeed(invocation.step->stepId + ":" + invocation.parameters.at("k"));
+    };
+    auto workflow = makeWorkflow({
+        makeStep("kept", {}, {{"k", "1"}}),
+        makeStep("edited", {}, {{"k", "1"}}),
+        makeStep("last", {"kept", "edited"}, {{"k", "1"}}),
+    });
+
+    WorkflowExecutor executor(runner, 2);
+    ASSERT_TRUE(executor.defineWorkflow(workflow));
+    executor.setCheckpointOptions(options);
+    auto failed = executor.executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(executor.waitForExecution(failed, seconds(10)));
+    ASSERT_EQ(executor.getExecutionStatus(failed), "failed");
+    runs.take();
+
+    failLast = false;
+    workflow.steps[1].parameters["k"] = "2";
+    ASSERT_TRUE(executor.defineWorkflow(workflow));
+    auto resumed = executor.resumeExecution(failed);
+    ASSERT_TRUE(executor.waitForExecution(resumed, seconds(10)));
+    EXPECT_EQ(runs.take(), (std::vector<std::string>{"edited", "last"}));
+    EXPECT_EQ(executor.getExecutionResults(resumed).outputs["edited"], "edited:2");
+}
+
+TEST(WorkflowExecutorTest, StragglerGetsASpeculativeDuplicate) {
+    std::atomic<bool> straggle{false};
+    std::atomic<bool> firstAttemptCancelled{false};
+    std::atomic<bool> firstAttemptReturned{false};
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        if (invocation.attempt == 0 && straggle) {
+            // Hangs until the duplicate's result makes it redundant
+            auto deadline = steady_clock::now() + seconds(5);
+            while (!invocation.cancellation.isCancelled() && steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+            firstAttemptCancelled = invocation.cancellation.isCancelled();
+            firstAttemptReturned = true;
+            return fail("straggler");
+        }
+        std::this_thread::sleep_for(milliseconds(5));
+        return succeed("attempt" + std::to_string(invocation.attempt));
+    }, 2);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({makeStep("work")})));
+    WorkflowExecutor::SpeculationOptions options;
+    options.enabled = true;
+    options.minSamples = 5;
+    options.minDelay = milliseconds(20);
+    executor.setSpeculationOptions(options);
+
+    for (int i = 0; i < 8; ++i) {
+        auto warmup = executor.executeWorkflow("wf", makeContext());
+        ASSERT_TRUE(executor.waitForExecution(warmup, seconds(10)));
+    }
+    EXPECT_EQ(executor.getStatistics()["speculative_attempts"], 0.0);
+
+    straggle = true;
+    EventLog events;
+    auto start = steady_clock::now();
+    auto id = executor.executeWorkflow("wf", makeContext(), events.callback());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+    EXPECT_LT(steady_clock::now() - start, seconds(2));
+
+    auto results = executor.getExecutionResults(id);
+    EXPECT_TRUE(results.success) << results.errorMessage;
+    EXPECT_EQ(results.outputs["work"], "attempt1");
+    EXPECT_TRUE(events.saw("work", "step_speculated"));
+    auto stats = executor.getStatistics();
+    EXPECT_EQ(stats["speculative_attempts"], 1.0);
+    EXPECT_EQ(stats["speculative_wins"], 1.0);
+
+    // The losing attempt is told to stop
+    auto deadline = steady_clock::now() + seconds(5);
+    while (!firstAttemptReturned && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    ASSERT_TRUE(firstAttemptReturned.load());
+    EXPECT_TRUE(firstAttemptCancelled.load());
+}
+
+TEST(WorkflowExecutorTest, NoSpeculationWithoutEnoughHistory) {
+    std::atomic<int> attempts{0};
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        attempts++;
+        if (invocation.attempt == 0) {
+            std::this_thread::sleep_for(milliseconds(150));
+        }
+        return succeed("");
+    }, 2);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({makeStep("work")})));
+    WorkflowExecutor::SpeculationOptions options;
+    options.enabled = true;
+    options.minSamples = 5;
+    options.minDelay = milliseconds(10);
+    executor.setSpeculationOptions(options);
+
+    auto id = executor.executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+    EXPECT_EQ(attempts.load(), 1);
+}
+
+TEST(WorkflowExecutorTest, StepTimeoutFailsWithoutWaitingForTheRunner) {
+    std::atomic<bool> runnerReturned{false};
+    WorkflowExecutor executor([&](const Invocation& invocation) {
+        if (invocation.step->stepId == "stuck") {
+            // Ignores its token
+            std::this_thread::sleep_for(milliseconds(500));
+            runnerReturned = true;
+        }
+        return succeed(invocation.step->stepId);
+    }, 2);
+    auto stuck = makeStep("stuck");
+    stuck.timeout = milliseconds(50);
+    ASSERT_TRUE(executor.defineWorkflow(makeWorkflow({stuck, makeStep("after", {"stuck"})})));
+
+    EventLog events;
+    auto id = executor.executeWorkflow("wf", makeContext(), events.callback());
+    ASSERT_TRUE(executor.waitForExecution(id, seconds(10)));
+    EXPECT_FALSE(runnerReturned.load());
+
+    auto results = executor.getExecutionResults(id);
+    EXPECT_EQ(executor.getExecutionStatus(id), "failed");
+    EXPECT_EQ(results.errorMessage, "stuck: Timed out after 50 ms");
+    EXPECT_EQ(results.outputs.count("after"), 0u);
+    EXPECT_TRUE(events.saw("stuck", "step_failed"));
+    EXPECT_EQ(executor.getStatistics()["steps_timed_out"], 1.0);
+}
+
+TEST(WorkflowExecutorTest, StepTokenCarriesTheTimeoutIntoResourceWaits) {
+    using orchestrator::resources::TokenBucketResourceManager;
+    TokenBucketResourceManager manager;
+    ASSERT_TRUE(manager.registerResource({"gpu", 1, 0, 1, milliseconds(1000)}));
+    auto held = manager.requestResources({"other", "gpu", 1, 0, milliseconds(60000)});
+    ASSERT_TRUE(held.success);
+
+    std::string waitError;
+    std::atomic<bool> hadDeadline{false};
+    auto executor = std::make_unique<WorkflowExecutor>([&](const Invocation& invocation) {
+        hadDeadline = invocation.cancellation.remaining() <= milliseconds(80);
+        auto allocation = manager.acquireResources({"sim", "gpu", 1, 0, milliseconds(1000)},
+                                                   milliseconds(5000), invocation.cancellation);
+        waitError = allocation.errorMessage;
+        return allocation.success ? succeed("") : fail(allocation.errorMessage);
+    }, 1);
+    auto step = makeStep("simulate");
+    step.timeout = milliseconds(80);
+    ASSERT_TRUE(executor->defineWorkflow(makeWorkflow({step})));
+
+    auto start = steady_clock::now();
+    auto id = executor->executeWorkflow("wf", makeContext());
+    ASSERT_TRUE(executor->waitForExecution(id, seconds(10)));
+    // Destroying the executor waits for the runner, so the wait itself was cut short
+    executor.reset();
+    EXPECT_LT(steady_clock::now() - start, seconds(2));
+    EXPECT_TRUE(hadDeadline.load());
+    EXPECT_EQ(waitError.rfind("Cancelled", 0), 0u) << waitError;
+    EXPECT_EQ(manager.getResourceStats("gpu")["cancelled_waits"], 1.0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
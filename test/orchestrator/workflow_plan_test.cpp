@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "orchestrator/workflow/workflow_plan.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace dist_prompt;
+using namespace dist_prompt::orchestrator::workflow;
+
+namespace {
+
+integration::WorkflowStep makeStep(const std::string& stepId, std::vector<std::string> dependencies = {}) {
+    integration::WorkflowStep step{};
+    step.stepId = stepId;
+    step.agentType = "agent";
+    step.action = "run";
+    step.dependencies = std::move(dependencies);
+    return step;
+}
+
+integration::Workflow makeWorkflow(std::vector<integration::WorkflowStep> steps) {
+    integration::Workflow workflow{};
+    workflow.workflowId = "wf";
+    workflow.steps = std::move(steps);
+    return workflow;
+}
+
+std::vector<std::string> stepIds(const WorkflowPlan& plan, WorkflowPlan::IndexRange range) {
+    std::vector<std::string> ids;
+    for (auto index : range) {
+        ids.push_back(plan.step(index).stepId);
+    }
+    return ids;
+}
+
+} // namespace
+
+TEST(WorkflowPlanTest, CompilesDiamondIntoIndexedGraph) {
+    std::string error;
+    auto plan = WorkflowPlan::compile(makeWorkflow({
+        makeStep("join", {"left", "right"}),
+        makeStep("left", {"source"}),
+        makeStep("right", {"source"}),
+        makeStep("source"),
+    }), error);
+    ASSERT_NE(plan, nullptr) << error;
+    ASSERT_EQ(plan->stepCount(), 4u);
+
+    WorkflowPlan::StepIndex join = 0;
+    WorkflowPlan::StepIndex source = 0;
+    ASSERT_TRUE(plan->findStep("join", join));
+    ASSERT_TRUE(plan->findStep("source", source));
+    EXPECT_FALSE(plan->findStep("missing", join));
+
+    EXPECT_EQ(plan->roots(), std::vector<WorkflowPlan::StepIndex>{source});
+    EXPECT_EQ(stepIds(*plan, plan->dependencies(join)), (std::vector<std::string>{"left", "right"}));
+    auto successors = stepIds(*plan, plan->successors(source));
+    std::sort(successors.begin(), successors.end());
+    EXPECT_EQ(successors, (std::vector<std::string>{"left", "right"}));
+    EXPECT_EQ(plan->inDegrees()[join], 2u);
+    EXPECT_EQ(plan->inDegrees()[source], 0u);
+
+    // Every step comes after all of its dependencies
+    const auto& order = plan->topologicalOrder();
+    ASSERT_EQ(order.size(), 4u);
+    std::vector<size_t> position(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = i;
+    }
+    for (WorkflowPlan::StepIndex step = 0; step < plan->stepCount(); ++step) {
+        for (auto dependency : plan->dependencies(step)) {
+            EXPECT_LT(position[dependency], position[step]);
+        }
+    }
+}
+
+TEST(WorkflowPlanTest, RejectsCycles) {
+    std::string error;
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({
+        makeStep("a", {"c"}),
+        makeStep("b", {"a"}),
+        makeStep("c", {"b"}),
+        makeStep("free"),
+    }), error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    error.clear();
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({makeStep("self", {"self"})}), error), nullptr);
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(WorkflowPlanTest, RejectsDuplicateAndEmptyStepIds) {
+    std::string error;
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({makeStep("a"), makeStep("a")}), error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    error.clear();
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({makeStep("")}), error), nullptr);
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(WorkflowPlanTest, RejectsUnknownAndRepeatedDependencies) {
+    std::string error;
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({makeStep("a", {"ghost"})}), error), nullptr);
+    EXPECT_NE(error.find("ghost"), std::string::npos) << error;
+
+    error.clear();
+    EXPECT_EQ(WorkflowPlan::compile(makeWorkflow({makeStep("a"), makeStep("b", {"a", "a"})}), error), nullptr);
+    EXPECT_FALSE(error.empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}